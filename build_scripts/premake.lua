@@ -21,9 +21,11 @@ CPP_VERSION          = "C++20"
 SOLUTION_NAME        = "spartan"
 EDITOR_PROJECT_NAME  = "editor"
 RUNTIME_PROJECT_NAME = "runtime"
+PACKER_PROJECT_NAME  = "packer"
 EXECUTABLE_NAME      = "spartan"
 EDITOR_DIR           = "../" .. EDITOR_PROJECT_NAME
 RUNTIME_DIR          = "../" .. RUNTIME_PROJECT_NAME
+PACKER_DIR           = "../" .. PACKER_PROJECT_NAME
 LIBRARY_DIR          = "../third_party/libraries"
 OBJ_DIR              = "../binaries/obj"
 TARGET_DIR           = "../binaries"
@@ -160,6 +162,47 @@ function solution_configuration()
             symbols "Off"
 end
 
+-- the third party libraries that the runtime links against, executables that link the runtime as a static library need them too
+function runtime_links_release()
+    links { "dxcompiler" }
+    links { "assimp" }
+    links { "fmod_vc" }
+    links { "FreeImageLib" }
+    links { "freetype" }
+    links { "BulletCollision", "BulletDynamics", "BulletSoftBody", "LinearMath" }
+    links { "SDL2" }
+    links { "Compressonator_MT" }
+    links { "OpenImageDenoise" , "OpenImageDenoise_core", "OpenImageDenoise_utils" }
+    links { "meshoptimizer" }
+    links(API_LIBRARIES[ARG_API_GRAPHICS].release or {})
+end
+
+function runtime_links_debug()
+    if os.target() == "windows" then
+        links { "dxcompiler" }
+        links { "assimp_debug" }
+        links { "fmodL_vc" }
+        links { "FreeImageLib_debug" }
+        links { "freetype_debug" }
+        links { "BulletCollision_debug", "BulletDynamics_debug", "BulletSoftBody_debug", "LinearMath_debug" }
+        links { "SDL2_debug" }
+        links { "Compressonator_MT_debug" }
+        links { "OpenImageDenoise_debug" , "OpenImageDenoise_core_debug", "OpenImageDenoise_utils_debug" }
+        links { "meshoptimizer_debug" }
+        links(API_LIBRARIES[ARG_API_GRAPHICS].debug or {})
+    else
+        links { "dxcompiler" }
+        links { "assimp" }
+        links { "fmod_vc" }
+        links { "FreeImageLib" }
+        links { "freetype" }
+        links { "BulletCollision", "BulletDynamics", "BulletSoftBody", "LinearMath" }
+        links { "SDL2" }
+        links { "Compressonator_MT" }
+        links { "OpenImageDenoise" , "OpenImageDenoise_core", "OpenImageDenoise_utils" }
+    end
+end
+
 function runtime_project_configuration()
     project (RUNTIME_PROJECT_NAME)
         location (RUNTIME_DIR)
@@ -224,45 +267,13 @@ function runtime_project_configuration()
         filter "configurations:release"
             debugdir (TARGET_DIR)
             targetdir (TARGET_DIR)
-            links { "dxcompiler" }
-            links { "assimp" }
-            links { "fmod_vc" }
-            links { "FreeImageLib" }
-            links { "freetype" }
-            links { "BulletCollision", "BulletDynamics", "BulletSoftBody", "LinearMath" }
-            links { "SDL2" }
-            links { "Compressonator_MT" }
-			links { "OpenImageDenoise" , "OpenImageDenoise_core", "OpenImageDenoise_utils" }
-			links { "meshoptimizer" }
-			links(API_LIBRARIES[ARG_API_GRAPHICS].release or {})
+            runtime_links_release()
 			
         -- "Debug"
         filter "configurations:debug"
             debugdir (TARGET_DIR)
             targetdir (TARGET_DIR)
-            if os.target() == "windows" then
-                links { "dxcompiler" }
-                links { "assimp_debug" }
-                links { "fmodL_vc" }
-                links { "FreeImageLib_debug" }
-                links { "freetype_debug" }
-                links { "BulletCollision_debug", "BulletDynamics_debug", "BulletSoftBody_debug", "LinearMath_debug" }
-                links { "SDL2_debug" }
-                links { "Compressonator_MT_debug" }
-				links { "OpenImageDenoise_debug" , "OpenImageDenoise_core_debug", "OpenImageDenoise_utils_debug" }
-				links { "meshoptimizer_debug" }
-                links(API_LIBRARIES[ARG_API_GRAPHICS].debug or {})
-            else
-                links { "dxcompiler" }
-                links { "assimp" }
-                links { "fmod_vc" }
-                links { "FreeImageLib" }
-                links { "freetype" }
-                links { "BulletCollision", "BulletDynamics", "BulletSoftBody", "LinearMath" }
-                links { "SDL2" }
-                links { "Compressonator_MT" }
-				links { "OpenImageDenoise" , "OpenImageDenoise_core", "OpenImageDenoise_utils" }
-            end
+            runtime_links_debug()
 end
 
 function editor_project_configuration()
@@ -335,7 +346,51 @@ function editor_project_configuration()
             end
 end
 
+function packer_project_configuration()
+    project (PACKER_PROJECT_NAME)
+        location (PACKER_DIR)
+        links (RUNTIME_PROJECT_NAME)
+        dependson (RUNTIME_PROJECT_NAME)
+        objdir (OBJ_DIR)
+        cppdialect (CPP_VERSION)
+        kind "ConsoleApp"
+        staticruntime "On"
+        defines{ API_CPP_DEFINE }
+        if os.target() == "windows" then
+            conformancemode "On"
+        end
+
+        -- Files
+        files { PACKER_DIR .. "/**.h", PACKER_DIR .. "/**.cpp" }
+
+        -- Includes
+        includedirs { RUNTIME_DIR }
+        includedirs { RUNTIME_DIR .. "/Core" }
+
+        -- Libraries
+        libdirs (LIBRARY_DIR)
+
+        -- "Release"
+        filter "configurations:release"
+            targetname ( PACKER_PROJECT_NAME )
+            targetdir (TARGET_DIR)
+            debugdir (TARGET_DIR)
+            if os.target() == "windows" then
+                runtime_links_release() -- the runtime is a static library there
+            end
+
+        -- "Debug"
+        filter "configurations:debug"
+            targetname ( PACKER_PROJECT_NAME .. "_debug" )
+            targetdir (TARGET_DIR)
+            debugdir (TARGET_DIR)
+            if os.target() == "windows" then
+                runtime_links_debug()
+            end
+end
+
 configure_graphics_api()
 solution_configuration()
 runtime_project_configuration()
 editor_project_configuration()
+packer_project_configuration()
@@ -49,11 +49,8 @@ class EditorHelper
 
     static void LoadMesh(const std::string& file_path, const uint32_t mesh_flags)
     {
-        // load the model asynchronously
-        Spartan::ThreadPool::AddTask([file_path, mesh_flags]()
-        {
-            Spartan::ResourceCache::Load<Spartan::Mesh>(file_path, mesh_flags);
-        });
+        // load the model asynchronously, nothing waits on it, it shows up in the world once it's done
+        Spartan::ResourceCache::LoadAsync<Spartan::Mesh>(file_path, mesh_flags, Spartan::ResourceLoadPriority::High).Detach();
     }
 
     static void LoadWorld(const std::string& file_path)
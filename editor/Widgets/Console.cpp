@@ -88,6 +88,15 @@ void Console::OnTickVisible()
     // text filter
     const float label_width = 37.0f * Spartan::Window::GetDpiScale();
     m_log_filter.Draw("Filter", ImGui::GetContentRegionAvail().x - label_width);
+
+    // lines the engine couldn't deliver
+    const uint64_t dropped_count = Log::GetDroppedCount();
+    const uint64_t evicted_count = Log::GetEvictedCount();
+    if (dropped_count != 0 || evicted_count != 0)
+    {
+        ImGui::TextColored(m_log_type_color[1], "Lines lost: %llu dropped (log buffer full), %llu evicted (history full before the console existed)",
+            static_cast<unsigned long long>(dropped_count), static_cast<unsigned long long>(evicted_count));
+    }
     ImGui::Separator();
 
     // safety first
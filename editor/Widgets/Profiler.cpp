@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Profiler.h"
 #include "../ImGui/ImGui_Extension.h"
 #include "Profiling/Profiler.h"
+#include "Core/FrameScheduler.h"
 //===================================
 
 //= NAMESPACES ===============
@@ -50,7 +51,43 @@ namespace
 
         // text
         ImGui::SetCursorPos(ImVec2(pos.x + m_tree_depth_stride * time_block.GetTreeDepth(), pos.y));
-        ImGui::Text("%s - %.2f ms", name, duration);
+        if (time_block.GetThreadIndex() == 0)
+        {
+            ImGui::Text("%s - %.2f ms", name, duration);
+        }
+        else
+        {
+            ImGui::Text("%s (thread %u) - %.2f ms", name, time_block.GetThreadIndex(), duration);
+        }
+    }
+
+    void show_frame_stages()
+    {
+        const vector<Spartan::FrameStage>& stages = Spartan::FrameScheduler::GetStages();
+        const float time_frame                    = max(Spartan::FrameScheduler::GetTimeLast(), 0.001f);
+        const float width                         = ImGui::GetContentRegionAvail().x;
+        const auto& color_main                    = ImGui::GetStyle().Colors[ImGuiCol_PlotHistogram];
+        const auto& color_worker                  = ImGui::GetStyle().Colors[ImGuiCol_PlotLines];
+
+        ImGui::Text("Frame stages - %.2f ms", time_frame);
+
+        // each stage is drawn at its offset within the frame, so overlapping stages line up vertically
+        for (const Spartan::FrameStage& stage : stages)
+        {
+            const ImVec2 pos_screen = ImGui::GetCursorScreenPos();
+            const float text_height = ImGui::GetTextLineHeight();
+            const float x_start     = pos_screen.x + (stage.time_start / time_frame) * width;
+            const float x_end       = max(pos_screen.x + (stage.time_end / time_frame) * width, x_start + 1.0f);
+            const auto& color       = stage.executed_on_main_thread ? color_main : color_worker;
+
+            // rectangle
+            ImGui::GetWindowDrawList()->AddRectFilled(ImVec2(x_start, pos_screen.y), ImVec2(x_end, pos_screen.y + text_height), IM_COL32(color.x * 255, color.y * 255, color.z * 255, 255));
+
+            // text
+            ImGui::Text("%s (%s) - %.2f ms", stage.name.c_str(), stage.executed_on_main_thread ? "main" : "worker", stage.time_end - stage.time_start);
+        }
+
+        ImGui::Separator();
     }
 
     int mode_hardware = 0; // 0: gpu, 1: cpu
@@ -135,6 +172,12 @@ void Profiler::OnTickVisible()
         });
     }
 
+    // frame stages
+    if (type == Spartan::TimeBlockType::Cpu)
+    {
+        show_frame_stages();
+    }
+
     // time blocks
     for (uint32_t i = 0; i < time_block_count; i++)
     {
@@ -22,6 +22,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ========================
 #include "ShaderEditor.h"
 #include <fstream>
+#include <sstream>
+#include <unordered_set>
 #include "RHI/RHI_Shader.h"
 #include "../ImGui/ImGui_Extension.h"
 //===================================
@@ -169,21 +171,35 @@ void ShaderEditor::ShowControls()
     {
         if (m_index_displayed != -1)
         {
-            static const std::vector<std::string>& file_paths = m_shader->GetFilePaths();
-            static const std::vector<std::string>& sources = m_shader->GetSources();
+            const std::vector<std::string>& file_paths = m_shader->GetFilePaths();
+            const std::vector<std::string>& sources    = m_shader->GetSources();
 
-            // save all files
+            // save the files that were edited, and find all the shaders that include them
+            unordered_set<RHI_Shader*> shaders = { m_shader };
             for (uint32_t i = 0; i < static_cast<uint32_t>(file_paths.size()); i++)
             {
+                stringstream source_on_drive;
+                source_on_drive << ifstream(file_paths[i]).rdbuf();
+                if (source_on_drive.str() == sources[i])
+                    continue;
+
                 ofstream out(file_paths[i]);
                 out << sources[i];
                 out.flush();
                 out.close();
+
+                for (RHI_Shader* shader : RHI_Shader::GetDependents(file_paths[i]))
+                {
+                    shaders.insert(shader);
+                }
             }
 
             // compile synchronously to make the new frame obvious
             bool async = false;
-            m_shader->Compile(m_shader->GetShaderStage(), m_shader->GetFilePath(), async);
+            for (RHI_Shader* shader : shaders)
+            {
+                shader->Compile(shader->GetShaderStage(), shader->GetFilePath(), async, shader->GetVertexType());
+            }
         }
     }
 
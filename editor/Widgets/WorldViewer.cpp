@@ -92,7 +92,7 @@ void WorldViewer::TreeShow()
     ImGui::BeginDisabled(is_in_game_mode);
     {
         // iterate over root entities directly, omitting the root node
-        vector<shared_ptr<Spartan::Entity>> root_entities = Spartan::World::GetRootEntities();
+        Spartan::frame_vector<shared_ptr<Spartan::Entity>> root_entities = Spartan::World::GetRootEntities();
         for (const shared_ptr<Spartan::Entity>& entity : root_entities)
         {
             if (entity->IsActive())
@@ -0,0 +1,67 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===============
+#include "IO/Package.h"
+#include "Core/ThreadPool.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+//==========================
+
+// usage: packer <output.package> <directory>... [-no_compression]
+// run it from the directory the engine runs from, the packed paths are relative to it
+int main(int argc, char** argv)
+{
+    std::string output;
+    std::vector<std::string> directories;
+    bool compress = true;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "-no_compression")
+        {
+            compress = false;
+        }
+        else if (output.empty())
+        {
+            output = arg;
+        }
+        else
+        {
+            directories.emplace_back(arg);
+        }
+    }
+
+    if (output.empty() || directories.empty())
+    {
+        printf("usage: packer <output.package> <directory>... [-no_compression]\n");
+        return 1;
+    }
+
+    // compression runs on the thread pool
+    Spartan::ThreadPool::Initialize();
+    const bool result = Spartan::Package::Build(directories, output, compress);
+    Spartan::ThreadPool::Shutdown();
+
+    printf(result ? "packed \"%s\"\n" : "failed to pack \"%s\", see the log\n", output.c_str());
+    return result ? 0 : 1;
+}
@@ -49,8 +49,18 @@ namespace Spartan
         uint32_t fmod_result       = 0;
         uint32_t fmod_max_channels = 32;
         float fmod_distance_entity = 1.0f;
-        Entity* m_listener         = nullptr;
         #endif
+
+        // the listener's transform as of the last world tick, so that the audio stage doesn't read entities while physics moves them
+        struct listener_state
+        {
+            bool is_set            = false;
+            uint64_t entity_id     = 0;
+            Math::Vector3 position = Math::Vector3(0.0f, 0.0f, 0.0f);
+            Math::Vector3 forward  = Math::Vector3(0.0f, 0.0f, 1.0f);
+            Math::Vector3 up       = Math::Vector3(0.0f, 1.0f, 0.0f);
+        };
+        listener_state listener;
     }
 
     void Audio::Initialize()
@@ -89,7 +99,7 @@ namespace Spartan
         // Subscribe to events
         SP_SUBSCRIBE_TO_EVENT(EventType::WorldClear, SP_EVENT_HANDLER_EXPRESSION_STATIC
         (
-            m_listener = nullptr;
+            listener.is_set = false;
         ));
         #endif 
     }
@@ -118,12 +128,12 @@ namespace Spartan
         if (!HandleErrorFmod((fmod_system->update())))
             return;
 
-        if (m_listener)
+        if (listener.is_set)
         {
-            auto position = m_listener->GetPosition();
+            auto position = listener.position;
             auto velocity = Math::Vector3::Zero;
-            auto forward  = m_listener->GetForward();
-            auto up       = m_listener->GetUp();
+            auto forward  = listener.forward;
+            auto up       = listener.up;
 
             // Set 3D attributes
             HandleErrorFmod(fmod_system->set3DListenerAttributes(0,
@@ -138,9 +148,23 @@ namespace Spartan
 
     void Audio::SetListenerEntity(Entity* entity)
     {
-        #if defined(_MSC_VER)
-        m_listener = entity;
-        #endif
+        listener.is_set = entity != nullptr;
+        if (entity)
+        {
+            listener.entity_id = entity->GetObjectId();
+            listener.position = entity->GetPosition();
+            listener.forward  = entity->GetForward();
+            listener.up       = entity->GetUp();
+        }
+    }
+
+    void Audio::ClearListenerEntity(const Entity* entity)
+    {
+        if (entity && listener.entity_id == entity->GetObjectId())
+        {
+            listener.is_set    = false;
+            listener.entity_id = 0;
+        }
     }
 
     bool Audio::HandleErrorFmod(int result)
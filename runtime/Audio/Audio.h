@@ -39,7 +39,8 @@ namespace Spartan
         static void Initialize();
         static void Tick();
         static void Shutdown();
-        static void SetListenerEntity(Entity* entity);
+        static void SetListenerEntity(Entity* entity); // copies the entity's transform, Tick() uses it until it's set again
+        static void ClearListenerEntity(const Entity* entity); // forgets the listener if it was copied from this entity
         static bool HandleErrorFmod(int result);
         static bool CreateSound(const std::string& file_path, int sound_mode, void*& sound);
         static bool CreateStream(const std::string& file_path, int sound_mode, void*& sound);
@@ -130,6 +130,7 @@ if (!(expression))                                                    \
     Spartan::Log::SetLogToFile(true);                                 \
     SP_LOG_ERROR("Assertion failed: " #expression);                   \
     SP_LOG_ERROR("Callstack:\n%s",    Spartan::get_callstack_c_str());\
+    Spartan::Log::Flush();                                            \
     assert(expression);                                               \
 }
 
@@ -140,6 +141,7 @@ if (!(expression))                                                    \
     SP_LOG_ERROR("Assertion failed: " #expression);                   \
     SP_LOG_ERROR("Message: %s",       text_message);                  \
     SP_LOG_ERROR("Callstack:\n%s",    Spartan::get_callstack_c_str());\
+    Spartan::Log::Flush();                                            \
     assert(expression && text_message);                               \
 }
 
@@ -23,9 +23,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include "Window.h"
 #include "ThreadPool.h"
+#include "FrameScheduler.h"
+#include "FrameAllocator.h"
 #include "../Audio/Audio.h"
 #include "../Input/Input.h"
 #include "../World/World.h"
+#include "../World/WorldStreaming.h"
 #include "../Physics/Physics.h"
 #include "../Profiling/Profiler.h"
 #include "../Rendering/Renderer.h"
@@ -34,6 +37,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Resource/Import/ModelImporter.h"
 #include "../Resource/Import/ImageImporter.h"
 #include "../Display/Display.h"
+#include "../IO/AsyncIo.h"
 //===========================================
 
 //= NAMESPACES ===============
@@ -80,6 +84,7 @@ namespace Spartan
             Timer::Initialize();
             Input::Initialize();
             ThreadPool::Initialize();
+            AsyncIo::Initialize();
             ResourceCache::Initialize();
             Audio::Initialize();
             Profiler::Initialize();
@@ -89,16 +94,43 @@ namespace Spartan
             Settings::Initialize();
         }
 
+        // frame stages, in the order they would run serially (see FrameScheduler.h)
+        {
+            const uint32_t window   = FrameResource_Window;
+            const uint32_t input    = FrameResource_Input;
+            const uint32_t audio    = FrameResource_Audio;
+            const uint32_t physics  = FrameResource_Physics;
+            const uint32_t entities = FrameResource_Entities;
+            const uint32_t debug    = FrameResource_DebugDraw;
+            const uint32_t gpu      = FrameResource_Gpu;
+
+            // audio and the physics simulation only need last frame's state, so they run on workers while the main thread pumps
+            // window and input events, picking is what reads input and it's applied on the next simulation step, audio reads the
+            // listener transform that the world tick copied, so it doesn't wait for physics to move the entities
+            FrameScheduler::AddStage("Audio",     Audio::Tick,          0,                 audio,                                    false);
+            FrameScheduler::AddStage("Physics",   Physics::Tick,        0,                 physics | entities | debug,               false);
+            FrameScheduler::AddStage("Window",    Window::Tick,         0,                 window | input | gpu,                     true);
+            FrameScheduler::AddStage("Input",     Input::Tick,          window,            input,                                    true);
+            FrameScheduler::AddStage("Picking",   Physics::TickPicking, input | entities,  physics,                                  true);
+            FrameScheduler::AddStage("World",     World::Tick,          input,             entities | physics | audio | debug | gpu, true);
+            FrameScheduler::AddStage("Streaming", WorldStreaming::Tick, 0,                 entities | physics | gpu,                 true);
+            FrameScheduler::AddStage("Events",    Event::Tick,          0,                 entities | gpu,                           true);
+            FrameScheduler::AddStage("Resources", ResourceCache::Tick,  0,                 gpu,                                      true);
+            FrameScheduler::AddStage("Renderer",  Renderer::Tick,       window | entities, gpu | debug,                              true);
+        }
+
         SP_LOG_INFO("Initialization took %.1f sec", timer_initialize.GetElapsedTimeSec());
         SP_SUBSCRIBE_TO_EVENT(EventType::RendererOnFirstFrameCompleted, SP_EVENT_HANDLER_EXPRESSION_STATIC(write_ci_test_file(0);));
     }
 
     void Engine::Shutdown()
     {
+        FrameScheduler::Clear();
         ResourceCache::Shutdown();
         World::Shutdown();
         Renderer::Shutdown();
         Physics::Shutdown();
+        AsyncIo::Shutdown();
         ThreadPool::Shutdown();
         Event::Shutdown();
         Audio::Shutdown();
@@ -106,20 +138,17 @@ namespace Spartan
         ImageImporter::Shutdown();
         FontImporter::Shutdown();
         Settings::Shutdown();
+        Log::Shutdown();
     }
 
     void Engine::Tick()
     {
         // pre-tick
+        FrameAllocator::Tick();
         Input::PreTick();
 
         // tick
-        Window::Tick();
-        Input::Tick();
-        Audio::Tick();
-        Physics::Tick();
-        World::Tick();
-        Renderer::Tick();
+        FrameScheduler::Tick();
 
         // post-tick
         Timer::PostTick();
@@ -19,10 +19,12 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ======
+//= INCLUDES =============
 #include "pch.h"
 #include "Event.h"
-//=================
+#include "LockFreeQueue.h"
+#include "FrameAllocator.h"
+//=========================
 
 //= NAMESPACES =====
 using namespace std;
@@ -33,6 +35,17 @@ namespace Spartan
     namespace
     {
         static array<vector<subscriber>, static_cast<uint32_t>(EventType::Max)> event_subscribers;
+
+        // deferred events
+        struct event_deferred
+        {
+            EventType type;
+            uint64_t data;
+        };
+        static LockFreeQueue<event_deferred, 4096> events_deferred;
+        static array<atomic<bool>, static_cast<uint32_t>(EventType::Max)> events_pending; // events without data that are already queued this frame
+        static mutex mutex_overflow;
+        static vector<event_deferred> events_overflow; // only used if the queue fills up
     }
 
     void Event::Shutdown()
@@ -55,4 +68,59 @@ namespace Spartan
             subscriber(data);
         }
     }
+
+    void Event::FireDeferred(const EventType event_type, const uint64_t data /*= 0*/)
+    {
+        // events without data are queued once per frame
+        if (data == 0 && events_pending[static_cast<uint32_t>(event_type)].exchange(true))
+            return;
+
+        if (!events_deferred.Push({ event_type, data }))
+        {
+            lock_guard<mutex> lock(mutex_overflow);
+            events_overflow.push_back({ event_type, data });
+        }
+    }
+
+    void Event::Tick()
+    {
+        // drain
+        frame_vector<event_deferred> events;
+        {
+            event_deferred event;
+            while (events_deferred.Pop(event))
+            {
+                events.push_back(event);
+            }
+
+            lock_guard<mutex> lock(mutex_overflow);
+            events.insert(events.end(), events_overflow.begin(), events_overflow.end());
+            events_overflow.clear();
+        }
+
+        // subscribers are allowed to fire again, so allow queueing before dispatching
+        for (const event_deferred& event : events)
+        {
+            if (event.data == 0)
+            {
+                events_pending[static_cast<uint32_t>(event.type)].store(false);
+            }
+        }
+
+        // coalesce identical events
+        sort(events.begin(), events.end(), [](const event_deferred& a, const event_deferred& b)
+        {
+            return a.type != b.type ? a.type < b.type : a.data < b.data;
+        });
+        events.erase(unique(events.begin(), events.end(), [](const event_deferred& a, const event_deferred& b)
+        {
+            return a.type == b.type && a.data == b.data;
+        }), events.end());
+
+        // dispatch
+        for (const event_deferred& event : events)
+        {
+            Fire(event.type, event.data);
+        }
+    }
 }
@@ -32,8 +32,13 @@ HOW TO USE
 To subscribe a function to an event -> SP_SUBSCRIBE_TO_EVENT(EVENT_ID, Handler);
 To fire an event                    -> SP_FIRE_EVENT(EVENT_ID);
 To fire an event with data          -> SP_FIRE_EVENT_DATA(EVENT_ID, Variant);
+To fire a deferred event            -> SP_FIRE_EVENT_DEFERRED(EVENT_ID);
+To fire a deferred event with data  -> SP_FIRE_EVENT_DEFERRED_DATA(EVENT_ID, uint64_t);
 
-Note: This is a blocking event system
+Note: Firing is blocking, subscribers are called immediately on the firing thread.
+      Deferred events can be fired from any thread, they are queued (lock-free)
+      and dispatched on the main thread once per frame (Event::Tick), identical
+      events (same type and data) fired within a frame are dispatched once.
 ================================================================================
 */
 
@@ -49,6 +54,8 @@ Note: This is a blocking event system
                                                        
 #define SP_FIRE_EVENT(event_enum)                      Spartan::Event::Fire(event_enum)
 #define SP_FIRE_EVENT_DATA(event_enum, data)           Spartan::Event::Fire(event_enum, data)
+#define SP_FIRE_EVENT_DEFERRED(event_enum)             Spartan::Event::FireDeferred(event_enum)
+#define SP_FIRE_EVENT_DEFERRED_DATA(event_enum, data)  Spartan::Event::FireDeferred(event_enum, data)
                                                        
 #define SP_SUBSCRIBE_TO_EVENT(event_enum, function)    Spartan::Event::Subscribe(event_enum, function);
 //========================================================================================================
@@ -81,10 +88,11 @@ namespace Spartan
 
     class Entity;
 
+    // kept trivially copyable, every subscriber gets a copy
     using sp_variant = std::variant<
         int,
-        void*,
-        std::vector<std::shared_ptr<Entity>>
+        uint64_t,
+        void*
     >;
     using subscriber = std::function<void(const sp_variant&)>;
 
@@ -94,5 +102,9 @@ namespace Spartan
         static void Shutdown();
         static void Subscribe(const EventType event_type, subscriber&& function);
         static void Fire(const EventType event_type, sp_variant data = 0);
+        static void FireDeferred(const EventType event_type, const uint64_t data = 0);
+
+        // dispatches the deferred events, called once per frame from the main thread
+        static void Tick();
     };
 }
@@ -21,6 +21,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ============
 #include "pch.h"
+#include "../IO/Package.h"
 #include <SDL_misc.h>
 //=======================
 
@@ -152,6 +153,10 @@ namespace Spartan
 
     bool FileSystem::Exists(const string& path)
     {
+        // a hash lookup, instead of asking the disk
+        if (Package::Exists(path))
+            return true;
+
         try
         {
             if (filesystem::exists(path))
@@ -205,6 +210,10 @@ namespace Spartan
         if (path.empty())
             return false;
 
+        // packages only contain files
+        if (Package::Exists(path))
+            return true;
+
         try
         {
             if (filesystem::exists(path) && filesystem::is_regular_file(path))
@@ -681,4 +690,24 @@ namespace Spartan
             return true;
         }
     }
+
+    uint64_t FileSystem::Hash(const void* data, const size_t size, uint64_t hash)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    string FileSystem::HashToHex(const uint64_t hash)
+    {
+        char hex[17];
+        snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+
+        return hex;
+    }
 }
@@ -90,6 +90,11 @@ namespace Spartan
         static bool Delete(const std::string& path);
         static bool CreateDirectory(const std::string& path);
         static bool CopyFileFromTo(const std::string& source, const std::string& destination);
+
+        // hashing, fnv-1a, for names and keys that are stored on disk (std::hash can change between builds)
+        static uint64_t Hash(const void* data, const size_t size, const uint64_t hash = 14695981039346656037ull);
+        static uint64_t Hash(const std::string& text, const uint64_t hash = 14695981039346656037ull) { return Hash(text.data(), text.size(), hash); }
+        static std::string HashToHex(const uint64_t hash); // 16 characters, for file names
     };
 
     static const char* EXTENSION_WORLD    = ".world";
@@ -101,6 +106,8 @@ namespace Spartan
     static const char* EXTENSION_TEXTURE  = ".texture";
     static const char* EXTENSION_MESH     = ".mesh";
     static const char* EXTENSION_AUDIO    = ".audio";
+    static const char* EXTENSION_CELL     = ".cell";
+    static const char* EXTENSION_PACKAGE  = ".package";
 
     static const std::vector<std::string> supported_formats_image
     {
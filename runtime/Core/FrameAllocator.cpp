@@ -0,0 +1,155 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ============
+#include "pch.h"
+#include "FrameAllocator.h"
+//=======================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    namespace
+    {
+        const size_t block_size_initial = 1024 * 1024; // per thread, grows to fit a frame
+
+        struct arena
+        {
+            // main block, the only one in a steady state
+            unique_ptr<uint8_t[]> block;
+            size_t block_size   = 0;
+            size_t block_offset = 0;
+
+            // blocks allocated because the main block run out mid-frame, they are merged into it on the next rewind
+            vector<unique_ptr<uint8_t[]>> overflow;
+            size_t overflow_size     = 0;
+            size_t overflow_offset   = 0;
+            size_t overflow_required = 0;
+
+            uint64_t frame = 0;
+        };
+
+        thread_local arena arena_local;
+        atomic<uint64_t> frame_index           = 1;
+        atomic<uint64_t> bytes_allocated       = 0;
+        atomic<uint32_t> heap_allocation_count = 0;
+        uint64_t bytes_allocated_last          = 0;
+        uint32_t heap_allocation_count_last    = 0;
+
+        uint8_t* allocate_block(const size_t size, unique_ptr<uint8_t[]>& block)
+        {
+            block = unique_ptr<uint8_t[]>(new uint8_t[size]); // no need to zero it
+            heap_allocation_count++;
+
+            return block.get();
+        }
+
+        void rewind(arena& a)
+        {
+            // grow the main block so that next time everything fits in it
+            if (!a.block || a.overflow_required != 0)
+            {
+                a.block_size = max(a.block_size + a.overflow_required, block_size_initial);
+                allocate_block(a.block_size, a.block);
+            }
+
+            a.overflow.clear();
+            a.overflow_size     = 0;
+            a.overflow_offset   = 0;
+            a.overflow_required = 0;
+            a.block_offset      = 0;
+            a.frame             = frame_index.load(memory_order_relaxed);
+        }
+
+        uint8_t* bump(uint8_t* base, size_t& offset, const size_t capacity, const size_t size, const size_t alignment)
+        {
+            uintptr_t address = reinterpret_cast<uintptr_t>(base) + offset;
+            uintptr_t aligned = (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+            size_t end        = (aligned - reinterpret_cast<uintptr_t>(base)) + size;
+
+            if (end > capacity)
+                return nullptr;
+
+            offset = end;
+            return reinterpret_cast<uint8_t*>(aligned);
+        }
+    }
+
+    void FrameAllocator::Tick()
+    {
+        bytes_allocated_last       = bytes_allocated.exchange(0);
+        heap_allocation_count_last = heap_allocation_count.exchange(0);
+        frame_index++;
+
+        #ifdef DEBUG
+        if (heap_allocation_count_last != 0 && frame_index > 2)
+        {
+            SP_LOG_WARNING("The frame allocator had to allocate %u blocks from the heap, this should only happen while it grows", heap_allocation_count_last);
+        }
+        #endif
+    }
+
+    void* FrameAllocator::Allocate(const size_t size, const size_t alignment)
+    {
+        SP_ASSERT_MSG((alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+
+        arena& a = arena_local;
+        if (a.frame != frame_index.load(memory_order_relaxed))
+        {
+            rewind(a);
+        }
+
+        bytes_allocated.fetch_add(size, memory_order_relaxed);
+
+        // main block
+        if (a.overflow.empty())
+        {
+            if (uint8_t* memory = bump(a.block.get(), a.block_offset, a.block_size, size, alignment))
+                return memory;
+        }
+        else if (uint8_t* memory = bump(a.overflow.back().get(), a.overflow_offset, a.overflow_size, size, alignment))
+        {
+            return memory;
+        }
+
+        // out of space, continue in a new block
+        a.overflow_size      = max(a.block_size, size + alignment);
+        a.overflow_offset    = 0;
+        a.overflow_required += a.overflow_size;
+        a.overflow.emplace_back();
+        allocate_block(a.overflow_size, a.overflow.back());
+
+        return bump(a.overflow.back().get(), a.overflow_offset, a.overflow_size, size, alignment);
+    }
+
+    uint64_t FrameAllocator::GetBytesAllocated()
+    {
+        return bytes_allocated_last;
+    }
+
+    uint32_t FrameAllocator::GetHeapAllocationCount()
+    {
+        return heap_allocation_count_last;
+    }
+}
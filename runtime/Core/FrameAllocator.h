@@ -0,0 +1,88 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========
+#include <vector>
+#include <unordered_map>
+#include <new>
+//=====================
+
+/*
+HOW TO USE
+=========================================================================================
+Memory that only needs to live for the current frame is bumped out of a per-thread
+arena, there is no freeing, the arena is rewound at the next frame boundary (Tick).
+
+STL containers on the arena -> frame_vector<Entity*> entities;
+Objects which are never destroyed -> FrameAllocator::New<frame_unordered_map<uint64_t, float>>();
+
+Note: Nothing allocated here can outlive the frame, so don't use it from jobs that
+      span frames (asset loading, saving etc).
+=========================================================================================
+*/
+
+namespace Spartan
+{
+    class FrameAllocator
+    {
+    public:
+        // rewinds all arenas (lazily, each thread rewinds its own on its next allocation)
+        static void Tick();
+
+        static void* Allocate(const size_t size, const size_t alignment);
+
+        // constructs an object which is never destroyed, only use it for types whose destructor just releases memory
+        template<typename T, typename... Args>
+        static T* New(Args&&... args)
+        {
+            return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        // stats (previous frame)
+        static uint64_t GetBytesAllocated();
+        static uint32_t GetHeapAllocationCount(); // should be zero once the arenas have grown to fit a frame
+    };
+
+    // stl compatible adapter
+    template<typename T>
+    class frame_allocator
+    {
+    public:
+        using value_type = T;
+
+        frame_allocator() = default;
+        template<typename U> frame_allocator(const frame_allocator<U>&) {}
+
+        T* allocate(const size_t count)                 { return static_cast<T*>(FrameAllocator::Allocate(count * sizeof(T), alignof(T))); }
+        void deallocate(T*, const size_t)               {} // released at the end of the frame
+
+        template<typename U> bool operator==(const frame_allocator<U>&) const { return true; }
+        template<typename U> bool operator!=(const frame_allocator<U>&) const { return false; }
+    };
+
+    template<typename T>
+    using frame_vector = std::vector<T, frame_allocator<T>>;
+
+    template<typename K, typename V>
+    using frame_unordered_map = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>, frame_allocator<std::pair<const K, V>>>;
+}
@@ -0,0 +1,209 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ============
+#include "pch.h"
+#include "FrameScheduler.h"
+#include "ThreadPool.h"
+//=======================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    namespace
+    {
+        vector<FrameStage> stages;
+        deque<JobCounter> gates;          // one per stage, reaches zero once all of the stage's dependencies have completed
+        deque<atomic<uint64_t>> claims;   // the frame a stage was last claimed in, whoever claims it first (its job or the main thread) executes it
+        JobCounter stages_pending;        // stage jobs that haven't run yet, a job whose stage was claimed by the main thread does nothing
+        uint64_t frame_index = 0;
+        thread::id thread_id_main;
+        chrono::high_resolution_clock::time_point time_frame_start;
+        float time_last = 0.0f;
+
+        // completion, the main thread sleeps on it while it waits
+        mutex mutex_completed;
+        condition_variable condition_completed;
+        uint32_t stages_completed = 0;
+
+        float get_time_since_frame_start()
+        {
+            const chrono::duration<double, milli> ms = chrono::high_resolution_clock::now() - time_frame_start;
+            return static_cast<float>(ms.count());
+        }
+
+        bool claim_stage(const uint32_t index, const uint64_t frame)
+        {
+            uint64_t expected = frame - 1;
+            return claims[index].compare_exchange_strong(expected, frame, memory_order_acq_rel);
+        }
+
+        void execute_stage(const uint32_t index)
+        {
+            FrameStage& stage = stages[index];
+
+            stage.executed_on_main_thread = this_thread::get_id() == thread_id_main;
+            stage.time_start              = get_time_since_frame_start();
+            stage.function();
+            stage.time_end                = get_time_since_frame_start();
+
+            // unblock dependents
+            for (uint32_t dependent : stage.dependents)
+            {
+                ThreadPool::Decrement(gates[dependent]);
+            }
+
+            {
+                lock_guard<mutex> lock(mutex_completed);
+                stages_completed++;
+            }
+            condition_completed.notify_all();
+        }
+
+        // blocks the main thread until the condition holds, in the meantime it executes worker stages of this frame that are
+        // ready but haven't been picked up yet (e.g. all workers are busy), it never executes unrelated jobs from the pool
+        void wait_on_main_thread(const function<bool()>& condition)
+        {
+            while (true)
+            {
+                uint32_t completed = 0;
+                {
+                    lock_guard<mutex> lock(mutex_completed);
+                    if (condition())
+                        return;
+
+                    completed = stages_completed;
+                }
+
+                bool executed = false;
+                for (uint32_t i = 0; i < static_cast<uint32_t>(stages.size()) && !executed; i++)
+                {
+                    if (!stages[i].main_thread && gates[i].IsDone() && claim_stage(i, frame_index))
+                    {
+                        execute_stage(i);
+                        executed = true;
+                    }
+                }
+
+                // sleep until another stage completes, which is also what opens gates
+                if (!executed)
+                {
+                    unique_lock<mutex> lock(mutex_completed);
+                    condition_completed.wait(lock, [completed]() { return stages_completed != completed; });
+                }
+            }
+        }
+    }
+
+    void FrameScheduler::AddStage(const char* name, function<void()>&& function, const uint32_t reads, const uint32_t writes, const bool main_thread)
+    {
+        FrameStage stage;
+        stage.name        = name;
+        stage.function    = move(function);
+        stage.reads       = reads;
+        stage.writes      = writes;
+        stage.main_thread = main_thread;
+
+        // read after write, write after write and write after read
+        uint32_t index = static_cast<uint32_t>(stages.size());
+        for (uint32_t i = 0; i < index; i++)
+        {
+            FrameStage& stage_previous = stages[i];
+            bool conflicts             = (stage_previous.writes & (reads | writes)) || (stage_previous.reads & writes);
+            if (conflicts)
+            {
+                stage.dependencies.push_back(i);
+                stage_previous.dependents.push_back(index);
+            }
+        }
+
+        stages.emplace_back(move(stage));
+        gates.emplace_back();
+        claims.emplace_back(frame_index);
+    }
+
+    void FrameScheduler::Clear()
+    {
+        // jobs of the last frame can still be queued behind other work, they reference the stages
+        ThreadPool::Wait(stages_pending);
+
+        stages.clear();
+        gates.clear();
+        claims.clear();
+    }
+
+    void FrameScheduler::Tick()
+    {
+        thread_id_main   = this_thread::get_id();
+        time_frame_start = chrono::high_resolution_clock::now();
+        stages_completed = 0; // no stage of this frame is running yet, so no lock is needed
+        frame_index++;
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(stages.size()); i++)
+        {
+            gates[i].pending.store(static_cast<uint32_t>(stages[i].dependencies.size()), memory_order_relaxed);
+        }
+
+        // dispatch all worker stages first, they start as soon as their gate opens
+        for (uint32_t i = 0; i < static_cast<uint32_t>(stages.size()); i++)
+        {
+            if (!stages[i].main_thread)
+            {
+                const uint64_t frame = frame_index;
+                ThreadPool::AddJob([i, frame]()
+                {
+                    if (claim_stage(i, frame))
+                    {
+                        execute_stage(i);
+                    }
+                }, &stages_pending, &gates[i]);
+            }
+        }
+
+        // main thread stages execute in order
+        for (uint32_t i = 0; i < static_cast<uint32_t>(stages.size()); i++)
+        {
+            if (stages[i].main_thread)
+            {
+                wait_on_main_thread([i]() { return gates[i].IsDone(); });
+                claim_stage(i, frame_index);
+                execute_stage(i);
+            }
+        }
+
+        wait_on_main_thread([]() { return stages_completed == static_cast<uint32_t>(stages.size()); });
+
+        time_last = get_time_since_frame_start();
+    }
+
+    const vector<FrameStage>& FrameScheduler::GetStages()
+    {
+        return stages;
+    }
+
+    float FrameScheduler::GetTimeLast()
+    {
+        return time_last;
+    }
+}
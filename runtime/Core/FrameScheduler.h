@@ -0,0 +1,78 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========
+#include <string>
+#include <vector>
+#include <functional>
+//===================
+
+namespace Spartan
+{
+    // state that the frame stages read from or write to, it's used to work out which stages can overlap
+    enum FrameResource : uint32_t
+    {
+        FrameResource_None      = 0,
+        FrameResource_Window    = 1U << 0, // window and sdl events
+        FrameResource_Input     = 1U << 1, // keyboard, mouse, gamepad state
+        FrameResource_Audio     = 1U << 2, // fmod system and channels
+        FrameResource_Physics   = 1U << 3, // bullet world and bodies
+        FrameResource_Entities  = 1U << 4, // entities, components and transforms
+        FrameResource_DebugDraw = 1U << 5, // lines queued for the renderer
+        FrameResource_Gpu       = 1U << 6  // device, command lists and swapchain
+    };
+
+    struct FrameStage
+    {
+        std::string name;
+        std::function<void()> function;
+        uint32_t reads   = FrameResource_None;
+        uint32_t writes  = FrameResource_None;
+        bool main_thread = false; // the stage touches state that belongs to the main thread (window, device)
+
+        // graph
+        std::vector<uint32_t> dependencies; // earlier stages that have to complete first
+        std::vector<uint32_t> dependents;   // later stages that wait for this one
+
+        // timings of the last frame (ms, relative to the start of the frame)
+        float time_start             = 0.0f;
+        float time_end               = 0.0f;
+        bool executed_on_main_thread = true;
+    };
+
+    class FrameScheduler
+    {
+    public:
+        // stages are added in the order that they would execute serially, a stage depends on every earlier stage
+        // that writes what it reads or writes, or reads what it writes, everything else is free to overlap
+        static void AddStage(const char* name, std::function<void()>&& function, const uint32_t reads, const uint32_t writes, const bool main_thread);
+        static void Clear();
+
+        // executes all stages, returns once they have all completed
+        static void Tick();
+
+        // stages and their timings, for the profiler
+        static const std::vector<FrameStage>& GetStages();
+        static float GetTimeLast();
+    };
+}
@@ -0,0 +1,119 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====
+#include <atomic>
+#include <array>
+//================
+
+namespace Spartan
+{
+    // bounded multi-producer/multi-consumer queue (Dmitry Vyukov), lock-free and allocation free
+    template<typename T, uint32_t capacity>
+    class LockFreeQueue
+    {
+    public:
+        LockFreeQueue()
+        {
+            static_assert((capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+
+            for (uint32_t i = 0; i < capacity; i++)
+            {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        bool Push(const T& data)
+        {
+            cell* c    = nullptr;
+            size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+            while (true)
+            {
+                c               = &cells[pos & (capacity - 1)];
+                size_t sequence = c->sequence.load(std::memory_order_acquire);
+                intptr_t dif    = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+                if (dif == 0)
+                {
+                    if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (dif < 0)
+                {
+                    return false; // full
+                }
+                else
+                {
+                    pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+
+            c->data = data;
+            c->sequence.store(pos + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        bool Pop(T& data)
+        {
+            cell* c    = nullptr;
+            size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+            while (true)
+            {
+                c               = &cells[pos & (capacity - 1)];
+                size_t sequence = c->sequence.load(std::memory_order_acquire);
+                intptr_t dif    = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+                if (dif == 0)
+                {
+                    if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (dif < 0)
+                {
+                    return false; // empty
+                }
+                else
+                {
+                    pos = dequeue_pos.load(std::memory_order_relaxed);
+                }
+            }
+
+            data = c->data;
+            c->sequence.store(pos + capacity, std::memory_order_release);
+
+            return true;
+        }
+
+    private:
+        struct cell
+        {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        std::array<cell, capacity> cells;
+        alignas(64) std::atomic<size_t> enqueue_pos = 0;
+        alignas(64) std::atomic<size_t> dequeue_pos = 0;
+    };
+}
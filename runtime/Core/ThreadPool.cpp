@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =========
 #include "pch.h"
 #include "ThreadPool.h"
+#include "LockFreeQueue.h"
 //====================
 
 //= NAMESPACES =====
@@ -32,63 +33,349 @@ namespace Spartan
 {
     namespace
     {
+        // Capacities (powers of two)
+        static const uint32_t job_capacity       = 4096;
+        static const uint32_t job_capacity_local = 1024;
+        static const uint32_t job_none           = numeric_limits<uint32_t>::max();
+        static const uint32_t wait_yield_count   = 64; // attempts to find a job before Wait() sleeps
+
+        struct Job
+        {
+            Task task;
+            JobCounter* counter          = nullptr;
+            const JobCounter* dependency = nullptr;
+        };
+
+        // work-stealing deque (Chase-Lev), the owner pushes and pops at the bottom, anyone can steal from the top
+        class work_stealing_deque
+        {
+        public:
+            bool push(const uint32_t job)
+            {
+                int64_t b = bottom.load(memory_order_relaxed);
+                int64_t t = top.load(memory_order_acquire);
+                if (b - t >= static_cast<int64_t>(job_capacity_local))
+                    return false; // full
+
+                buffer[b & (job_capacity_local - 1)].store(job, memory_order_relaxed);
+                atomic_thread_fence(memory_order_release);
+                bottom.store(b + 1, memory_order_relaxed);
+
+                return true;
+            }
+
+            uint32_t pop()
+            {
+                int64_t b = bottom.load(memory_order_relaxed) - 1;
+                bottom.store(b, memory_order_relaxed);
+                atomic_thread_fence(memory_order_seq_cst);
+                int64_t t = top.load(memory_order_relaxed);
+
+                if (t > b) // empty
+                {
+                    bottom.store(b + 1, memory_order_relaxed);
+                    return job_none;
+                }
+
+                uint32_t job = buffer[b & (job_capacity_local - 1)].load(memory_order_relaxed);
+                if (t == b) // last job, race against thieves
+                {
+                    if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+                    {
+                        job = job_none;
+                    }
+                    bottom.store(b + 1, memory_order_relaxed);
+                }
+
+                return job;
+            }
+
+            uint32_t steal()
+            {
+                int64_t t = top.load(memory_order_acquire);
+                atomic_thread_fence(memory_order_seq_cst);
+                int64_t b = bottom.load(memory_order_acquire);
+
+                if (t >= b) // empty
+                    return job_none;
+
+                uint32_t job = buffer[t & (job_capacity_local - 1)].load(memory_order_relaxed);
+                if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+                    return job_none; // lost the race
+
+                return job;
+            }
+
+        private:
+            alignas(64) atomic<int64_t> top    = 0;
+            alignas(64) atomic<int64_t> bottom = 0;
+            array<atomic<uint32_t>, job_capacity_local> buffer;
+        };
+
         // Stats
         static uint32_t thread_count                 = 0;
         static atomic<uint32_t> working_thread_count = 0;
+        static atomic<uint32_t> queued_job_count     = 0;
 
-        // Sync objects
-        static mutex mutex_tasks;
+        // Sync objects (only used to put idle threads to sleep)
+        static mutex mutex_sleep;
         static condition_variable condition_var;
+        static atomic<uint32_t> sleeping_thread_count = 0;
 
         // Threads
         static vector<thread> threads;
+        static thread_local uint32_t worker_index = job_none;
+        static thread_local uint32_t steal_cursor = 0;
+
+        // Jobs
+        static array<Job, job_capacity> jobs;
+        static LockFreeQueue<uint32_t, job_capacity> jobs_free;
+        static LockFreeQueue<uint32_t, job_capacity> jobs_global; // jobs added from threads that are not part of the pool
+        static vector<unique_ptr<work_stealing_deque>> jobs_local;
+
+        // jobs whose dependency isn't done yet, they are pushed once it completes
+        static mutex mutex_parked;
+        static vector<uint32_t> jobs_parked;
+        static atomic<uint32_t> parked_job_count = 0;
 
-        // Tasks
-        static deque<Task> tasks;
+        // threads that sleep in Wait(), they are woken whenever a job is queued or a counter reaches zero
+        static atomic<uint32_t> waiting_thread_count = 0;
+        static atomic<uint32_t> waiting_epoch        = 0;
 
         // Misc
-        static bool is_stopping;
+        static atomic<bool> is_stopping = false;
     }
 
-    static void thread_loop()
+    static void wake_thread()
     {
-        while (true)
+        if (sleeping_thread_count.load() == 0)
+            return;
+
+        // lock to ensure that a thread which is about to sleep doesn't miss the notification
+        { lock_guard<mutex> lock(mutex_sleep); }
+        condition_var.notify_one();
+    }
+
+    static void wake_waiting_threads()
+    {
+        // pairs with the fence in Wait(), either this sees the waiting thread, or the waiting thread sees the change
+        atomic_thread_fence(memory_order_seq_cst);
+        if (waiting_thread_count.load(memory_order_relaxed) == 0)
+            return;
+
+        waiting_epoch.fetch_add(1, memory_order_release);
+        waiting_epoch.notify_all();
+    }
+
+    static void push_job(const uint32_t job)
+    {
+        // count before pushing so that the job can't be acquired (and uncounted) before it's counted
+        queued_job_count.fetch_add(1);
+
+        // workers push to their own deque, everyone else uses the global queue
+        bool pushed = worker_index != job_none && jobs_local[worker_index]->push(job);
+        if (!pushed)
+        {
+            // can't fail, there can never be more jobs than the capacity of the queue
+            pushed = jobs_global.Push(job);
+            SP_ASSERT(pushed);
+        }
+
+        wake_thread();
+        wake_waiting_threads();
+    }
+
+    static uint32_t acquire_job()
+    {
+        uint32_t job = job_none;
+
+        // own deque
+        if (worker_index != job_none)
+        {
+            job = jobs_local[worker_index]->pop();
+        }
+
+        // global queue
+        if (job == job_none)
         {
-            // Lock tasks mutex
-            unique_lock<mutex> lock(mutex_tasks);
+            jobs_global.Pop(job);
+        }
+
+        // steal from another thread
+        if (job == job_none)
+        {
+            uint32_t count = static_cast<uint32_t>(jobs_local.size());
+            uint32_t start = steal_cursor++;
+            for (uint32_t i = 0; i < count && job == job_none; i++)
+            {
+                uint32_t victim = (start + i) % count;
+                if (victim != worker_index)
+                {
+                    job = jobs_local[victim]->steal();
+                }
+            }
+        }
+
+        if (job != job_none)
+        {
+            queued_job_count.fetch_sub(1);
+        }
+
+        return job;
+    }
+
+    static void unpark_jobs(const JobCounter* dependency)
+    {
+        if (parked_job_count.load(memory_order_seq_cst) == 0)
+            return;
+
+        // collect under the lock, push outside of it
+        vector<uint32_t> ready;
+        {
+            lock_guard<mutex> lock(mutex_parked);
+            for (size_t i = 0; i < jobs_parked.size();)
+            {
+                // a parked job keeps its dependency alive, so it's safe to query it
+                const JobCounter* job_dependency = jobs[jobs_parked[i]].dependency;
+                if (job_dependency == dependency && job_dependency->IsDone())
+                {
+                    ready.emplace_back(jobs_parked[i]);
+                    jobs_parked[i] = jobs_parked.back();
+                    jobs_parked.pop_back();
+                }
+                else
+                {
+                    i++;
+                }
+            }
+            parked_job_count.fetch_sub(static_cast<uint32_t>(ready.size()));
+        }
+
+        for (uint32_t job : ready)
+        {
+            push_job(job);
+        }
+    }
+
+    static void counter_decrement(JobCounter* counter)
+    {
+        // the last job of a counter releases the jobs that depend on it, the decrement and the parked count load are
+        // sequentially consistent, they pair with the increment and the dependency check in push_or_park_job()
+        if (counter->pending.fetch_sub(1, memory_order_seq_cst) == 1)
+        {
+            unpark_jobs(counter);
 
-            // Check condition on notification
-            condition_var.wait(lock, [] { return !tasks.empty() || is_stopping; });
+            // the counter itself isn't waited on, since its owner can destroy it from here on
+            wake_waiting_threads();
+        }
+    }
 
-            // If m_stopping is true, it's time to shut everything down
-            if (is_stopping && tasks.empty())
+    static void push_or_park_job(const uint32_t index)
+    {
+        const JobCounter* dependency = jobs[index].dependency;
+        if (dependency)
+        {
+            // announce the job before checking the dependency, so that either the check sees the dependency done,
+            // or the thread that completes it sees the parked count and finds the job under the lock
+            lock_guard<mutex> lock(mutex_parked);
+            parked_job_count.fetch_add(1, memory_order_seq_cst);
+            if (dependency->pending.load(memory_order_seq_cst) != 0)
+            {
+                jobs_parked.emplace_back(index);
                 return;
+            }
+            parked_job_count.fetch_sub(1, memory_order_relaxed);
+        }
 
-            // Get next task in the queue.
-            Task task = tasks.front();
+        push_job(index);
+    }
+
+    static void release_job(const uint32_t index)
+    {
+        Job& job            = jobs[index];
+        JobCounter* counter = job.counter;
 
-            // Remove it from the queue.
-            tasks.pop_front();
+        // release any captures before the slot is reused
+        job.task       = nullptr;
+        job.counter    = nullptr;
+        job.dependency = nullptr;
+        jobs_free.Push(index);
+
+        if (counter)
+        {
+            counter_decrement(counter);
+        }
+    }
 
-            // Unlock the mutex
-            lock.unlock();
+    static void execute_job(const uint32_t index)
+    {
+        Job& job = jobs[index];
 
-            // Execute the task.
+        bool is_worker = worker_index != job_none;
+        if (is_worker)
+        {
             working_thread_count++;
-            task();
+        }
+
+        job.task();
+
+        if (is_worker)
+        {
             working_thread_count--;
         }
+
+        release_job(index);
+    }
+
+    static void thread_loop(const uint32_t index)
+    {
+        worker_index = index;
+        steal_cursor = index + 1;
+
+        while (true)
+        {
+            uint32_t job = acquire_job();
+            if (job != job_none)
+            {
+                execute_job(job);
+                continue;
+            }
+
+            // nothing to do, sleep until a job is added
+            unique_lock<mutex> lock(mutex_sleep);
+            sleeping_thread_count++;
+            condition_var.wait(lock, [] { return queued_job_count.load() != 0 || is_stopping.load(); });
+            sleeping_thread_count--;
+
+            // If is_stopping is true, it's time to shut everything down
+            if (is_stopping && queued_job_count.load() == 0)
+                return;
+        }
     }
 
     void ThreadPool::Initialize()
     {
         is_stopping                      = false;
         uint32_t concurrent_thread_count = thread::hardware_concurrency();
-        thread_count                     = concurrent_thread_count - 1; // exclude the calling thread
+        thread_count                     = max(concurrent_thread_count, 2u) - 1; // exclude the calling thread
+
+        // all job slots start free
+        uint32_t index_discard = 0;
+        while (jobs_free.Pop(index_discard)) {}
+        for (uint32_t i = 0; i < job_capacity; i++)
+        {
+            jobs_free.Push(i);
+        }
+
+        // create the deques before the threads, since threads steal from each other
+        for (uint32_t i = 0; i < thread_count; i++)
+        {
+            jobs_local.emplace_back(make_unique<work_stealing_deque>());
+        }
 
         for (uint32_t i = 0; i < thread_count; i++)
         {
-            threads.emplace_back(thread(&thread_loop));
+            threads.emplace_back(thread(&thread_loop, i));
         }
 
         SP_LOG_INFO("%d threads have been created", thread_count);
@@ -98,14 +385,11 @@ namespace Spartan
     {
         Flush(true);
 
-        // Put unique lock on task mutex.
-        unique_lock<mutex> lock(mutex_tasks);
-
         // Set termination flag to true.
-        is_stopping = true;
-
-        // Unlock the mutex
-        lock.unlock();
+        {
+            lock_guard<mutex> lock(mutex_sleep);
+            is_stopping = true;
+        }
 
         // Wake up all threads.
         condition_var.notify_all();
@@ -118,81 +402,202 @@ namespace Spartan
 
         // Empty worker threads.
         threads.clear();
+        jobs_local.clear();
     }
 
     future<void> ThreadPool::AddTask(Task&& task)
     {
         // create a packaged task that will give us a future
         auto packaged_task = make_shared<std::packaged_task<void()>>(forward<Task>(task));
-        
+
         // get the future before we move the packaged_task into the lambda
         future<void> future = packaged_task->get_future();
-        
-        // lock tasks mutex
-        unique_lock<mutex> lock(mutex_tasks);
-        
-        // save the task - wrap the packaged_task in a lambda that will execute it
-        tasks.emplace_back([packaged_task]()
+
+        // wrap the packaged_task in a job that will execute it
+        AddJob([packaged_task]()
         {
             (*packaged_task)();
         });
-        
-        // unlock the mutex
-        lock.unlock();
-        
-        // wake up a thread
-        condition_var.notify_one();
-        
+
         // return the future that can be used to wait for task completion
         return future;
     }
 
-    void ThreadPool::ParallelLoop(function<void(uint32_t work_index_start, uint32_t work_index_end)>&& function, const uint32_t work_total)
+    void ThreadPool::AddJob(Task&& task, JobCounter* counter /*= nullptr*/, const JobCounter* dependency /*= nullptr*/)
     {
-        SP_ASSERT_MSG(work_total > 1, "A parallel loop can't have a range of 1 or smaller");
+        if (counter)
+        {
+            counter->pending.fetch_add(1, memory_order_relaxed);
+        }
+
+        // all slots are in use, execute the job on the calling thread
+        uint32_t index = job_none;
+        if (!jobs_free.Pop(index))
+        {
+            if (dependency)
+            {
+                Wait(*dependency);
+            }
+
+            task();
+
+            if (counter)
+            {
+                counter_decrement(counter);
+            }
+
+            return;
+        }
 
-        uint32_t available_threads = GetIdleThreadCount();
-        uint32_t work_per_thread   = work_total / available_threads;
-        uint32_t work_remainder    = work_total % available_threads;
-        uint32_t work_index        = 0;
-        atomic<uint32_t> work_done = 0;
-        condition_variable cv;
-        mutex cv_m;
+        Job& job       = jobs[index];
+        job.task       = forward<Task>(task);
+        job.counter    = counter;
+        job.dependency = dependency;
 
-        // split work into multiple tasks
-        while (work_index < work_total)
+        push_or_park_job(index);
+    }
+
+    void ThreadPool::Decrement(JobCounter& counter)
+    {
+        counter_decrement(&counter);
+    }
+
+    void ThreadPool::Wait(const JobCounter& counter)
+    {
+        // help instead of sleeping
+        uint32_t idle_count = 0;
+        while (!counter.IsDone())
         {
-            uint32_t work_to_do = work_per_thread;
+            uint32_t job = acquire_job();
+            if (job != job_none)
+            {
+                execute_job(job);
+                idle_count = 0;
+                continue;
+            }
 
-            // if the work doesn't divide evenly across threads, add the remainder work to the first thread.
-            if (work_remainder != 0)
+            // nothing to help with (or nothing that can be stolen yet), back off for a bit in case a job shows up
+            if (++idle_count < wait_yield_count)
             {
-                work_to_do     += work_remainder;
-                work_remainder = 0;
+                this_thread::yield();
+                continue;
             }
 
-            AddTask([&function, &work_done, &cv, work_index, work_to_do]()
+            // then sleep until a job is queued or a counter reaches zero, checking once more after announcing it
+            waiting_thread_count.fetch_add(1, memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+            const uint32_t epoch = waiting_epoch.load(memory_order_acquire);
+            job = acquire_job();
+            if (job == job_none && !counter.IsDone())
             {
-                function(work_index, work_index + work_to_do);
-                work_done += work_to_do;
+                waiting_epoch.wait(epoch, memory_order_acquire);
+            }
+            waiting_thread_count.fetch_sub(1, memory_order_relaxed);
+
+            if (job != job_none)
+            {
+                execute_job(job);
+            }
+            idle_count = 0;
+        }
+    }
+
+    void ThreadPool::ParallelLoop(function<void(uint32_t work_index_start, uint32_t work_index_end)>&& function, const uint32_t work_total, const uint32_t grain_size /*= 1*/)
+    {
+        if (work_total == 0)
+            return;
+
+        // aim for a few chunks per thread so that threads which finish early can pick up more work
+        const uint32_t chunks_per_thread = 4;
+        uint32_t thread_total            = thread_count + 1; // the calling thread participates
+        uint32_t chunk_size              = max(max(grain_size, 1u), (work_total + thread_total * chunks_per_thread - 1) / (thread_total * chunks_per_thread));
+        uint32_t chunk_count             = (work_total + chunk_size - 1) / chunk_size;
+
+        // too small to be worth distributing
+        if (chunk_count <= 1)
+        {
+            function(0, work_total);
+            return;
+        }
 
-                cv.notify_one(); // notify that a thread has finished its work
-            });
+        // every participant keeps grabbing the next chunk until there are none left
+        // the state is shared with the helpers, since helpers that start late can outlive this call
+        struct loop_state
+        {
+            std::function<void(uint32_t, uint32_t)> work;
+            atomic<uint64_t> work_index = 0;
+            atomic<uint64_t> work_done  = 0;
+        };
+        shared_ptr<loop_state> state = make_shared<loop_state>();
+        state->work                  = move(function);
+
+        auto execute_chunks = [state, work_total, chunk_size]()
+        {
+            while (true)
+            {
+                uint64_t work_index_start = state->work_index.fetch_add(chunk_size, memory_order_relaxed);
+                if (work_index_start >= work_total)
+                    break;
+
+                uint64_t work_index_end = min<uint64_t>(work_index_start + chunk_size, work_total);
+                state->work(static_cast<uint32_t>(work_index_start), static_cast<uint32_t>(work_index_end));
+                state->work_done.fetch_add(work_index_end - work_index_start, memory_order_release);
+                state->work_done.notify_all();
+            }
+        };
 
-            work_index += work_to_do;
+        // helpers that start late simply find no chunks left
+        uint32_t helper_count = min(chunk_count, thread_total) - 1;
+        for (uint32_t i = 0; i < helper_count; i++)
+        {
+            AddJob(execute_chunks);
         }
 
-        // wait for threads to finish work
-        unique_lock<mutex> lk(cv_m);
-        cv.wait(lk, [&]() { return work_done == work_total; });
+        // work instead of blocking, this is also what makes nested loops safe
+        execute_chunks();
+
+        // block until the chunks that helpers are still executing are done, without picking up unrelated jobs, the
+        // caller might hold locks that those jobs need (e.g. the world's entity lock while a world is loading)
+        uint64_t work_done = state->work_done.load(memory_order_acquire);
+        while (work_done < work_total)
+        {
+            state->work_done.wait(work_done, memory_order_acquire);
+            work_done = state->work_done.load(memory_order_acquire);
+        }
     }
 
     void ThreadPool::Flush(bool remove_queued /*= false*/)
     {
-        // Clear any queued tasks
+        // Clear any queued jobs
         if (remove_queued)
         {
-            tasks.clear();
+            uint32_t job = job_none;
+            while (jobs_global.Pop(job))
+            {
+                queued_job_count.fetch_sub(1);
+                release_job(job);
+            }
+
+            for (auto& deque : jobs_local)
+            {
+                while ((job = deque->steal()) != job_none)
+                {
+                    queued_job_count.fetch_sub(1);
+                    release_job(job);
+                }
+            }
+
+            vector<uint32_t> parked;
+            {
+                lock_guard<mutex> lock(mutex_parked);
+                parked.swap(jobs_parked);
+                parked_job_count.fetch_sub(static_cast<uint32_t>(parked.size()));
+            }
+
+            for (uint32_t job_parked : parked)
+            {
+                release_job(job_parked);
+            }
         }
 
         // If so, wait for them
@@ -205,5 +610,5 @@ namespace Spartan
     uint32_t ThreadPool::GetThreadCount()        { return thread_count; }
     uint32_t ThreadPool::GetWorkingThreadCount() { return working_thread_count; }
     uint32_t ThreadPool::GetIdleThreadCount()    { return thread_count - working_thread_count; }
-    bool ThreadPool::AreTasksRunning()           { return GetIdleThreadCount() != GetThreadCount(); }
+    bool ThreadPool::AreTasksRunning()           { return working_thread_count != 0 || queued_job_count != 0 || parked_job_count != 0; }
 }
@@ -24,12 +24,25 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ========
 #include <future>
 #include <functional>
+#include <atomic>
 //===================
 
 namespace Spartan
 {
     using Task = std::function<void()>;
 
+    // tracks the completion of a group of jobs, it's owned by the caller (e.g. on the stack) so no allocations are involved
+    struct JobCounter
+    {
+        JobCounter() = default;
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        bool IsDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+        std::atomic<uint32_t> pending = 0;
+    };
+
     class ThreadPool
     {
     public:
@@ -39,8 +52,19 @@ namespace Spartan
         // add a task
         static std::future<void> AddTask(Task&& task);
 
-        // spread execution of a given function across all available threads
-        static void ParallelLoop(std::function<void(uint32_t work_index_start, uint32_t work_index_end)>&& function, const uint32_t work_total);
+        // add a job, the counter (optional) is incremented now and decremented once the job has executed
+        // the job won't start before the dependency (optional) is done
+        static void AddJob(Task&& task, JobCounter* counter = nullptr, const JobCounter* dependency = nullptr);
+
+        // decrement a counter that was set by the caller, jobs that depend on it are released once it reaches zero
+        static void Decrement(JobCounter& counter);
+
+        // wait for a counter to reach zero, the calling thread executes queued jobs while waiting
+        static void Wait(const JobCounter& counter);
+
+        // spread execution of a given function across all available threads (including the calling one)
+        // work is handed out in chunks of at least grain_size, ranges that fit in a single chunk execute serially
+        static void ParallelLoop(std::function<void(uint32_t work_index_start, uint32_t work_index_end)>&& function, const uint32_t work_total, const uint32_t grain_size = 1);
 
         // wait for all threads to finish work
         static void Flush(bool remove_queued = false);
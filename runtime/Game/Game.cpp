@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Game/Car.h"
 #include "../World/World.h"
 #include "../World/Entity.h"
+#include "../World/WorldStreaming.h"
 #include "../World/Components/Camera.h"
 #include "../World/Components/Light.h"
 #include "../World/Components/PhysicsBody.h"
@@ -55,6 +56,9 @@ namespace Spartan
         shared_ptr<Entity> m_default_environment         = nullptr;
         shared_ptr<Entity> m_default_light_directional   = nullptr;
 
+        // opt-in, streams the exterior of the bistro in cells around the camera, to exercise world streaming
+        const bool bistro_streaming = false;
+
         void create_music(const char* soundtrack_file_path = "project\\music\\jake_chudnow_shona.mp3")
         {
             if (!soundtrack_file_path)
@@ -872,6 +876,12 @@ namespace Spartan
                     }
                 }
             }
+
+            // the exterior spans a few blocks, so it can be streamed in cells around the camera
+            if (bistro_streaming)
+            {
+                WorldStreaming::Enable(32.0f, 64.0f, 16.0f);
+            }
         }
 
         void create_minecraft()
@@ -1054,6 +1064,49 @@ namespace Spartan
                 }
             }
         }
+
+        // round trips the world through a world file, to compare sequential and parallel loading
+        void benchmark_world_loading(const DefaultWorld default_world)
+        {
+            static const char* names[] = { "objects", "doom", "minecraft", "living_room", "subway", "sponza", "bistro", "forest_car" };
+            static_assert(size(names) == static_cast<size_t>(DefaultWorld::Max));
+
+            const string directory = ResourceCache::GetProjectDirectory() + "cache/benchmark/";
+            const string file_path = directory + names[static_cast<uint32_t>(default_world)] + EXTENSION_WORLD;
+            FileSystem::CreateDirectory(directory);
+            if (!World::SaveToFile(file_path))
+                return;
+
+            // the world gets replaced by the one in the file, so the default entities are gone
+            Game::Shutdown();
+
+            auto load = [&file_path](const bool parallel)
+            {
+                Stopwatch timer;
+                World::LoadFromFile(file_path, parallel);
+                return timer.GetElapsedTimeMs();
+            };
+
+            // the first load warms up the file and os caches, so it's not counted, after that the order alternates so
+            // that neither mode consistently benefits from running second, and the best run of each is reported
+            const uint32_t run_count  = 4;
+            float duration_sequential = numeric_limits<float>::max();
+            float duration_parallel   = numeric_limits<float>::max();
+            load(true);
+            for (uint32_t i = 0; i < run_count; i++)
+            {
+                const bool parallel_first   = (i % 2) == 0;
+                const float duration_first  = load(parallel_first);
+                const float duration_second = load(!parallel_first);
+
+                duration_parallel   = min(duration_parallel,   parallel_first ? duration_first : duration_second);
+                duration_sequential = min(duration_sequential, parallel_first ? duration_second : duration_first);
+            }
+
+            SP_LOG_INFO("World loading benchmark \"%s\": %u entities, sequential %.2f ms, parallel %.2f ms (%.2fx, best of %u after a warm-up load)",
+                names[static_cast<uint32_t>(default_world)], static_cast<uint32_t>(World::GetAllEntities().size()),
+                duration_sequential, duration_parallel, duration_sequential / max(duration_parallel, 0.001f), run_count);
+        }
     }
 
     void Game::Shutdown()
@@ -1229,6 +1282,11 @@ namespace Spartan
                 default: SP_ASSERT_MSG(false, "Unhandled default world"); break;
             }
 
+            if (Engine::HasArgument("-world_benchmark"))
+            {
+                benchmark_world_loading(default_world);
+            }
+
             ProgressTracker::SetGlobalLoadingState(false);
         });
     }
@@ -0,0 +1,659 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "pch.h"
+#include "AsyncIo.h"
+#include "../Core/ThreadPool.h"
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define SP_IO_URING
+#endif
+#endif
+//================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    namespace
+    {
+        struct io_request
+        {
+            string file_path;
+            AsyncIoCallback callback;
+            vector<byte> data;
+            bool success            = true;
+            bool waited_on          = false; // the callback runs on the io thread, someone is blocked on it
+            int file                = -1;
+            uint32_t chunks_pending = 0;
+        };
+
+        mutex mutex_requests;
+        condition_variable condition;
+        deque<shared_ptr<io_request>> requests_pending; // not started yet
+        atomic<uint32_t> request_count   = 0;             // pending and in flight
+        atomic<uint64_t> bytes_in_flight = 0;
+        bool running                     = false;
+        bool using_io_uring              = false;
+        thread io_thread;
+
+        // completed requests are handed to the thread pool from their own thread, when the pool is full, AddJob runs the
+        // callback on the calling thread, and a callback that reads another file would deadlock if that were the io thread
+        mutex mutex_completed;
+        condition_variable condition_completed;
+        deque<shared_ptr<io_request>> requests_completed;
+        bool completing = false;
+        thread completion_thread;
+
+        // data that was read ahead, for the loaders that run on this thread, loaders can load other files while they run
+        thread_local vector<pair<string, const vector<byte>*>> preloaded;
+
+        void complete(const shared_ptr<io_request>& request)
+        {
+            bytes_in_flight -= request->data.size();
+            if (!request->success)
+            {
+                request->data.clear();
+            }
+            request_count--;
+
+            // it only signals the waiting thread, a job could deadlock if every worker is the one waiting
+            if (request->waited_on)
+            {
+                request->callback(request->data, request->success);
+                return;
+            }
+
+            {
+                lock_guard<mutex> lock(mutex_completed);
+                requests_completed.emplace_back(request);
+            }
+            condition_completed.notify_one();
+        }
+
+        void completion_loop()
+        {
+            while (true)
+            {
+                deque<shared_ptr<io_request>> requests;
+                {
+                    unique_lock<mutex> lock(mutex_completed);
+                    condition_completed.wait(lock, [] { return !completing || !requests_completed.empty(); });
+
+                    if (requests_completed.empty())
+                        break;
+
+                    requests.swap(requests_completed);
+                }
+
+                for (shared_ptr<io_request>& request : requests)
+                {
+                    ThreadPool::AddJob([request]()
+                    {
+                        request->callback(request->data, request->success);
+                    });
+                }
+            }
+        }
+
+        void read_blocking(io_request& request)
+        {
+            ifstream file(request.file_path, ios::binary | ios::ate);
+            if (!file)
+            {
+                request.success = false;
+                return;
+            }
+
+            const uint64_t size = static_cast<uint64_t>(file.tellg());
+            request.data.resize(size);
+            bytes_in_flight += size;
+
+            file.seekg(0, ios::beg);
+            file.read(reinterpret_cast<char*>(request.data.data()), size);
+            request.success = !file.fail();
+        }
+
+        // without io_uring, requests are read one after the other, still not on a thread pool worker
+        void io_loop_blocking()
+        {
+            while (true)
+            {
+                shared_ptr<io_request> request;
+                {
+                    unique_lock<mutex> lock(mutex_requests);
+                    condition.wait(lock, [] { return !running || !requests_pending.empty(); });
+
+                    if (requests_pending.empty())
+                        break;
+
+                    request = requests_pending.front();
+                    requests_pending.pop_front();
+                }
+
+                if (running)
+                {
+                    read_blocking(*request);
+                }
+                else
+                {
+                    request->success = false;
+                }
+
+                complete(request);
+            }
+        }
+
+    #ifdef SP_IO_URING
+        // requests are split into chunks, so that a large file doesn't hold up the small ones behind it
+        // and the device gets enough reads in flight, a short read only resubmits what's left of its chunk
+        const uint64_t chunk_size   = 4 * 1024 * 1024;
+        const uint32_t ring_entries = 64;
+
+        struct io_chunk
+        {
+            shared_ptr<io_request> request;
+            uint64_t offset = 0;
+            uint32_t size   = 0;
+        };
+
+        // a minimal io_uring, set up with the raw system calls
+        struct io_ring
+        {
+            int fd              = -1;
+            uint32_t entries    = 0;
+            uint32_t cq_entries = 0; // reads in flight are kept below this, so completions can't overflow
+            uint32_t* sq_head   = nullptr;
+            uint32_t* sq_tail   = nullptr;
+            uint32_t* sq_mask   = nullptr;
+            uint32_t* sq_array  = nullptr;
+            uint32_t* cq_head   = nullptr;
+            uint32_t* cq_tail   = nullptr;
+            uint32_t* cq_mask   = nullptr;
+            io_uring_sqe* sqes  = nullptr;
+            io_uring_cqe* cqes  = nullptr;
+            void* sq_ring       = MAP_FAILED;
+            void* cq_ring       = MAP_FAILED;
+            size_t sq_ring_size = 0;
+            size_t cq_ring_size = 0;
+            size_t sqes_size    = 0;
+
+            bool Initialize()
+            {
+                // fails on kernels older than 5.1, or where io_uring is disabled
+                io_uring_params params = {};
+                fd = static_cast<int>(syscall(__NR_io_uring_setup, ring_entries, &params));
+                if (fd < 0)
+                    return false;
+
+                sq_ring_size           = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+                cq_ring_size           = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (single_mmap)
+                {
+                    sq_ring_size = cq_ring_size = max(sq_ring_size, cq_ring_size);
+                }
+
+                sq_ring        = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+                cq_ring        = single_mmap ? sq_ring : mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+                sqes_size      = params.sq_entries * sizeof(io_uring_sqe);
+                void* sqes_ptr = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+                sqes           = sqes_ptr == MAP_FAILED ? nullptr : static_cast<io_uring_sqe*>(sqes_ptr);
+                if (sq_ring == MAP_FAILED || cq_ring == MAP_FAILED || !sqes)
+                {
+                    Shutdown();
+                    return false;
+                }
+
+                char* sq = static_cast<char*>(sq_ring);
+                char* cq = static_cast<char*>(cq_ring);
+                sq_head  = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+                sq_tail  = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+                sq_mask  = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+                sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+                cq_head  = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+                cq_tail  = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+                cq_mask  = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+                cqes     = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+                entries    = params.sq_entries;
+                cq_entries = params.cq_entries;
+
+                return true;
+            }
+
+            void Shutdown()
+            {
+                if (sqes)                                         munmap(sqes, sqes_size);
+                if (cq_ring != MAP_FAILED && cq_ring != sq_ring) munmap(cq_ring, cq_ring_size);
+                if (sq_ring != MAP_FAILED)                        munmap(sq_ring, sq_ring_size);
+                if (fd >= 0)                                      close(fd);
+
+                *this = io_ring();
+            }
+
+            // returns false when the submission queue is full
+            bool PushRead(const int file, void* buffer, const uint32_t size, const uint64_t offset, const uint64_t user_data)
+            {
+                const uint32_t tail = *sq_tail; // only this thread writes it
+                const uint32_t head = atomic_ref<uint32_t>(*sq_head).load(memory_order_acquire);
+                if (tail - head >= entries)
+                    return false;
+
+                const uint32_t index = tail & *sq_mask;
+                io_uring_sqe& sqe    = sqes[index];
+                memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode           = IORING_OP_READ;
+                sqe.fd               = file;
+                sqe.addr             = reinterpret_cast<uint64_t>(buffer);
+                sqe.len              = size;
+                sqe.off              = offset;
+                sqe.user_data        = user_data;
+                sq_array[index]      = index;
+
+                atomic_ref<uint32_t>(*sq_tail).store(tail + 1, memory_order_release);
+                return true;
+            }
+
+            // submits and, if asked to, blocks until that many reads have completed,
+            // returns how many submissions the kernel took, or the negated errno
+            int Enter(const uint32_t submit_count, const uint32_t wait_count)
+            {
+                const long result = syscall(__NR_io_uring_enter, fd, submit_count, wait_count, wait_count != 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+                return result < 0 ? -errno : static_cast<int>(result);
+            }
+
+            // takes back the last reads that were pushed, when the kernel didn't take them, only this thread submits
+            void Unpush(const uint32_t count)
+            {
+                atomic_ref<uint32_t>(*sq_tail).store(*sq_tail - count, memory_order_release);
+            }
+
+            template <class F>
+            void Reap(F&& on_completion)
+            {
+                uint32_t head       = *cq_head; // only this thread writes it
+                const uint32_t tail = atomic_ref<uint32_t>(*cq_tail).load(memory_order_acquire);
+                while (head != tail)
+                {
+                    const io_uring_cqe& cqe = cqes[head & *cq_mask];
+                    on_completion(cqe.user_data, cqe.res);
+                    head++;
+                }
+                atomic_ref<uint32_t>(*cq_head).store(head, memory_order_release);
+            }
+        };
+        io_ring ring;
+
+        // opens the file and splits it into chunks, returns false if there is nothing to submit
+        bool start(const shared_ptr<io_request>& request, deque<io_chunk>& chunks)
+        {
+            request->file = open(request->file_path.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat info = {};
+            if (request->file < 0 || fstat(request->file, &info) != 0)
+            {
+                request->success = false;
+                return false;
+            }
+
+            const uint64_t size = static_cast<uint64_t>(info.st_size);
+            request->data.resize(size);
+            bytes_in_flight += size;
+
+            for (uint64_t offset = 0; offset < size; offset += chunk_size)
+            {
+                chunks.push_back({ request, offset, static_cast<uint32_t>(min(chunk_size, size - offset)) });
+                request->chunks_pending++;
+            }
+
+            return request->chunks_pending != 0;
+        }
+
+        void finish(const shared_ptr<io_request>& request)
+        {
+            if (request->file >= 0)
+            {
+                close(request->file);
+                request->file = -1;
+            }
+
+            complete(request);
+        }
+
+        // for reads the ring couldn't do, false if the file couldn't be read
+        bool read_chunk_blocking(const io_chunk& chunk)
+        {
+            byte* buffer      = chunk.request->data.data() + chunk.offset;
+            ssize_t remaining = chunk.size;
+            off_t offset      = static_cast<off_t>(chunk.offset);
+            while (remaining > 0)
+            {
+                const ssize_t read = pread(chunk.request->file, buffer, remaining, offset);
+                if (read <= 0)
+                    break;
+
+                buffer    += read;
+                offset    += read;
+                remaining -= read;
+            }
+
+            return remaining == 0;
+        }
+
+        void finish_chunk(const io_chunk& chunk, const bool success)
+        {
+            if (!success)
+            {
+                chunk.request->success = false;
+            }
+
+            if (--chunk.request->chunks_pending == 0)
+            {
+                finish(chunk.request);
+            }
+        }
+
+        void io_loop_uring()
+        {
+            deque<io_chunk> chunks_unsubmitted;
+            unordered_map<uint64_t, io_chunk> chunks_in_flight; // keyed by the user data of their submission
+            uint64_t chunk_id      = 0;
+            uint32_t sq_pending    = 0;     // pushed, but not taken by the kernel yet
+            bool ring_failed       = false; // io_uring_enter failed, what's left is read the blocking way
+
+            while (true)
+            {
+                // take the new requests, sleep if there is nothing else to do
+                deque<shared_ptr<io_request>> requests;
+                bool stopping = false;
+                {
+                    unique_lock<mutex> lock(mutex_requests);
+                    if (chunks_in_flight.empty() && chunks_unsubmitted.empty())
+                    {
+                        condition.wait(lock, [] { return !running || !requests_pending.empty(); });
+                    }
+
+                    requests.swap(requests_pending);
+                    stopping = !running;
+                }
+
+                if (stopping && chunks_in_flight.empty() && chunks_unsubmitted.empty() && requests.empty())
+                    break;
+
+                // once stopping, reads that started are finished, since the kernel writes into their buffers
+                for (const shared_ptr<io_request>& request : requests)
+                {
+                    if (stopping)
+                    {
+                        request->success = false;
+                        finish(request);
+                    }
+                    else if (!start(request, chunks_unsubmitted))
+                    {
+                        finish(request);
+                    }
+                }
+
+                // submit as much as the ring takes, all at once, without more in flight than the completion queue holds
+                uint32_t submit_count = 0;
+                while (!chunks_unsubmitted.empty() && (ring_failed || chunks_in_flight.size() < ring.cq_entries))
+                {
+                    io_chunk& chunk = chunks_unsubmitted.front();
+                    if (ring_failed)
+                    {
+                        io_chunk chunk_blocking = move(chunk);
+                        chunks_unsubmitted.pop_front();
+                        finish_chunk(chunk_blocking, read_chunk_blocking(chunk_blocking));
+                        continue;
+                    }
+
+                    byte* buffer = chunk.request->data.data() + chunk.offset;
+                    if (!ring.PushRead(chunk.request->file, buffer, chunk.size, chunk.offset, chunk_id))
+                        break;
+
+                    chunks_in_flight.emplace(chunk_id++, move(chunk));
+                    chunks_unsubmitted.pop_front();
+                    submit_count++;
+                }
+
+                if (submit_count == 0 && chunks_in_flight.empty())
+                    continue;
+
+                if (ring_failed)
+                {
+                    // reads the kernel took before the failure still complete, without entering the ring
+                    this_thread::sleep_for(chrono::milliseconds(1));
+                }
+                else
+                {
+                    const uint32_t to_submit = sq_pending + submit_count;
+                    const int result         = ring.Enter(to_submit, chunks_in_flight.empty() ? 0 : 1);
+                    if (result >= 0)
+                    {
+                        sq_pending = to_submit - static_cast<uint32_t>(result);
+                    }
+                    else if (result == -EINTR || result == -EAGAIN || result == -EBUSY)
+                    {
+                        // the kernel is short on resources, what it didn't take is submitted again after reaping
+                        sq_pending = to_submit;
+                        this_thread::yield();
+                    }
+                    else
+                    {
+                        SP_LOG_WARNING("io_uring_enter failed (%d), reading the rest of the files with blocking reads", -result);
+                        ring_failed = true;
+
+                        // the last reads that were pushed are the ones the kernel didn't take
+                        ring.Unpush(to_submit);
+                        for (uint64_t id = chunk_id - to_submit; id < chunk_id; id++)
+                        {
+                            auto it = chunks_in_flight.find(id);
+                            io_chunk chunk = move(it->second);
+                            chunks_in_flight.erase(it);
+                            finish_chunk(chunk, read_chunk_blocking(chunk));
+                        }
+                        sq_pending = 0;
+                    }
+                }
+
+                ring.Reap([&](const uint64_t user_data, const int32_t result)
+                {
+                    auto it = chunks_in_flight.find(user_data);
+                    if (it == chunks_in_flight.end())
+                        return;
+
+                    io_chunk chunk = move(it->second);
+                    chunks_in_flight.erase(it);
+
+                    if (result > 0 && static_cast<uint32_t>(result) < chunk.size)
+                    {
+                        // short read, the rest goes back in the queue
+                        chunk.offset += result;
+                        chunk.size   -= result;
+                        chunks_unsubmitted.push_front(move(chunk));
+                        return;
+                    }
+
+                    // the kernel doesn't support the operation, or the read was interrupted, finish it the blocking way
+                    finish_chunk(chunk, result > 0 || read_chunk_blocking(chunk));
+                });
+            }
+        }
+    #endif
+
+        void enqueue(const string& file_path, AsyncIoCallback&& callback, const bool waited_on)
+        {
+            shared_ptr<io_request> request = make_shared<io_request>();
+            request->file_path             = file_path;
+            request->callback              = move(callback);
+            request->waited_on             = waited_on;
+            request_count++;
+
+            {
+                lock_guard<mutex> lock(mutex_requests);
+                if (running)
+                {
+                    requests_pending.emplace_back(request);
+                    request = nullptr;
+                }
+            }
+
+            // not initialized (or shut down), read it right here
+            if (request)
+            {
+                read_blocking(*request);
+                bytes_in_flight -= request->data.size();
+                request_count--;
+                request->callback(request->data, request->success);
+                return;
+            }
+
+            condition.notify_one();
+        }
+    }
+
+    void AsyncIo::Initialize()
+    {
+        running    = true;
+        completing = true;
+
+        completion_thread = thread(completion_loop);
+
+    #ifdef SP_IO_URING
+        using_io_uring = ring.Initialize();
+    #endif
+
+        io_thread = thread([]()
+        {
+        #ifdef SP_IO_URING
+            if (using_io_uring)
+            {
+                io_loop_uring();
+                ring.Shutdown();
+                return;
+            }
+        #endif
+            io_loop_blocking();
+        });
+
+        SP_LOG_INFO("Reading files %s", using_io_uring ? "through io_uring" : "on a dedicated thread");
+    }
+
+    void AsyncIo::Shutdown()
+    {
+        {
+            lock_guard<mutex> lock(mutex_requests);
+            running = false;
+        }
+        condition.notify_all();
+
+        if (io_thread.joinable())
+        {
+            io_thread.join();
+        }
+
+        // the io thread is done completing requests, hand the last ones out and stop
+        {
+            lock_guard<mutex> lock(mutex_completed);
+            completing = false;
+        }
+        condition_completed.notify_all();
+
+        if (completion_thread.joinable())
+        {
+            completion_thread.join();
+        }
+    }
+
+    void AsyncIo::Read(const string& file_path, AsyncIoCallback&& callback)
+    {
+        enqueue(file_path, move(callback), false);
+    }
+
+    bool AsyncIo::ReadAndWait(const string& file_path, vector<byte>* data)
+    {
+        shared_ptr<promise<bool>> done = make_shared<promise<bool>>();
+        future<bool> result            = done->get_future();
+        enqueue(file_path, [done, data](vector<byte>& request_data, const bool success)
+        {
+            *data = move(request_data);
+            done->set_value(success);
+        }, true);
+
+        return result.get();
+    }
+
+    void AsyncIo::SetPreloaded(const string& file_path, const vector<byte>* data)
+    {
+        if (data)
+        {
+            preloaded.emplace_back(file_path, data);
+            return;
+        }
+
+        for (auto it = preloaded.rbegin(); it != preloaded.rend(); it++)
+        {
+            if (it->first == file_path)
+            {
+                preloaded.erase(next(it).base());
+                return;
+            }
+        }
+    }
+
+    bool AsyncIo::FindPreloaded(const string& file_path, const char** data, uint64_t* size)
+    {
+        for (auto it = preloaded.rbegin(); it != preloaded.rend(); it++)
+        {
+            if (it->first == file_path)
+            {
+                *data = reinterpret_cast<const char*>(it->second->data());
+                *size = it->second->size();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool AsyncIo::IsUsingIoUring()
+    {
+        return using_io_uring;
+    }
+
+    uint32_t AsyncIo::GetPendingCount()
+    {
+        return request_count;
+    }
+
+    uint64_t AsyncIo::GetBytesInFlight()
+    {
+        return bytes_in_flight;
+    }
+}
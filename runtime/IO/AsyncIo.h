@@ -0,0 +1,60 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====
+#include <string>
+#include <vector>
+#include <functional>
+//================
+
+namespace Spartan
+{
+    // the data can be moved out of, success is false if the file couldn't be opened or read
+    using AsyncIoCallback = std::function<void(std::vector<std::byte>& data, const bool success)>;
+
+    // reads files on a dedicated thread, through io_uring on linux (batched, many reads in flight) and
+    // with blocking reads everywhere else, either way the thread pool workers never wait on the disk
+    class AsyncIo
+    {
+    public:
+        static void Initialize();
+        static void Shutdown();
+
+        // reads the whole file, the callback runs as a thread pool job once the data is in memory
+        static void Read(const std::string& file_path, AsyncIoCallback&& callback);
+
+        // reads the whole file and waits for it, for loaders that need the data before they can go on, nothing
+        // is queued on the thread pool, so workers can call it too, false if the file couldn't be opened or read
+        static bool ReadAndWait(const std::string& file_path, std::vector<std::byte>* data);
+
+        // loaders take paths, so data that was read ahead is handed to them per thread, while it's set,
+        // FileStream and the image importer read the path from memory instead of opening the file, setting nullptr removes it
+        static void SetPreloaded(const std::string& file_path, const std::vector<std::byte>* data);
+        static bool FindPreloaded(const std::string& file_path, const char** data, uint64_t* size);
+
+        // stats
+        static bool IsUsingIoUring();
+        static uint32_t GetPendingCount();
+        static uint64_t GetBytesInFlight();
+    };
+}
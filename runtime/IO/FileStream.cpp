@@ -23,6 +23,23 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include "FileStream.h"
 #include "../RHI/RHI_Vertex.h"
+#include "Package.h"
+#include "AsyncIo.h"
+#include "../Core/ThreadPool.h"
+SP_WARNINGS_OFF
+#define FREEIMAGE_LIB
+#include <FreeImage/FreeImage.h>
+SP_WARNINGS_ON
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 //============================
 
 //= NAMESPACES =====
@@ -31,6 +48,329 @@ using namespace std;
 
 namespace Spartan
 {
+    namespace compression
+    {
+        // compressed files are a header, a block index and then the blocks, each block is compressed on its
+        // own, so blocks can be compressed and decompressed in parallel, and a seek only touches one block
+        const uint32_t magic      = 0x5A425053; // "SPBZ"
+        const uint32_t version    = 1;
+        const uint32_t block_size = 256 * 1024;
+
+        // a block that doesn't get smaller is stored as is, its compressed size is equal to its size
+
+        atomic<uint64_t> bytes_written_raw        = 0;
+        atomic<uint64_t> bytes_written_compressed = 0;
+        atomic<uint64_t> bytes_read_compressed    = 0;
+        atomic<uint64_t> bytes_read_raw           = 0;
+        atomic<uint64_t> write_us                 = 0;
+        atomic<uint64_t> read_us                  = 0;
+
+        uint64_t get_block_size(const uint64_t size, const uint32_t block_index)
+        {
+            return min<uint64_t>(block_size, size - static_cast<uint64_t>(block_index) * block_size);
+        }
+    }
+
+    // a read only view of a whole file, exposed as a stream buffer so that the
+    // regular reads become plain copies out of the mapping, without any kernel calls
+    class MappedFileBuffer : public streambuf
+    {
+    public:
+        ~MappedFileBuffer()
+        {
+            if (!m_owned)
+                return;
+
+        #ifdef _WIN32
+            if (m_data)    UnmapViewOfFile(m_data);
+            if (m_mapping) CloseHandle(m_mapping);
+        #else
+            if (m_data) munmap(m_data, m_size);
+        #endif
+        }
+
+        // memory that's mapped by someone else, like a file inside a package
+        void View(const char* data, const uint64_t size)
+        {
+            m_data = const_cast<char*>(data);
+            m_size = size;
+
+            char* begin = static_cast<char*>(m_data);
+            setg(begin, begin, begin + m_size);
+        }
+
+        bool Map(const string& path)
+        {
+        #ifdef _WIN32
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                return false;
+
+            LARGE_INTEGER size = {};
+            if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+            {
+                m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (m_mapping)
+                {
+                    m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+                    m_size = static_cast<uint64_t>(size.QuadPart);
+                }
+            }
+            CloseHandle(file); // the mapping keeps the file open
+        #else
+            int file = open(path.c_str(), O_RDONLY);
+            if (file == -1)
+                return false;
+
+            struct stat info = {};
+            if (fstat(file, &info) == 0 && info.st_size > 0)
+            {
+                void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+                if (data != MAP_FAILED)
+                {
+                    m_data = data;
+                    m_size = static_cast<uint64_t>(info.st_size);
+                    madvise(m_data, m_size, MADV_SEQUENTIAL);
+                }
+            }
+            close(file); // the mapping keeps the file open
+        #endif
+
+            if (!m_data)
+                return false;
+
+            m_owned     = true;
+            char* begin = static_cast<char*>(m_data);
+            setg(begin, begin, begin + m_size);
+
+            return true;
+        }
+
+        const byte* Advance(const uint64_t size)
+        {
+            if (size > static_cast<uint64_t>(egptr() - gptr()))
+                return nullptr;
+
+            const byte* data = reinterpret_cast<const byte*>(gptr());
+            setg(eback(), gptr() + size, egptr());
+
+            return data;
+        }
+
+        const char* GetData() const { return static_cast<const char*>(m_data); }
+        uint64_t GetSize() const    { return m_size; }
+
+    protected:
+        pos_type seekoff(off_type offset, ios_base::seekdir direction, ios_base::openmode which) override
+        {
+            off_type position = offset;
+            if (direction == ios_base::cur) position += gptr() - eback();
+            if (direction == ios_base::end) position += egptr() - eback();
+
+            return seekpos(position, which);
+        }
+
+        pos_type seekpos(pos_type position, ios_base::openmode which) override
+        {
+            if (!(which & ios_base::in) || position < 0 || static_cast<uint64_t>(position) > m_size)
+                return pos_type(off_type(-1));
+
+            setg(eback(), eback() + static_cast<off_type>(position), egptr());
+
+            return position;
+        }
+
+    private:
+        void* m_data    = nullptr;
+        uint64_t m_size = 0;
+        bool m_owned    = false;
+    #ifdef _WIN32
+        HANDLE m_mapping = nullptr;
+    #endif
+    };
+
+    // presents the decompressed contents of a compressed file, blocks are decompressed as the read position
+    // reaches them, together with the next few so that the thread pool can work on them in parallel
+    class CompressedFileBuffer : public streambuf
+    {
+    public:
+        // the source is either the mapping of the file or, when it couldn't be mapped, the file read into memory
+        bool Initialize(const char* source, const uint64_t source_size, vector<char>&& source_owned)
+        {
+            m_source_owned = move(source_owned);
+            m_source       = m_source_owned.empty() ? source : m_source_owned.data();
+            m_source_size  = m_source_owned.empty() ? source_size : m_source_owned.size();
+
+            // header
+            const uint64_t header_size = sizeof(uint32_t) * 4 + sizeof(uint64_t);
+            if (m_source_size < header_size)
+                return false;
+
+            uint32_t header[4] = {};
+            memcpy(header, m_source, sizeof(header));
+            memcpy(&m_size, m_source + sizeof(header), sizeof(m_size));
+            if (header[0] != compression::magic || header[1] > compression::version || header[2] != compression::block_size)
+                return false;
+
+            // block index
+            const uint32_t block_count = header[3];
+            const char* index          = m_source + header_size;
+            if (m_source_size < header_size + block_count * (sizeof(uint64_t) + sizeof(uint32_t)))
+                return false;
+
+            m_offsets.resize(block_count);
+            m_sizes.resize(block_count);
+            for (uint32_t i = 0; i < block_count; i++)
+            {
+                memcpy(&m_offsets[i], index, sizeof(uint64_t)); index += sizeof(uint64_t);
+                memcpy(&m_sizes[i],   index, sizeof(uint32_t)); index += sizeof(uint32_t);
+
+                if (m_offsets[i] + m_sizes[i] > m_source_size)
+                    return false;
+            }
+            m_blocks.resize(block_count);
+
+            return true;
+        }
+
+        // a pointer into the current block, if the bytes don't cross into the next one
+        const byte* Advance(const uint64_t size)
+        {
+            if (size > static_cast<uint64_t>(egptr() - gptr()))
+                return nullptr;
+
+            const byte* data = reinterpret_cast<const byte*>(gptr());
+            setg(eback(), gptr() + size, egptr());
+
+            return data;
+        }
+
+    protected:
+        int_type underflow() override
+        {
+            if (gptr() < egptr())
+                return traits_type::to_int_type(*gptr());
+
+            const uint32_t block_index = m_block_current == numeric_limits<uint32_t>::max() ? 0 : m_block_current + 1;
+            if (!SetPosition(static_cast<uint64_t>(block_index) * compression::block_size) || gptr() == egptr())
+                return traits_type::eof();
+
+            return traits_type::to_int_type(*gptr());
+        }
+
+        pos_type seekoff(off_type offset, ios_base::seekdir direction, ios_base::openmode which) override
+        {
+            off_type position = offset;
+            if (direction == ios_base::cur) position += static_cast<off_type>(GetPosition());
+            if (direction == ios_base::end) position += static_cast<off_type>(m_size);
+
+            return seekpos(position, which);
+        }
+
+        pos_type seekpos(pos_type position, ios_base::openmode which) override
+        {
+            if (!(which & ios_base::in) || position < 0 || !SetPosition(static_cast<uint64_t>(position)))
+                return pos_type(off_type(-1));
+
+            return position;
+        }
+
+    private:
+        uint64_t GetPosition() const
+        {
+            if (m_block_current == numeric_limits<uint32_t>::max())
+                return 0;
+
+            return static_cast<uint64_t>(m_block_current) * compression::block_size + (gptr() - eback());
+        }
+
+        bool SetPosition(const uint64_t position)
+        {
+            if (position > m_size)
+                return false;
+
+            // the end of the file is the end of the last block
+            uint32_t block_index = static_cast<uint32_t>(position / compression::block_size);
+            if (block_index == m_blocks.size() && block_index != 0)
+            {
+                block_index--;
+            }
+
+            if (block_index < m_blocks.size())
+            {
+                if (!Load(block_index))
+                    return false;
+
+                vector<char>& block = m_blocks[block_index];
+                const uint64_t offset = position - static_cast<uint64_t>(block_index) * compression::block_size;
+                setg(block.data(), block.data() + offset, block.data() + block.size());
+                m_block_current = block_index;
+            }
+
+            return true;
+        }
+
+        bool Load(const uint32_t block_index)
+        {
+            if (!m_blocks[block_index].empty())
+                return true;
+
+            // only keep a window of blocks, reading moves forward so the ones before it are rarely needed again
+            const uint32_t window_end = min(static_cast<uint32_t>(m_blocks.size()), block_index + ThreadPool::GetThreadCount() + 1);
+            for (uint32_t i = 0; i < m_blocks.size(); i++)
+            {
+                if ((i < block_index || i >= window_end) && !m_blocks[i].empty())
+                {
+                    vector<char>().swap(m_blocks[i]);
+                }
+            }
+
+            const Stopwatch timer;
+            atomic<bool> failed = false;
+            ThreadPool::ParallelLoop([this, block_index, &failed](uint32_t start, uint32_t end)
+            {
+                for (uint32_t i = block_index + start; i < block_index + end; i++)
+                {
+                    if (!m_blocks[i].empty())
+                        continue;
+
+                    const uint64_t size = compression::get_block_size(m_size, i);
+                    m_blocks[i].resize(size);
+
+                    if (m_sizes[i] == size)
+                    {
+                        memcpy(m_blocks[i].data(), m_source + m_offsets[i], size);
+                    }
+                    else if (FreeImage_ZLibUncompress(reinterpret_cast<BYTE*>(m_blocks[i].data()), static_cast<DWORD>(size), reinterpret_cast<BYTE*>(const_cast<char*>(m_source + m_offsets[i])), m_sizes[i]) != size)
+                    {
+                        failed = true;
+                    }
+
+                    compression::bytes_read_compressed += m_sizes[i];
+                    compression::bytes_read_raw        += size;
+                }
+            }, window_end - block_index);
+            compression::read_us += static_cast<uint64_t>(timer.GetElapsedTimeMs() * 1000.0f);
+
+            if (failed)
+            {
+                SP_LOG_ERROR("Failed to decompress block %u, the file is corrupted", block_index);
+                return false;
+            }
+
+            return true;
+        }
+
+        vector<char> m_source_owned;
+        const char* m_source      = nullptr;
+        uint64_t m_source_size    = 0;
+        uint64_t m_size           = 0; // decompressed
+        vector<uint64_t> m_offsets;
+        vector<uint32_t> m_sizes;
+        vector<vector<char>> m_blocks;
+        uint32_t m_block_current  = numeric_limits<uint32_t>::max();
+    };
+
     FileStream::FileStream(const string& path, uint32_t flags)
     {
         m_is_open = false;
@@ -41,7 +381,38 @@ namespace Spartan
         if(flags & FileStream_Write)  ios_flags |= ios::out;
         if(flags & FileStream_Append) ios_flags |= ios::app;
 
-        if (m_flags & FileStream_Write)
+        auto map = [this](const string& path)
+        {
+            unique_ptr<MappedFileBuffer> mapping = make_unique<MappedFileBuffer>();
+            if (!mapping->Map(path))
+                return false;
+
+            m_mapping = move(mapping);
+            m_buffer_in.rdbuf(m_mapping.get());
+            return true;
+        };
+
+        const char* memory_data = nullptr;
+        uint64_t memory_size    = 0;
+
+        if (m_flags & FileStream_Memory)
+        {
+            m_out = &m_memory;
+            m_in  = &m_memory;
+        }
+        else if (!(m_flags & FileStream_Write) && (AsyncIo::FindPreloaded(path, &memory_data, &memory_size) || Package::Find(path, &memory_data, &memory_size, &m_package)))
+        {
+            // files that were read ahead, or are inside a mounted package, are read straight from memory
+            m_mapping = make_unique<MappedFileBuffer>();
+            m_mapping->View(memory_data, memory_size);
+            m_buffer_in.rdbuf(m_mapping.get());
+            m_in = &m_buffer_in;
+        }
+        else if ((m_flags & FileStream_Mapped) && !(m_flags & FileStream_Write) && map(path))
+        {
+            m_in = &m_buffer_in;
+        }
+        else if (m_flags & FileStream_Write)
         {
             out.open(path, ios_flags);
             if (out.fail())
@@ -49,6 +420,12 @@ namespace Spartan
                 SP_LOG_ERROR("Failed to open \"%s\" for writing", path.c_str());
                 return;
             }
+
+            // everything is written to memory, and compressed when the stream is closed
+            if (m_flags & FileStream_Compressed)
+            {
+                m_out = &m_memory;
+            }
         }
         else if (m_flags & FileStream_Read)
         {
@@ -60,6 +437,36 @@ namespace Spartan
             }
         }
 
+        // compressed files are recognized by their header, so reading them needs no flag
+        if ((m_flags & FileStream_Read) && !(m_flags & FileStream_Write) && !(m_flags & FileStream_Memory))
+        {
+            uint32_t magic = 0;
+            m_in->read(reinterpret_cast<char*>(&magic), sizeof(magic));
+            m_in->clear();
+            m_in->seekg(0, ios::beg);
+
+            if (magic == compression::magic)
+            {
+                vector<char> source;
+                if (!m_mapping)
+                {
+                    source.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+                    in.close();
+                }
+
+                m_compression = make_unique<CompressedFileBuffer>();
+                if (!m_compression->Initialize(m_mapping ? m_mapping->GetData() : nullptr, m_mapping ? m_mapping->GetSize() : 0, move(source)))
+                {
+                    SP_LOG_ERROR("\"%s\" has an invalid compression header", path.c_str());
+                    m_compression.reset();
+                    return;
+                }
+
+                m_buffer_in.rdbuf(m_compression.get());
+                m_in = &m_buffer_in;
+            }
+        }
+
         m_is_open = true;
     }
 
@@ -70,8 +477,17 @@ namespace Spartan
 
     void FileStream::Close()
     {
+        if (m_flags & FileStream_Memory)
+            return;
+
         if (m_flags & FileStream_Write)
         {
+            if ((m_flags & FileStream_Compressed) && out.is_open())
+            {
+                WriteCompressed();
+                m_out = &out; // so that IsGood() reports on the file from here on
+            }
+
             out.flush();
             out.close();
         }
@@ -79,7 +495,125 @@ namespace Spartan
         {
             in.clear();
             in.close();
+
+            m_buffer_in.rdbuf(nullptr);
+            m_compression.reset();
+            m_mapping.reset();
+            m_package.reset();
+        }
+    }
+
+    void FileStream::WriteCompressed()
+    {
+        const string compressed = Compress(m_memory.view());
+        out.write(compressed.data(), compressed.size());
+
+        m_memory.str(string());
+    }
+
+    string FileStream::Compress(const string_view data)
+    {
+        const Stopwatch timer;
+        const uint64_t size        = data.size();
+        const uint32_t block_count = static_cast<uint32_t>((size + compression::block_size - 1) / compression::block_size);
+
+        // compress
+        vector<vector<BYTE>> blocks(block_count);
+        ThreadPool::ParallelLoop([&data, &blocks, size](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                const uint64_t block_size = compression::get_block_size(size, i);
+                BYTE* source              = reinterpret_cast<BYTE*>(const_cast<char*>(data.data())) + static_cast<uint64_t>(i) * compression::block_size;
+
+                // a block that doesn't fit in its original size is stored as is
+                blocks[i].resize(block_size);
+                DWORD block_size_compressed = FreeImage_ZLibCompress(blocks[i].data(), static_cast<DWORD>(block_size), source, static_cast<DWORD>(block_size));
+                if (block_size_compressed == 0 || block_size_compressed >= block_size)
+                {
+                    memcpy(blocks[i].data(), source, block_size);
+                    block_size_compressed = static_cast<DWORD>(block_size);
+                }
+                blocks[i].resize(block_size_compressed);
+            }
+        }, block_count);
+
+        ostringstream result;
+
+        // header
+        result.write(reinterpret_cast<const char*>(&compression::magic), sizeof(compression::magic));
+        result.write(reinterpret_cast<const char*>(&compression::version), sizeof(compression::version));
+        result.write(reinterpret_cast<const char*>(&compression::block_size), sizeof(compression::block_size));
+        result.write(reinterpret_cast<const char*>(&block_count), sizeof(block_count));
+        result.write(reinterpret_cast<const char*>(&size), sizeof(size));
+
+        // block index
+        uint64_t offset = static_cast<uint64_t>(result.tellp()) + block_count * (sizeof(uint64_t) + sizeof(uint32_t));
+        for (const vector<BYTE>& block : blocks)
+        {
+            const uint32_t block_size_compressed = static_cast<uint32_t>(block.size());
+            result.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+            result.write(reinterpret_cast<const char*>(&block_size_compressed), sizeof(block_size_compressed));
+            offset += block_size_compressed;
+        }
+
+        // blocks
+        for (const vector<BYTE>& block : blocks)
+        {
+            result.write(reinterpret_cast<const char*>(block.data()), block.size());
         }
+
+        compression::bytes_written_raw        += size;
+        compression::bytes_written_compressed += static_cast<uint64_t>(result.tellp());
+        compression::write_us                 += static_cast<uint64_t>(timer.GetElapsedTimeMs() * 1000.0f);
+
+        return result.str();
+    }
+
+    FileStreamCompressionStats FileStream::GetCompressionStats()
+    {
+        FileStreamCompressionStats stats;
+        stats.bytes_written_raw        = compression::bytes_written_raw;
+        stats.bytes_written_compressed = compression::bytes_written_compressed;
+        stats.bytes_read_compressed    = compression::bytes_read_compressed;
+        stats.bytes_read_raw           = compression::bytes_read_raw;
+        stats.write_ms                 = static_cast<double>(compression::write_us) / 1000.0;
+        stats.read_ms                  = static_cast<double>(compression::read_us) / 1000.0;
+
+        return stats;
+    }
+
+    bool FileStream::WriteAtomic(const string& path, const uint32_t flags, const function<void(FileStream& file)>& write)
+    {
+        FileSystem::CreateDirectory(FileSystem::GetDirectoryFromFilePath(path));
+
+        // the temporary name is unique to the thread
+        const string path_temp = path + "." + to_string(hash<thread::id>()(this_thread::get_id())) + ".tmp";
+        bool written           = false;
+        {
+            FileStream file(path_temp, flags | FileStream_Write);
+            if (file.IsOpen())
+            {
+                write(file);
+                file.Close();
+                written = file.IsGood(); // closing compresses and flushes, so this covers the whole file
+            }
+        }
+
+        error_code error;
+        if (written)
+        {
+            filesystem::rename(path_temp, path, error);
+        }
+
+        if (!written || error)
+        {
+            SP_LOG_WARNING("Failed to write \"%s\"", path.c_str());
+            filesystem::remove(path_temp, error);
+            return false;
+        }
+
+        return true;
     }
 
     void FileStream::Write(const string& value)
@@ -87,7 +621,7 @@ namespace Spartan
         const auto length = static_cast<uint32_t>(value.length());
         Write(length);
 
-        out.write(const_cast<char*>(value.c_str()), length);
+        m_out->write(const_cast<char*>(value.c_str()), length);
     }
 
     void FileStream::Write(const vector<string>& value)
@@ -105,33 +639,38 @@ namespace Spartan
     {
         const auto length = static_cast<uint32_t>(value.size());
         Write(length);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(RHI_Vertex_PosTexNorTan) * length);
+        m_out->write(reinterpret_cast<const char*>(&value[0]), sizeof(RHI_Vertex_PosTexNorTan) * length);
     }
 
     void FileStream::Write(const vector<uint32_t>& value)
     {
         const auto length = static_cast<uint32_t>(value.size());
         Write(length);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(uint32_t) * length);
+        m_out->write(reinterpret_cast<const char*>(&value[0]), sizeof(uint32_t) * length);
     }
 
     void FileStream::Write(const vector<unsigned char>& value)
     {
         const auto size = static_cast<uint32_t>(value.size());
         Write(size);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(unsigned char) * size);
+        m_out->write(reinterpret_cast<const char*>(&value[0]), sizeof(unsigned char) * size);
     }
 
     void FileStream::Write(const vector<byte>& value)
     {
         const auto size = static_cast<uint32_t>(value.size());
         Write(size);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(std::byte) * size);
+        m_out->write(reinterpret_cast<const char*>(&value[0]), sizeof(std::byte) * size);
     }
 
     void FileStream::Write(const atomic<bool>& value)
     {
-        out.write(reinterpret_cast<const char*>(&value), sizeof(bool));
+        m_out->write(reinterpret_cast<const char*>(&value), sizeof(bool));
+    }
+
+    void FileStream::WriteBytes(const void* data, const uint64_t size)
+    {
+        m_out->write(reinterpret_cast<const char*>(data), size);
     }
 
     void FileStream::Skip(uint64_t n)
@@ -139,21 +678,69 @@ namespace Spartan
         // Set the seek cursor to offset n from the current position
         if (m_flags & FileStream_Write)
         {
-            out.seekp(n, ios::cur);
+            m_out->seekp(n, ios::cur);
+        }
+        else if (m_flags & FileStream_Read)
+        {
+            m_in->ignore(n, ios::cur);
+        }
+    }
+
+    void FileStream::Seek(uint64_t position)
+    {
+        if (m_flags & FileStream_Write)
+        {
+            m_out->seekp(position, ios::beg);
         }
         else if (m_flags & FileStream_Read)
         {
-            in.ignore(n, ios::cur);
+            m_in->clear();
+            m_in->seekg(position, ios::beg);
         }
     }
 
+    uint64_t FileStream::GetPosition()
+    {
+        if (m_flags & FileStream_Write)
+            return static_cast<uint64_t>(m_out->tellp());
+
+        if (m_flags & FileStream_Read)
+            return static_cast<uint64_t>(m_in->tellg());
+
+        return 0;
+    }
+
+    template <class T>
+    void FileStream::ReadVector(vector<T>* vec)
+    {
+        if (!vec)
+            return;
+
+        // when mapped, this is a single copy out of the mapping, without zero filling the vector first
+        if (m_mapping && !m_compression)
+        {
+            const span<const T> data = ReadSpan<T>();
+            vec->assign(data.begin(), data.end());
+            return;
+        }
+
+        vec->clear();
+
+        const auto length = ReadAs<uint32_t>();
+
+        vec->reserve(length);
+        vec->resize(length);
+
+        m_in->read(reinterpret_cast<char*>(vec->data()), sizeof(T) * length);
+    }
+
     void FileStream::Read(string* value)
     {
         uint32_t length = 0;
         Read(&length);
 
         value->resize(length);
-        in.read(const_cast<char*>(value->c_str()), length);
+        m_in->read(const_cast<char*>(value->c_str()), length);
     }
 
     void FileStream::Read(vector<string>* vec)
@@ -176,66 +763,75 @@ namespace Spartan
 
     void FileStream::Read(vector<RHI_Vertex_PosTexNorTan>* vec)
     {
-        if (!vec)
-            return;
-
-        vec->clear();
-
-        const auto length = ReadAs<uint32_t>();
-
-        vec->reserve(length);
-        vec->resize(length);
-
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(RHI_Vertex_PosTexNorTan) * length);
+        ReadVector(vec);
     }
 
     void FileStream::Read(vector<uint32_t>* vec)
     {
-        if (!vec)
-            return;
-
-        vec->clear();
-
-        const auto length = ReadAs<uint32_t>();
-
-        vec->reserve(length);
-        vec->resize(length);
-
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(uint32_t) * length);
+        ReadVector(vec);
     }
 
     void FileStream::Read(vector<unsigned char>* vec)
     {
-        if (!vec)
-            return;
-
-        vec->clear();
-
-        const auto length = ReadAs<uint32_t>();
+        ReadVector(vec);
+    }
 
-        vec->reserve(length);
-        vec->resize(length);
+    void FileStream::Read(vector<std::byte>* vec)
+    {
+        ReadVector(vec);
+    }
 
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(unsigned char) * length);
+    void FileStream::Read(std::atomic<bool>* value)
+    {
+        m_in->read(reinterpret_cast<char*>(value), sizeof(bool));
     }
 
-    void FileStream::Read(vector<std::byte>* vec)
+    void FileStream::ReadToEnd(string* value)
     {
-        if (!vec)
-            return;
+        value->assign(istreambuf_iterator<char>(*m_in), istreambuf_iterator<char>());
+    }
 
-        vec->clear();
+    bool FileStream::IsGood() const
+    {
+        // a file that's opened for both is written through the output stream
+        if (m_flags & FileStream_Write)
+            return !m_out->fail();
 
-        const auto length = ReadAs<uint32_t>();
+        return !m_in->fail();
+    }
 
-        vec->reserve(length);
-        vec->resize(length);
+    const byte* FileStream::GetMappedData() const
+    {
+        return m_mapping ? reinterpret_cast<const byte*>(m_mapping->GetData()) : nullptr;
+    }
 
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(std::byte) * length);
+    uint64_t FileStream::GetMappedSize() const
+    {
+        return m_mapping ? m_mapping->GetSize() : 0;
     }
 
-    void FileStream::Read(std::atomic<bool>* value)
+    const byte* FileStream::ReadBytes(const uint64_t size)
     {
-        in.read(reinterpret_cast<char*>(value), sizeof(bool));
+        // bytes that don't cross a block boundary can be read in place
+        if (m_compression)
+        {
+            if (const byte* data = m_compression->Advance(size))
+                return data;
+        }
+        else if (m_mapping)
+        {
+            const byte* data = m_mapping->Advance(size);
+            if (!data)
+            {
+                m_in->setstate(ios::failbit);
+            }
+
+            return data;
+        }
+
+        m_scratch.resize(size);
+        m_in->read(reinterpret_cast<char*>(m_scratch.data()), size);
+
+        return m_in->good() ? m_scratch.data() : nullptr;
     }
 }
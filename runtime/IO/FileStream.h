@@ -22,8 +22,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES ===================
+#include <span>
+#include <memory>
 #include <vector>
 #include <fstream>
+#include <sstream>
+#include <functional>
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 #include "../Math/Vector4.h"
@@ -36,11 +40,27 @@ namespace Spartan
 {
     enum FileStream_Mode : uint32_t
     {
-        FileStream_Read   = 1 << 0,
-        FileStream_Write  = 1 << 1,
-        FileStream_Append = 1 << 2,
+        FileStream_Read       = 1 << 0,
+        FileStream_Write      = 1 << 1,
+        FileStream_Append     = 1 << 2,
+        FileStream_Memory     = 1 << 3, // reads and writes an in-memory buffer instead of a file, the path is ignored
+        FileStream_Mapped     = 1 << 4, // with FileStream_Read, maps the file into memory, falls back to buffered reads if it can't be mapped
+        FileStream_Compressed = 1 << 5, // with FileStream_Write, compresses the file in blocks when it's closed, reading detects it on its own
     };
 
+    struct FileStreamCompressionStats
+    {
+        uint64_t bytes_written_raw        = 0;
+        uint64_t bytes_written_compressed = 0;
+        uint64_t bytes_read_compressed    = 0;
+        uint64_t bytes_read_raw           = 0;
+        double write_ms                   = 0.0; // compressing and writing
+        double read_ms                    = 0.0; // decompressing
+    };
+
+    class MappedFileBuffer;
+    class CompressedFileBuffer;
+
     class FileStream
     {
     public:
@@ -48,7 +68,25 @@ namespace Spartan
         ~FileStream();
 
         auto IsOpen() const { return m_is_open; }
+        bool IsMapped() const     { return m_mapping != nullptr; }
+        bool IsCompressed() const { return m_compression != nullptr; } // reading only
+        bool IsGood() const; // false once a read or a write has failed, e.g. by going past the end of the file
+
+        // the whole file when it's mapped, nullptr otherwise, valid until the stream is closed
+        const std::byte* GetMappedData() const;
+        uint64_t GetMappedSize() const;
+
+        // totals across all streams since startup
+        static FileStreamCompressionStats GetCompressionStats();
+
+        // writes next to the path and renames over it once the whole file made it to disk, so that a crash or another
+        // thread writing the same path can't leave a half written file behind, false (and the path untouched) if it failed
+        static bool WriteAtomic(const std::string& path, const uint32_t flags, const std::function<void(FileStream& file)>& write);
+
+        // the format that FileStream_Compressed writes, for data that ends up somewhere other than its own file
+        static std::string Compress(const std::string_view data);
         void Close();
+        std::string GetMemory() const { return m_memory.str(); } // the buffer of a memory stream
 
         //= WRITING ==================================================
         template <class T, class = typename std::enable_if<
@@ -76,7 +114,7 @@ namespace Spartan
         >::type>
         void Write(T value)
         {
-            out.write(reinterpret_cast<char*>(&value), sizeof(value));
+            m_out->write(reinterpret_cast<char*>(&value), sizeof(value));
         }
 
         void Write(const std::string& value);
@@ -86,7 +124,10 @@ namespace Spartan
         void Write(const std::vector<unsigned char>& value);
         void Write(const std::vector<std::byte>& value);
         void Write(const std::atomic<bool>& value);
+        void WriteBytes(const void* data, const uint64_t size); // no size prefix
         void Skip(uint64_t n);
+        void Seek(uint64_t position); // from the start of the file
+        uint64_t GetPosition();
         //===========================================================
         
         //= READING ===========================================
@@ -116,7 +157,7 @@ namespace Spartan
         >::type>
         void Read(T* value)
         {
-            in.read(reinterpret_cast<char*>(value), sizeof(T));
+            m_in->read(reinterpret_cast<char*>(value), sizeof(T));
         }
         void Read(std::string* value);
         void Read(std::vector<std::string>* vec);
@@ -126,6 +167,31 @@ namespace Spartan
         void Read(std::vector<std::byte>* vec);
         void Read(std::atomic<bool>* value);
 
+        // reads the same length prefixed arrays as the vector overloads, but returns a view instead of a copy
+        // when mapped, the view points into the file and is valid until the stream is closed, otherwise
+        // it points into a scratch buffer and is valid until the next view is read
+        template <class T>
+        std::span<const T> ReadSpan()
+        {
+            const uint32_t length = ReadAs<uint32_t>();
+            const uint64_t size   = static_cast<uint64_t>(length) * sizeof(T);
+            const std::byte* data = ReadBytes(size);
+            if (!data)
+                return std::span<const T>();
+
+            // nothing aligns the arrays within a file, a view that would be misaligned for T is
+            // copied into the scratch buffer instead, which is allocated with new so it's aligned for any T
+            if (reinterpret_cast<uintptr_t>(data) % alignof(T) != 0)
+            {
+                m_scratch.assign(data, data + size);
+                data = m_scratch.data();
+            }
+
+            return std::span<const T>(reinterpret_cast<const T*>(data), length);
+        }
+        const std::byte* ReadBytes(const uint64_t size); // no size prefix, same lifetime as ReadSpan()
+        void ReadToEnd(std::string* value);               // no size prefix, everything from the current position on
+
         // Reading with explicit type definition
         template <class T, class = typename std::enable_if
         <
@@ -155,8 +221,20 @@ namespace Spartan
         //=====================================================
 
     private:
+        template <class T>
+        void ReadVector(std::vector<T>* vec);
+        void WriteCompressed();
+
         std::ofstream out;
         std::ifstream in;
+        std::stringstream m_memory;
+        std::unique_ptr<MappedFileBuffer> m_mapping;
+        std::unique_ptr<CompressedFileBuffer> m_compression;
+        std::shared_ptr<const void> m_package; // keeps the package that's read from mapped
+        std::istream m_buffer_in = std::istream(nullptr); // reads from the mapping or the decompressed blocks
+        std::vector<std::byte> m_scratch;
+        std::ostream* m_out = &out;
+        std::istream* m_in  = &in;
         uint32_t m_flags;
         bool m_is_open;
     };
@@ -0,0 +1,361 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========
+#include "pch.h"
+#include "Package.h"
+#include "FileStream.h"
+#include <shared_mutex>
+//======================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    namespace
+    {
+        // a header, the table of contents and then the payloads, each one starting on an alignment boundary
+        const uint32_t package_magic     = 0x4B505053; // "SPPK"
+        const uint32_t package_version   = 1;
+        const uint32_t package_alignment = 4096;
+
+        struct package_entry
+        {
+            uint64_t hash   = 0;
+            uint64_t offset = 0;
+            uint64_t size   = 0;
+            string path;
+            const char* data = nullptr;           // once mounted
+            shared_ptr<const FileStream> package; // the mapping that data points into
+        };
+
+        // streams that read from a package hold on to its mapping, so unmounting never pulls the memory from under them
+        vector<shared_ptr<const FileStream>> packages; // mapped
+        unordered_map<uint64_t, package_entry> entries;
+        atomic<uint32_t> entry_count = 0;
+        shared_mutex entries_mutex;
+        string working_directory;
+
+        // paths are stored relative to the working directory, with forward slashes
+        string normalize_path(const string& path)
+        {
+            string result = path;
+            replace(result.begin(), result.end(), '\\', '/');
+
+            if (!working_directory.empty() && result.size() > working_directory.size() && result.compare(0, working_directory.size(), working_directory) == 0)
+            {
+                result.erase(0, working_directory.size());
+            }
+
+            while (result.size() > 2 && result[0] == '.' && result[1] == '/')
+            {
+                result.erase(0, 2);
+            }
+
+            result.erase(unique(result.begin(), result.end(), [](const char a, const char b) { return a == '/' && b == '/'; }), result.end());
+
+            return result;
+        }
+
+        bool read_file(const string& path, string* data)
+        {
+            // not through FileStream, compressed files have to be packed as they are
+            ifstream file(path, ios::binary);
+            if (!file)
+                return false;
+
+            data->assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+            return true;
+        }
+
+        // expects entries_mutex to be locked
+        const package_entry* find_entry(const string& path)
+        {
+            const string path_normalized = normalize_path(path);
+            auto it                      = entries.find(FileSystem::Hash(path_normalized));
+
+            // the path is compared as well, so that a path that isn't packed can never alias one that is
+            if (it == entries.end() || it->second.path != path_normalized)
+                return nullptr;
+
+            return &it->second;
+        }
+
+        // the header and the table of contents, false if it's not a package, a newer version of one, or cut short
+        bool read_table_of_contents(FileStream& file, vector<package_entry>* contents)
+        {
+            const uint32_t magic   = file.ReadAs<uint32_t>();
+            const uint32_t version = file.ReadAs<uint32_t>();
+            if (magic != package_magic || version > package_version)
+                return false;
+
+            const uint32_t count = file.ReadAs<uint32_t>();
+            file.ReadAs<uint32_t>(); // alignment
+
+            contents->resize(count);
+            for (package_entry& entry : *contents)
+            {
+                file.Read(&entry.hash);
+                file.Read(&entry.offset);
+                file.Read(&entry.size);
+                file.Read(&entry.path);
+            }
+
+            return file.IsGood();
+        }
+    }
+
+    bool Package::Build(const vector<string>& directories, const string& file_path, const bool compress)
+    {
+        const Stopwatch timer;
+        {
+            unique_lock lock(entries_mutex);
+            working_directory = FileSystem::GetWorkingDirectory() + "/";
+        }
+
+        // only engine files, the third party importers read from the disk themselves
+        vector<package_entry> contents;
+        shared_lock lock_paths(entries_mutex); // normalizing reads the working directory
+        for (const string& directory : directories)
+        {
+            if (!FileSystem::IsDirectory(directory))
+            {
+                SP_LOG_WARNING("\"%s\" is not a directory", directory.c_str());
+                continue;
+            }
+
+            for (const filesystem::directory_entry& entry : filesystem::recursive_directory_iterator(directory))
+            {
+                const string path = normalize_path(entry.path().generic_string());
+                if (entry.is_regular_file() && FileSystem::IsEngineFile(path))
+                {
+                    contents.emplace_back().path = path;
+                }
+            }
+        }
+
+        lock_paths.unlock();
+
+        sort(contents.begin(), contents.end(), [](const package_entry& a, const package_entry& b) { return a.path < b.path; });
+        contents.erase(unique(contents.begin(), contents.end(), [](const package_entry& a, const package_entry& b) { return a.path == b.path; }), contents.end());
+
+        // the table of contents is keyed by the hash alone, so two paths can't share one
+        unordered_map<uint64_t, string> hashes;
+        for (package_entry& entry : contents)
+        {
+            entry.hash = FileSystem::Hash(entry.path);
+            if (!hashes.emplace(entry.hash, entry.path).second)
+            {
+                SP_LOG_ERROR("\"%s\" and \"%s\" have the same hash, rename one of them", entry.path.c_str(), hashes[entry.hash].c_str());
+                return false;
+            }
+        }
+
+        FileStream file(file_path, FileStream_Write);
+        if (!file.IsOpen())
+        {
+            SP_LOG_ERROR("Failed to create \"%s\"", file_path.c_str());
+            return false;
+        }
+
+        // a package that wasn't fully written is deleted, so that nothing mounts it
+        auto fail = [&file, &file_path]()
+        {
+            file.Close();
+            FileSystem::Delete(file_path);
+            return false;
+        };
+
+        // header
+        file.Write(package_magic);
+        file.Write(package_version);
+        file.Write(static_cast<uint32_t>(contents.size()));
+        file.Write(package_alignment);
+
+        // table of contents, it's written twice, the offsets and sizes are only known once the payloads are written
+        const uint64_t toc_position = file.GetPosition();
+        for (const package_entry& entry : contents)
+        {
+            file.Write(entry.hash);
+            file.Write(entry.offset);
+            file.Write(entry.size);
+            file.Write(entry.path);
+        }
+
+        // payloads
+        const vector<char> padding(package_alignment, 0);
+        uint64_t size_raw = 0;
+        string data;
+        for (package_entry& entry : contents)
+        {
+            if (!read_file(entry.path, &data))
+            {
+                SP_LOG_ERROR("Failed to read \"%s\"", entry.path.c_str());
+                return fail();
+            }
+            size_raw += data.size();
+
+            // keep it compressed only if that's worth the decompression when loading, files that are compressed already are left alone
+            uint32_t magic = 0;
+            memcpy(&magic, data.data(), min<size_t>(sizeof(magic), data.size()));
+            if (compress && magic != 0x5A425053) // "SPBZ"
+            {
+                string data_compressed = FileStream::Compress(data);
+                if (data_compressed.size() < data.size() * 9 / 10)
+                {
+                    data = move(data_compressed);
+                }
+            }
+
+            file.WriteBytes(padding.data(), (package_alignment - file.GetPosition() % package_alignment) % package_alignment);
+            entry.offset = file.GetPosition();
+            entry.size   = data.size();
+            file.WriteBytes(data.data(), data.size());
+        }
+        const uint64_t size_package = file.GetPosition();
+
+        file.Seek(toc_position);
+        for (const package_entry& entry : contents)
+        {
+            file.Write(entry.hash);
+            file.Write(entry.offset);
+            file.Write(entry.size);
+            file.Write(entry.path);
+        }
+
+        // a failed write leaves the stream failed, so this also covers the payloads
+        if (!file.IsGood())
+        {
+            SP_LOG_ERROR("Failed to write \"%s\"", file_path.c_str());
+            return fail();
+        }
+
+        file.Close();
+        if (!file.IsGood())
+        {
+            SP_LOG_ERROR("Failed to write \"%s\"", file_path.c_str());
+            FileSystem::Delete(file_path);
+            return false;
+        }
+
+        SP_LOG_INFO("Packed %u files into \"%s\", %.1f MB from %.1f MB. Duration %.2f ms",
+            static_cast<uint32_t>(contents.size()), file_path.c_str(), size_package / (1024.0 * 1024.0), size_raw / (1024.0 * 1024.0), timer.GetElapsedTimeMs());
+
+        return true;
+    }
+
+    bool Package::Mount(const string& file_path)
+    {
+        shared_ptr<FileStream> file = make_shared<FileStream>(file_path, FileStream_Read | FileStream_Mapped);
+        if (!file->IsOpen())
+            return false;
+
+        // the payloads are handed out as pointers into the mapping
+        if (!file->IsMapped() || file->IsCompressed())
+        {
+            SP_LOG_ERROR("\"%s\" couldn't be memory mapped", file_path.c_str());
+            return false;
+        }
+
+        // header and table of contents
+        vector<package_entry> contents;
+        if (!read_table_of_contents(*file, &contents))
+        {
+            SP_LOG_ERROR("\"%s\" is not a package, a newer version of one, or corrupted", file_path.c_str());
+            return false;
+        }
+        const uint32_t count = static_cast<uint32_t>(contents.size());
+
+        // resolve the payloads
+        const char* base    = reinterpret_cast<const char*>(file->GetMappedData());
+        const uint64_t size = file->GetMappedSize();
+        for (package_entry& entry : contents)
+        {
+            if (entry.offset > size || entry.size > size - entry.offset)
+            {
+                SP_LOG_ERROR("\"%s\" is truncated", file_path.c_str());
+                return false;
+            }
+
+            entry.data    = base + entry.offset;
+            entry.package = file;
+        }
+
+        {
+            unique_lock lock(entries_mutex);
+
+            working_directory = FileSystem::GetWorkingDirectory() + "/";
+            for (package_entry& entry : contents)
+            {
+                entries[entry.hash] = move(entry);
+            }
+            entry_count = static_cast<uint32_t>(entries.size());
+            packages.emplace_back(move(file));
+        }
+
+        SP_LOG_INFO("Mounted \"%s\", %u files", file_path.c_str(), count);
+
+        return true;
+    }
+
+    void Package::UnmountAll()
+    {
+        unique_lock lock(entries_mutex);
+
+        entries.clear();
+        entry_count = 0;
+        packages.clear();
+    }
+
+    uint32_t Package::GetMountedCount()
+    {
+        shared_lock lock(entries_mutex);
+        return static_cast<uint32_t>(packages.size());
+    }
+
+    bool Package::Exists(const string& path)
+    {
+        if (entry_count == 0)
+            return false;
+
+        shared_lock lock(entries_mutex);
+        return find_entry(path) != nullptr;
+    }
+
+    bool Package::Find(const string& path, const char** data, uint64_t* size, shared_ptr<const void>* mapping)
+    {
+        if (entry_count == 0)
+            return false;
+
+        shared_lock lock(entries_mutex);
+        const package_entry* entry = find_entry(path);
+        if (!entry)
+            return false;
+
+        *data    = entry->data;
+        *size    = entry->size;
+        *mapping = entry->package;
+
+        return true;
+    }
+}
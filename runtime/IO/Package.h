@@ -0,0 +1,50 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====
+#include <string>
+#include <vector>
+#include <memory>
+//================
+
+namespace Spartan
+{
+    // many files in one, with a table of contents keyed by the hash of each path and page aligned payloads
+    // mounted packages are memory mapped, FileSystem::Exists() and FileStream look inside them before going to disk
+    class Package
+    {
+    public:
+        // packs the engine files under the directories, the paths are kept as given, so they should be relative to the working directory
+        static bool Build(const std::vector<std::string>& directories, const std::string& file_path, const bool compress = true);
+
+        // files in packages that are mounted later take precedence
+        static bool Mount(const std::string& file_path);
+        static void UnmountAll(); // streams that are still reading from a package keep it mapped until they are closed
+        static uint32_t GetMountedCount();
+
+        // the data is the stored payload, it can be compressed, FileStream takes care of that
+        // it points into the mapping of the package, which stays mapped for as long as the package is mounted or the returned mapping is held
+        static bool Exists(const std::string& path);
+        static bool Find(const std::string& path, const char** data, uint64_t* size, std::shared_ptr<const void>* mapping);
+    };
+}
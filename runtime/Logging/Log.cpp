@@ -19,12 +19,13 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =================
+//= INCLUDES =====================
 #include "pch.h"
 #include "ILogger.h"
 #include "../World/Entity.h"
 #include "../Core/Debugging.h"
-//============================
+#include "../Core/LockFreeQueue.h"
+//================================
 
 //= NAMESPACES ===============
 using namespace std;
@@ -35,36 +36,175 @@ namespace Spartan
 {
     namespace
     {
-        vector<LogCmd> logs;
-        string log_file_name = "log.txt";
-        ILogger* logger      = nullptr;
-        bool log_to_file     = true;
+        // a formatted line, messages longer than the slot are truncated
+        struct log_entry
+        {
+            LogType type;
+            bool to_file;
+            char text[1016];
+        };
+
+        const uint32_t history_max       = 1024; // lines kept for loggers that are set later
+        const uint32_t flush_interval_ms = 50;
+
+        // ring buffer (writers format into it, the background thread drains it)
+        LockFreeQueue<log_entry, 1024> entries;
+        atomic<uint32_t> entries_pending = 0;
+        atomic<uint64_t> dropped_count   = 0;
+        atomic<uint64_t> evicted_count   = 0;
+
+        // background writer
+        thread writer;
+        mutex mutex_writer;
+        condition_variable condition_writer;
+        atomic<bool> writer_running  = false;
+        atomic<bool> flush_requested = false;
+
+        // only touched while holding mutex_drain
+        mutex mutex_drain;
+        deque<LogCmd> history;
+        ofstream file;
+        string file_buffer;
+        vector<LogCmd> deliver_queue; // lines for the logger, in order
+        bool delivering = false;      // a thread is handing lines to the logger
+        thread_local bool delivering_this_thread = false;
+
+        atomic<ILogger*> logger  = nullptr;
+        atomic<bool> log_to_file = true;
+        string log_file_name     = "log.txt";
+
+        const char* get_prefix(const LogType type)
+        {
+            return (type == LogType::Info) ? "Info: " : (type == LogType::Warning) ? "Warning: " : "Error: ";
+        }
 
-        void write_to_file(string text, const LogType type)
+        // hands queued lines to the logger without holding mutex_drain, so a slow (or logging) logger doesn't block writers,
+        // only one thread delivers at a time and it keeps going until the queue is empty, which keeps the lines in order
+        void deliver()
         {
-            const string prefix = (type == LogType::Info) ? "Info:" : (type == LogType::Warning) ? "Warning:" : "Error:";
-            text = prefix + " " + text;
+            vector<LogCmd> lines;
+            while (true)
+            {
+                {
+                    lock_guard<mutex> lock(mutex_drain);
+                    if (lines.empty() && delivering)
+                        return; // another thread (or this one, further up the stack) is delivering
+
+                    lines.clear();
+                    lines.swap(deliver_queue);
+                    delivering = !lines.empty();
+                    if (!delivering)
+                        return;
+                }
 
-            // delete the previous log file (if it exists)
-            static bool is_first_log = true;
-            if (is_first_log)
+                delivering_this_thread = true;
+                if (ILogger* logger_current = logger.load())
+                {
+                    for (const LogCmd& line : lines)
+                    {
+                        logger_current->Log(line.text, static_cast<uint32_t>(line.type));
+                    }
+                }
+                delivering_this_thread = false;
+            }
+        }
+
+        // writes everything that's queued, with a single file write
+        void drain()
+        {
             {
-                FileSystem::Delete(log_file_name);
-                is_first_log = false;
+                lock_guard<mutex> lock(mutex_drain);
+
+                file_buffer.clear();
+                log_entry entry;
+                while (entries.Pop(entry))
+                {
+                    entries_pending.fetch_sub(1, memory_order_relaxed);
+
+                    if (entry.to_file)
+                    {
+                        file_buffer += get_prefix(entry.type);
+                        file_buffer += entry.text;
+                        file_buffer += '\n';
+
+                        history.emplace_back(entry.text, entry.type);
+                        if (history.size() > history_max)
+                        {
+                            history.pop_front();
+                            evicted_count++;
+                        }
+                    }
+
+                    if (logger.load())
+                    {
+                        deliver_queue.emplace_back(entry.text, entry.type);
+                    }
+                }
+
+                if (!file_buffer.empty())
+                {
+                    // the previous log file is replaced on the first write
+                    if (!file.is_open())
+                    {
+                        file.open(log_file_name, ofstream::out | ofstream::trunc);
+                    }
+
+                    if (file.is_open())
+                    {
+                        file.write(file_buffer.data(), file_buffer.size());
+                        file.flush();
+                    }
+                }
+            }
+
+            deliver();
+        }
+
+        void writer_loop()
+        {
+            while (writer_running)
+            {
+                {
+                    unique_lock<mutex> lock(mutex_writer);
+                    condition_writer.wait_for(lock, chrono::milliseconds(flush_interval_ms), [] { return flush_requested.load() || !writer_running; });
+                    flush_requested = false;
+                }
+
+                drain();
             }
 
-            // open/create a log file to write the log into
-            static ofstream fout;
-            fout.open(log_file_name, ofstream::out | ofstream::app);
+            drain();
+        }
 
-            if (fout.is_open())
+        void wake_writer()
+        {
             {
-                // write out the error message
-                fout << text << endl;
+                lock_guard<mutex> lock(mutex_writer);
+                flush_requested = true;
+            }
+            condition_writer.notify_one();
+        }
+
+        // formatting the time is expensive, so do it once per second per thread
+        const char* get_time_stamp()
+        {
+            thread_local time_t time_cached = 0;
+            thread_local char time_stamp[16] = {};
 
-                // close the file
-                fout.close();
+            time_t t = time(nullptr);
+            if (t != time_cached)
+            {
+                time_cached = t;
+                tm tm_local = {};
+                #ifdef _WIN32
+                localtime_s(&tm_local, &t);
+                #else
+                localtime_r(&t, &tm_local);
+                #endif
+                strftime(time_stamp, sizeof(time_stamp), "[%H:%M:%S]", &tm_local);
             }
+
+            return time_stamp;
         }
     }
 
@@ -72,24 +212,59 @@ namespace Spartan
     {
         SP_SUBSCRIBE_TO_EVENT(EventType::RendererOnFirstFrameCompleted, SP_EVENT_HANDLER_EXPRESSION_STATIC( SetLogToFile(false); ));
         SP_SUBSCRIBE_TO_EVENT(EventType::RendererOnShutdown,            SP_EVENT_HANDLER_EXPRESSION_STATIC( SetLogToFile(true);  ));
+
+        writer_running = true;
+        writer         = thread(&writer_loop);
+    }
+
+    void Log::Shutdown()
+    {
+        if (!writer_running)
+            return;
+
+        writer_running = false;
+        wake_writer();
+        writer.join();
+    }
+
+    void Log::Flush()
+    {
+        drain();
     }
 
     void Log::SetLogger(ILogger* logger_in)
     {
-        logger = logger_in;
+        // everything queued so far goes to the previous logger
+        drain();
 
-        // flush the log buffer, if needed
-        if (logger && !logs.empty())
         {
-            if (!logs.empty())
+            lock_guard<mutex> lock(mutex_drain);
+            logger = logger_in;
+
+            // replay the history, if needed
+            if (logger_in)
             {
-                for (const LogCmd& log : logs)
-                {
-                    logger->Log(log.text, static_cast<uint32_t>(log.type));
-                }
-                logs.clear();
+                deliver_queue.insert(deliver_queue.end(), history.begin(), history.end());
+                history.clear();
+            }
+            else
+            {
+                deliver_queue.clear();
             }
         }
+
+        // the previous logger might be about to be destroyed, so wait for any thread that is still handing it lines
+        while (!delivering_this_thread)
+        {
+            {
+                lock_guard<mutex> lock(mutex_drain);
+                if (!delivering)
+                    break;
+            }
+            this_thread::yield();
+        }
+
+        deliver();
     }
 
     void Log::SetLogToFile(const bool log)
@@ -97,32 +272,52 @@ namespace Spartan
         log_to_file = log;
     }
 
+    uint64_t Log::GetDroppedCount()
+    {
+        return dropped_count;
+    }
+
+    uint64_t Log::GetEvictedCount()
+    {
+        return evicted_count;
+    }
+
     // all functions resolve to this one
     void Log::Write(const char* text, const LogType type)
     {
         SP_ASSERT_MSG(text != nullptr, "Text is null");
 
-        // lock mutex
-        static mutex log_mutex;
-        lock_guard<mutex> guard(log_mutex);
+        log_entry entry;
+        entry.type    = type;
+        entry.to_file = log_to_file || !logger || Debugging::IsLoggingToFileEnabled();
+        snprintf(entry.text, sizeof(entry.text), "%s: %s", get_time_stamp(), text);
+
+        // never block, if the writer can't keep up the line is dropped (unless it's an error)
+        uint32_t pending = entries_pending.fetch_add(1, memory_order_relaxed) + 1;
+        bool pushed = entries.Push(entry);
 
-        // add time to the text
-        auto t  = time(nullptr);
-        auto tm = *localtime(&t);
-        ostringstream oss;
-        oss << put_time(&tm, "[%H:%M:%S]");
-        const string final_text = oss.str() + ": " + string(text);
+        // errors are too important to lose, make room for them on this thread
+        if (!pushed && type == LogType::Error)
+        {
+            drain();
+            pushed = entries.Push(entry);
+        }
 
-        // log to file if requested or if an in-engine logger is not available
-        if (log_to_file || !logger || Debugging::IsLoggingToFileEnabled())
+        if (!pushed)
         {
-            logs.emplace_back(final_text, type);
-            write_to_file(final_text, type);
+            entries_pending.fetch_sub(1, memory_order_relaxed);
+            dropped_count++;
+            return;
         }
 
-        if (logger)
+        // wake up the writer early if the ring is filling up (or if nobody is going to drain it)
+        if (!writer_running)
+        {
+            drain();
+        }
+        else if (pending == 512)
         {
-            logger->Log(final_text, static_cast<uint32_t>(type));
+            wake_writer();
         }
     }
 
@@ -74,9 +74,15 @@ namespace Spartan
 
         // misc
         static void Initialize();
+        static void Shutdown();
+        static void Flush(); // blocks until everything that has been written so far is on disk
         static void SetLogger(ILogger* logger);
         static void SetLogToFile(const bool log_to_file);
 
+        // stats
+        static uint64_t GetDroppedCount(); // lines lost because the ring buffer was full
+        static uint64_t GetEvictedCount(); // lines that fell out of the history before a logger could get them
+
         // alpha
         static void Write(const char* text, const LogType type);
         static void WriteFInfo(const char* text, ...);
@@ -37,11 +37,10 @@ namespace Spartan::Math
         ~Frustum() = default;
 
         bool IsVisible(const Vector3& center, const Vector3& extent, bool ignore_depth = false) const;
-
-    private:
         Intersection CheckCube(const Vector3& center, const Vector3& extent, float ignore_depth = false) const;
         Intersection CheckSphere(const Vector3& center, float radius, float ignore_depth = false) const;
 
+    private:
         Plane m_planes[6];
     };
 }
@@ -72,6 +72,9 @@ namespace Spartan
         float picking_distance_previous         = 0.0f;
 
         const bool soft_body_support = true;
+
+        // bodies and constraints can be added and removed from multiple threads, while a world is loading or while cells are streamed in
+        mutex mutex_world;
     }
 
     void Physics::Initialize()
@@ -155,27 +158,15 @@ namespace Spartan
     void Physics::Tick()
     {
         SP_PROFILE_CPU();
-;
+
         // don't simulate or debug draw when loading a world (a different thread could be creating physics objects)
         if (ProgressTracker::IsLoading())
             return;
 
+        lock_guard<mutex> lock(mutex_world);
+
         if (Engine::IsFlagSet(EngineMode::Playing))
         {
-            // Picking
-            {
-                if (Input::GetKeyDown(KeyCode::Click_Left) && Input::GetMouseIsInViewport())
-                {
-                    PickBody();
-                }
-                else if (Input::GetKeyUp(KeyCode::Click_Left))
-                {
-                    UnpickBody();
-                }
-
-                MovePickedBody();
-            }
-
             // accumulate elapsed time
             float freme_time  = static_cast<float>(Timer::GetDeltaTimeSec());
             accumulator      += freme_time;
@@ -193,13 +184,36 @@ namespace Spartan
         }
     }
 
+    void Physics::TickPicking()
+    {
+        if (ProgressTracker::IsLoading() || !Engine::IsFlagSet(EngineMode::Playing))
+            return;
+
+        lock_guard<mutex> lock(mutex_world);
+
+        // the constraint is picked up by the next simulation step
+        if (Input::GetKeyDown(KeyCode::Click_Left) && Input::GetMouseIsInViewport())
+        {
+            PickBody();
+        }
+        else if (Input::GetKeyUp(KeyCode::Click_Left))
+        {
+            UnpickBody();
+        }
+
+        MovePickedBody();
+    }
+
     vector<btRigidBody*> Physics::RayCast(const Vector3& start, const Vector3& end)
     {
         btVector3 bt_start = ToBtVector3(start);
         btVector3 bt_end   = ToBtVector3(end);
 
         btCollisionWorld::AllHitsRayResultCallback ray_callback(bt_start, bt_end);
-        world->rayTest(bt_start, bt_end, ray_callback);
+        {
+            lock_guard<mutex> lock(mutex_world);
+            world->rayTest(bt_start, bt_end, ray_callback);
+        }
 
         vector<btRigidBody*> hit_bodies;
         if (ray_callback.hasHit())
@@ -222,7 +236,10 @@ namespace Spartan
         btVector3 bt_end   = ToBtVector3(end);
 
         btCollisionWorld::ClosestRayResultCallback ray_callback(bt_start, bt_end);
-        world->rayTest(bt_start, bt_end, ray_callback);
+        {
+            lock_guard<mutex> lock(mutex_world);
+            world->rayTest(bt_start, bt_end, ray_callback);
+        }
 
         if (ray_callback.hasHit())
         {
@@ -234,37 +251,44 @@ namespace Spartan
 
     void Physics::AddBody(btRigidBody* body)
     {
+        lock_guard<mutex> lock(mutex_world);
         world->addRigidBody(body);
     }
 
     void Physics::RemoveBody(btRigidBody*& body)
     {
+        lock_guard<mutex> lock(mutex_world);
         world->removeRigidBody(body);
     }
 
     void Physics::AddBody(btRaycastVehicle* body)
     {
+        lock_guard<mutex> lock(mutex_world);
         world->addVehicle(body);
     }
 
     void Physics::RemoveBody(btRaycastVehicle*& body)
     {
+        lock_guard<mutex> lock(mutex_world);
         world->removeVehicle(body);
     }
 
     void Physics::AddConstraint(btTypedConstraint* constraint, bool collision_with_linked_body /*= true*/)
     {
+        lock_guard<mutex> lock(mutex_world);
         world->addConstraint(constraint, !collision_with_linked_body);
     }
 
     void Physics::RemoveConstraint(btTypedConstraint*& constraint)
     {
+        lock_guard<mutex> lock(mutex_world);
         world->removeConstraint(constraint);
         delete constraint;
     }
 
     void Physics::AddBody(btSoftBody* body)
     {
+        lock_guard<mutex> lock(mutex_world);
         if (btSoftRigidDynamicsWorld* _world = static_cast<btSoftRigidDynamicsWorld*>(world))
         {
             _world->addSoftBody(body);
@@ -273,6 +297,7 @@ namespace Spartan
 
     void Physics::RemoveBody(btSoftBody*& body)
     {
+        lock_guard<mutex> lock(mutex_world);
         if (btSoftRigidDynamicsWorld* _world = static_cast<btSoftRigidDynamicsWorld*>(world))
         {
             _world->removeSoftBody(body);
@@ -47,6 +47,7 @@ namespace Spartan
         static void Initialize();
         static void Shutdown();
         static void Tick();
+        static void TickPicking(); // reads input, so it's separate from the simulation which doesn't
 
         static std::vector<btRigidBody*> RayCast(const Math::Vector3& start, const Math::Vector3& end);
         static Math::Vector3 RayCastFirstHitPosition(const Math::Vector3& start, const Math::Vector3& end);
@@ -25,9 +25,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_Device.h"
 #include "../RHI/RHI_Implementation.h"
 #include "../RHI/RHI_SwapChain.h"
+#include "../RHI/RHI_Texture.h"
+#include "../RHI/RHI_Shader.h"
 #include "../Core/ThreadPool.h"
+#include "../Core/FrameAllocator.h"
 #include "../Core/Debugging.h"
 #include "../Rendering/Renderer.h"
+#include "../World/World.h"
+#include "../World/WorldStreaming.h"
+#include "../IO/FileStream.h"
+#include "../IO/AsyncIo.h"
 #include "../Resource/ResourceCache.h"
 #include "../Display/Display.h"
 //====================================
@@ -92,6 +99,20 @@ namespace Spartan
         vector<TimeBlock> m_time_blocks_write;
         vector<TimeBlock> m_time_blocks_read;
 
+        // time blocks of other threads, each thread writes to its own buffer and they are merged when reading
+        const uint32_t max_timeblocks_thread = 64;
+        struct thread_time_blocks
+        {
+            mutex mutex_blocks;
+            vector<TimeBlock> blocks;
+            vector<int32_t> open; // started blocks, -1 for those that weren't recorded, so that starts and ends always pair up
+            uint32_t count        = 0;
+            uint32_t thread_index = 0;
+        };
+        mutex mutex_threads;
+        vector<unique_ptr<thread_time_blocks>> threads_time_blocks;
+        thread_local thread_time_blocks* time_blocks_this_thread = nullptr;
+
         // gpu
         string gpu_name               = "N/A";
         string gpu_driver             = "N/A";
@@ -106,9 +127,26 @@ namespace Spartan
 
         // misc
         string cpu_name           = "N/A";
-        bool poll                 = false;
+        atomic<bool> poll         = false;
         bool allow_time_block_end = true;
 
+        // the thread that initialized the profiler, its time blocks (gpu ones included) form the frame hierarchy
+        thread::id thread_id;
+
+        thread_time_blocks* get_thread_time_blocks()
+        {
+            if (!time_blocks_this_thread)
+            {
+                lock_guard<mutex> lock(mutex_threads);
+                threads_time_blocks.emplace_back(make_unique<thread_time_blocks>());
+                time_blocks_this_thread               = threads_time_blocks.back().get();
+                time_blocks_this_thread->thread_index = static_cast<uint32_t>(threads_time_blocks.size());
+                time_blocks_this_thread->blocks.resize(max_timeblocks_thread);
+            }
+
+            return time_blocks_this_thread;
+        }
+
         string get_cpu_name()
         {
             #ifdef _WIN32
@@ -153,12 +191,13 @@ namespace Spartan
   
     void Profiler::Initialize()
     {
-        m_time_blocks_read.reserve(max_timeblocks);
-        m_time_blocks_read.resize(max_timeblocks);
+        m_time_blocks_read.reserve(max_timeblocks * 2);
+        m_time_blocks_read.resize(max_timeblocks * 2);
         m_time_blocks_write.reserve(max_timeblocks);
         m_time_blocks_write.resize(max_timeblocks);
 
-        cpu_name = get_cpu_name();
+        cpu_name  = get_cpu_name();
+        thread_id = this_thread::get_id();
     }
 
     void Profiler::PostTick()
@@ -175,12 +214,12 @@ namespace Spartan
                 if (!time_block.IsComplete())
                     continue;
 
-                if (!time_block.GetParent() && time_block.GetType() == TimeBlockType::Cpu)
+                if (!time_block.HasParent() && time_block.GetType() == TimeBlockType::Cpu && time_block.GetThreadIndex() == 0)
                 {
                     time_cpu_last += time_block.GetDuration();
                 }
 
-                if (!time_block.GetParent() && time_block.GetType() == TimeBlockType::Gpu)
+                if (!time_block.HasParent() && time_block.GetType() == TimeBlockType::Gpu)
                 {
                     time_gpu_last += time_block.GetDuration();
                 }
@@ -249,9 +288,9 @@ namespace Spartan
 
     void Profiler::ReadTimeBlocks()
     {
-        // clear read array
+        // clear read array (half of it is for the blocks of other threads)
         m_time_blocks_read.clear();
-        m_time_blocks_read.resize(max_timeblocks);
+        m_time_blocks_read.resize(max_timeblocks * 2);
 
         // copy from write array to read array
         for (uint32_t i = 0; i < static_cast<uint32_t>(m_time_blocks_write.size()); i++)
@@ -278,10 +317,80 @@ namespace Spartan
         m_time_blocks_write.resize(max_timeblocks);
 
         m_time_block_index = -1;
+
+        // append the completed blocks of other threads
+        uint32_t index_read = max_timeblocks;
+        lock_guard<mutex> lock_threads(mutex_threads);
+        for (unique_ptr<thread_time_blocks>& time_blocks : threads_time_blocks)
+        {
+            lock_guard<mutex> lock(time_blocks->mutex_blocks);
+
+            // parents start before their children, so a parent is always remapped before its children are copied
+            vector<int32_t> index_remap(time_blocks->count, -1);
+            for (uint32_t i = 0; i < time_blocks->count; i++)
+            {
+                const TimeBlock& time_block = time_blocks->blocks[i];
+                if (!time_block.IsComplete() || index_read >= static_cast<uint32_t>(m_time_blocks_read.size()))
+                    continue;
+
+                // parents that are still open aren't copied, so their children show up as roots
+                TimeBlock& time_block_read = m_time_blocks_read[index_read];
+                time_block_read            = time_block;
+                time_block_read.SetParentIndex(time_block.HasParent() ? index_remap[time_block.GetParentIndex()] : -1);
+                index_remap[i]             = static_cast<int32_t>(index_read++);
+            }
+
+            // keep only the blocks that are still open, moved to the front, so that a long running block doesn't fill up the buffer
+            fill(index_remap.begin(), index_remap.end(), -1);
+            uint32_t count = 0;
+            for (int32_t& index : time_blocks->open)
+            {
+                if (index < 0)
+                    continue;
+
+                // open blocks are in ascending order, so this never overwrites one that hasn't been moved yet
+                TimeBlock time_block = time_blocks->blocks[index];
+                time_block.SetParentIndex(time_block.HasParent() ? index_remap[time_block.GetParentIndex()] : -1);
+                index_remap[index]           = static_cast<int32_t>(count);
+                index                        = static_cast<int32_t>(count);
+                time_blocks->blocks[count++] = time_block;
+            }
+
+            for (uint32_t i = count; i < time_blocks->count; i++)
+            {
+                time_blocks->blocks[i] = TimeBlock();
+            }
+            time_blocks->count = count;
+        }
     }
 
     void Profiler::TimeBlockStart(const char* func_name, TimeBlockType type, RHI_CommandList* cmd_list /*= nullptr*/)
     {
+        // other threads record cpu blocks into their own buffer
+        if (this_thread::get_id() != thread_id)
+        {
+            thread_time_blocks* time_blocks = get_thread_time_blocks();
+            lock_guard<mutex> lock(time_blocks->mutex_blocks);
+
+            int32_t index = -1;
+            if (Debugging::IsGpuTimingEnabled() && poll && type == TimeBlockType::Cpu && profile_cpu && time_blocks->count < max_timeblocks_thread)
+            {
+                // the last recorded block that is still open, is the parent
+                int32_t parent_index = -1;
+                for (auto it = time_blocks->open.rbegin(); it != time_blocks->open.rend() && parent_index < 0; it++)
+                {
+                    parent_index = *it;
+                }
+                const uint32_t tree_depth = parent_index >= 0 ? time_blocks->blocks[parent_index].GetTreeDepth() + 1 : 0;
+
+                index = static_cast<int32_t>(time_blocks->count++);
+                time_blocks->blocks[index].Begin(0, func_name, type, parent_index, tree_depth, nullptr, time_blocks->thread_index);
+            }
+            time_blocks->open.emplace_back(index);
+
+            return;
+        }
+
         if (!Debugging::IsGpuTimingEnabled() || !poll)
             return;
 
@@ -293,14 +402,34 @@ namespace Spartan
 
         // last incomplete block of the same type, is the parent
         TimeBlock* time_block_parent = GetLastIncompleteTimeBlock(type);
+        const int32_t parent_index   = time_block_parent ? static_cast<int32_t>(time_block_parent - m_time_blocks_write.data()) : -1;
+        const uint32_t tree_depth    = time_block_parent ? time_block_parent->GetTreeDepth() + 1 : 0;
 
         // get new time block
         TimeBlock& new_time_block = m_time_blocks_write[++m_time_block_index];
-        new_time_block.Begin(++m_rhi_timeblock_count, func_name, type, time_block_parent, cmd_list);
+        new_time_block.Begin(++m_rhi_timeblock_count, func_name, type, parent_index, tree_depth, cmd_list);
     }
 
     void Profiler::TimeBlockEnd()
     {
+        if (this_thread::get_id() != thread_id)
+        {
+            thread_time_blocks* time_blocks = get_thread_time_blocks();
+            lock_guard<mutex> lock(time_blocks->mutex_blocks);
+
+            if (!time_blocks->open.empty())
+            {
+                int32_t index = time_blocks->open.back();
+                time_blocks->open.pop_back();
+                if (index >= 0)
+                {
+                    time_blocks->blocks[index].End();
+                }
+            }
+
+            return;
+        }
+
         if (TimeBlock* time_block = GetLastIncompleteTimeBlock(TimeBlockType::Cpu))
         {
             time_block->End();
@@ -426,6 +555,13 @@ namespace Spartan
         if (metrics_time_since_last_update >= profiling_interval_sec)
         {
             metrics_time_since_last_update = 0.0f;
+
+            const FileStreamCompressionStats compression = FileStream::GetCompressionStats();
+            const RHI_CacheStats texture_cache            = RHI_Texture::GetCacheStats();
+            const RHI_CacheStats shader_cache             = RHI_Shader::GetCacheStats();
+            const double compression_ratio              = compression.bytes_written_compressed != 0 ? static_cast<double>(compression.bytes_written_raw) / compression.bytes_written_compressed : 0.0;
+            const double compression_write_mbps         = compression.write_ms != 0.0 ? compression.bytes_written_raw / (1024.0 * 1024.0) / (compression.write_ms / 1000.0) : 0.0;
+            const double compression_read_mbps          = compression.read_ms  != 0.0 ? compression.bytes_read_raw    / (1024.0 * 1024.0) / (compression.read_ms  / 1000.0) : 0.0;
     
             snprintf(metrics_buffer, sizeof(metrics_buffer),
                 "FPS:\t\t\t%.1f\n"
@@ -444,6 +580,13 @@ namespace Spartan
                 "Name:\t\t\t\t\t\t%s\n"
                 "Threads:\t\t\t\t\t%u\n"
                 "Worker threads:\t%u/%u\n"
+                "Frame allocator:\t%u KB (%u heap)\n"
+                "Transforms:\t\t\t%u updated\n"
+                "Streaming:\t\t\t%u/%u cells, %u loading, %u KB in flight\n"
+                "Compression:\t\t%.2fx, %.0f MB/s write, %.0f MB/s read\n"
+                "Async IO:\t\t\t%s, %u pending, %u KB in flight\n"
+                "Texture cache:\t%u hits, %u misses, %.1f s saved\n"
+                "Shader cache:\t\t%u hits, %u misses, %.1f s saved\n"
                 #ifdef __AVX2__
                 "AVX2:\t\t\t\t\t\t\tYes\n"
                 #else
@@ -486,6 +629,13 @@ namespace Spartan
                 cpu_name.c_str(),
                 thread::hardware_concurrency(),
                 ThreadPool::GetWorkingThreadCount(), ThreadPool::GetThreadCount(),
+                static_cast<uint32_t>(FrameAllocator::GetBytesAllocated() / 1024), FrameAllocator::GetHeapAllocationCount(),
+                World::GetTransformUpdateCount(),
+                WorldStreaming::GetResidentCellCount(), WorldStreaming::GetCellCount(), WorldStreaming::GetPendingLoadCount(), static_cast<uint32_t>(WorldStreaming::GetBytesInFlight() / 1024),
+                compression_ratio, compression_write_mbps, compression_read_mbps,
+                AsyncIo::IsUsingIoUring() ? "io_uring" : "thread", AsyncIo::GetPendingCount(), static_cast<uint32_t>(AsyncIo::GetBytesInFlight() / 1024),
+                texture_cache.hits, texture_cache.misses, texture_cache.time_saved_ms / 1000.0,
+                shader_cache.hits, shader_cache.misses, shader_cache.time_saved_ms / 1000.0,
 
                 Display::GetName(),
                 Display::GetRefreshRate(),
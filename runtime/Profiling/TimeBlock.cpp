@@ -38,14 +38,20 @@ namespace Spartan
 
     }
 
-    void TimeBlock::Begin(const uint32_t id, const char* name, TimeBlockType type, const TimeBlock* parent /*= nullptr*/, RHI_CommandList* cmd_list /*= nullptr*/)
+    void TimeBlock::Begin(const uint32_t id, const char* name, TimeBlockType type, const int32_t parent_index /*= -1*/, const uint32_t tree_depth /*= 0*/, RHI_CommandList* cmd_list /*= nullptr*/, const uint32_t thread_index /*= 0*/)
     {
-        m_id             = id;
-        m_name           = name;
-        m_parent         = parent;
-        m_tree_depth     = FindTreeDepth(this);
-        m_type           = type;
-        m_max_tree_depth = Math::Helper::Max(m_max_tree_depth, m_tree_depth);
+        m_id           = id;
+        m_name         = name;
+        m_parent_index = parent_index;
+        m_tree_depth   = tree_depth;
+        m_type         = type;
+        m_thread_index = thread_index;
+
+        // the max depth is shared, so only the main thread updates it
+        if (thread_index == 0)
+        {
+            m_max_tree_depth = Math::Helper::Max(m_max_tree_depth, m_tree_depth);
+        }
 
         if (cmd_list)
         {
@@ -89,14 +95,4 @@ namespace Spartan
 
         m_is_complete = true;
     }
-
-    uint32_t TimeBlock::FindTreeDepth(const TimeBlock* time_block, uint32_t depth /*= 0*/)
-    {
-        if (time_block && time_block->GetParent())
-        {
-            depth = FindTreeDepth(time_block->GetParent(), ++depth);
-        }
-
-        return depth;
-    }
 }
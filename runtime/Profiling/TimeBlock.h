@@ -43,30 +43,36 @@ namespace Spartan
         TimeBlock() = default;
         ~TimeBlock();
 
-        void Begin(const uint32_t id, const char* name, TimeBlockType type, const TimeBlock* parent = nullptr, RHI_CommandList* cmd_list = nullptr);
+        // the parent is referred to by its index in the array that holds both, so that copying or moving the blocks keeps them linked
+        void Begin(const uint32_t id, const char* name, TimeBlockType type, const int32_t parent_index = -1, const uint32_t tree_depth = 0, RHI_CommandList* cmd_list = nullptr, const uint32_t thread_index = 0);
         void End();
 
         TimeBlockType GetType()      const { return m_type; }
         const char* GetName()        const { return m_name; }
-        const TimeBlock* GetParent() const { return m_parent; }
+        int32_t GetParentIndex()     const { return m_parent_index; }
+        bool HasParent()             const { return m_parent_index >= 0; }
         uint32_t GetTreeDepth()      const { return m_tree_depth; }
         uint32_t GetTreeDepthMax()   const { return m_max_tree_depth; }
         float GetDuration()          const { return m_duration; }
         bool IsComplete()            const { return m_is_complete; }
         uint32_t GetId()             const { return m_id; }
+        uint32_t GetThreadIndex()    const { return m_thread_index; } // 0 is the main thread
+
+        // for when the array that holds the blocks is compacted
+        void SetParentIndex(const int32_t parent_index) { m_parent_index = parent_index; }
 
     private:    
-        static uint32_t FindTreeDepth(const TimeBlock* time_block, uint32_t depth = 0);
         static uint32_t m_max_tree_depth;
 
         const char* m_name         = nullptr;
         TimeBlockType m_type       = TimeBlockType::Max;
         float m_duration           = 0.0f;
-        const TimeBlock* m_parent  = nullptr;
+        int32_t m_parent_index     = -1;
         uint32_t m_tree_depth      = 0;
         bool m_is_complete         = false;
         uint32_t m_id              = 0;
         uint32_t m_timestamp_index = 0;
+        uint32_t m_thread_index    = 0;
 
         // Dependencies
         RHI_CommandList* m_cmd_list = nullptr;
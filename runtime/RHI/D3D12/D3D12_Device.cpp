@@ -257,7 +257,7 @@ namespace Spartan
         return false;
     }
 
-    void RHI_Device::UpdateBindlessResources(const array<shared_ptr<RHI_Sampler>, static_cast<uint32_t>(Renderer_Sampler::Max)>* samplers, array<RHI_Texture*, rhi_max_array_size>* textures)
+    void RHI_Device::UpdateBindlessResources(const array<shared_ptr<RHI_Sampler>, static_cast<uint32_t>(Renderer_Sampler::Max)>* samplers, array<RHI_Texture*, rhi_max_array_size>* textures, const uint32_t texture_start, const uint32_t texture_count)
     {
 
     }
@@ -276,4 +276,14 @@ namespace Spartan
     {
         return 0;
     }
+
+    void RHI_Device::PipelineCacheSetLightTextures(const vector<array<RHI_Texture*, 2>>& textures)
+    {
+
+    }
+
+    void RHI_Device::PipelineCacheCancelPrewarm()
+    {
+
+    }
 }
@@ -37,6 +37,8 @@ namespace Spartan
 {
     RHI_Shader::~RHI_Shader()
     {
+        ClearDependencies();
+
         if (m_rhi_resource)
         {
             RHI_Device::QueueWaitAll();
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <cstdint>
 #include <cassert>
 #include <limits>
+#include <atomic>
 #include "../Rendering/Color.h"
 //=============================
 
@@ -313,6 +314,40 @@ namespace Spartan
         textures_material
     };
 
+    // how well a cache of prepared gpu data (compiled shaders, generated mips) does
+    struct RHI_CacheStats
+    {
+        uint32_t hits        = 0;
+        uint32_t misses      = 0;
+        double time_saved_ms = 0.0; // how long the hits took to prepare when they were cached, minus how long they took to load
+    };
+
+    // the counters behind RHI_CacheStats, they can be updated from any thread
+    struct RHI_CacheCounters
+    {
+        std::atomic<uint32_t> hits         = 0;
+        std::atomic<uint32_t> misses       = 0;
+        std::atomic<int64_t> time_saved_us = 0;
+
+        void Hit(const double prepare_ms, const double load_ms)
+        {
+            hits++;
+            time_saved_us += static_cast<int64_t>((prepare_ms - load_ms) * 1000.0);
+        }
+
+        void Miss() { misses++; }
+
+        RHI_CacheStats GetStats() const
+        {
+            RHI_CacheStats stats;
+            stats.hits          = hits;
+            stats.misses        = misses;
+            stats.time_saved_ms = time_saved_us / 1000.0;
+
+            return stats;
+        }
+    };
+
     static uint64_t rhi_hash_combine(uint64_t seed, uint64_t x)
     {
         // xxHash is probably the best hashing lib out there.
@@ -51,11 +51,13 @@ namespace Spartan
         static std::unordered_map<uint64_t, RHI_DescriptorSet>& GetDescriptorSets();
         static void* GetDescriptorSet(const RHI_Device_Resource resource_type);
         static void* GetDescriptorSetLayout(const RHI_Device_Resource resource_type);
-        static void UpdateBindlessResources(const std::array<std::shared_ptr<RHI_Sampler>, static_cast<uint32_t>(Renderer_Sampler::Max)>* samplers, std::array<RHI_Texture*, rhi_max_array_size>* textures);
+        static void UpdateBindlessResources(const std::array<std::shared_ptr<RHI_Sampler>, static_cast<uint32_t>(Renderer_Sampler::Max)>* samplers, std::array<RHI_Texture*, rhi_max_array_size>* textures, const uint32_t texture_start = 0, const uint32_t texture_count = rhi_max_array_size);
 
         // pipelines
         static void GetOrCreatePipeline(RHI_PipelineState& pso, RHI_Pipeline*& pipeline, RHI_DescriptorSetLayout*& descriptor_set_layout);
         static uint32_t GetPipelineCount();
+        static void PipelineCacheSetLightTextures(const std::vector<std::array<RHI_Texture*, 2>>& textures); // the depth and color shadow maps of each light
+        static void PipelineCacheCancelPrewarm(); // blocks until pipelines that are being created in the background are done
 
         // deletion queue
         static void DeletionQueueAdd(const RHI_Resource_Type resource_type, void* resource);
@@ -270,43 +270,45 @@ Warning Options:
 
     class DirecXShaderCompiler
     {
-    public:
-        static IDxcResult* Compile(const std::string& source, std::vector<std::string>& arguments)
+        // released when the thread that created them exits
+        struct Instances
         {
-            // initialize (only happens once)
-            static IDxcUtils* m_utils        = nullptr;
-            static IDxcCompiler3* m_compiler = nullptr;
-            if (!m_compiler)
-            {
-                DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&m_compiler));
-                DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&m_utils));
+            IDxcUtils* utils        = nullptr;
+            IDxcCompiler3* compiler = nullptr;
 
-                // Try to get the version information
-                IDxcVersionInfo* version_info = nullptr;
-                HRESULT hr = m_compiler->QueryInterface(&version_info);
-                if (SUCCEEDED(hr) && version_info)
+            ~Instances()
+            {
+                if (compiler)
                 {
-                    UINT32 major, minor;
-                    version_info->GetVersion(&major, &minor);
-
-                    // format the version string
-                    std::ostringstream stream;
-                    stream << major << "." << minor;
-
-                    Settings::RegisterThirdPartyLib("DirectXShaderCompiler", stream.str(), "https://github.com/microsoft/DirectXShaderCompiler");
-                    version_info->Release();
+                    compiler->Release();
                 }
-                else
+
+                if (utils)
                 {
-                    SP_LOG_ERROR("Failed to get library version");
+                    utils->Release();
                 }
             }
+        };
+
+    public:
+        static IDxcResult* Compile(const std::string& source, std::vector<std::string>& arguments)
+        {
+            Initialize();
+
+            // compiler instances aren't meant to be shared by threads which compile at the same time, so every thread gets its own
+            // they are created once per thread and reused, the number of threads that compile shaders is bounded (see RHI_Shader)
+            static thread_local Instances instances;
+            if (!instances.compiler)
+            {
+                DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&instances.compiler));
+                DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&instances.utils));
+            }
 
             // Get shader source
             DxcBuffer dxc_buffer = {};
             IDxcBlobEncoding* blob_encoding = nullptr;
             {
-                if (FAILED(m_utils->CreateBlobFromPinned(source.c_str(), static_cast<uint32_t>(source.size()), CP_UTF8, &blob_encoding)))
+                if (FAILED(instances.utils->CreateBlobFromPinned(source.c_str(), static_cast<uint32_t>(source.size()), CP_UTF8, &blob_encoding)))
                 {
                     SP_LOG_ERROR("Failed to load shader source.");
                     return nullptr;
@@ -335,7 +337,7 @@ Warning Options:
 
             // Compile
             IDxcResult* dxc_result = nullptr;
-            m_compiler->Compile
+            instances.compiler->Compile
             (
                 &dxc_buffer,                                     // Source text to compile
                 arguments_lpcwstr.data(),                        // Array of pointers to arguments
@@ -359,10 +361,67 @@ Warning Options:
             // Ideally you just use ComPtr, but that's Windows specific.
             // Let it be for now.
             // blob_encoding;
-            // m_utils
-            // m_compiler
 
             return dxc_result;
         }
+
+        // "major.minor.commit_count", part of the key of anything derived from compiled shaders
+        static const std::string& GetVersion()
+        {
+            Initialize();
+            return m_version;
+        }
+
+    private:
+        // only happens once, compilation can start from multiple threads at the same time
+        static void Initialize()
+        {
+            static std::once_flag initialized;
+            std::call_once(initialized, []()
+            {
+                IDxcCompiler3* compiler = nullptr;
+                DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&compiler));
+
+                // Try to get the version information
+                IDxcVersionInfo* version_info = nullptr;
+                HRESULT hr = compiler->QueryInterface(&version_info);
+                if (SUCCEEDED(hr) && version_info)
+                {
+                    UINT32 major, minor;
+                    version_info->GetVersion(&major, &minor);
+
+                    // format the version string
+                    std::ostringstream stream;
+                    stream << major << "." << minor;
+
+                    Settings::RegisterThirdPartyLib("DirectXShaderCompiler", stream.str(), "https://github.com/microsoft/DirectXShaderCompiler");
+                    version_info->Release();
+
+                    // the commit count tells apart builds which share a version
+                    IDxcVersionInfo2* version_info_2 = nullptr;
+                    if (SUCCEEDED(compiler->QueryInterface(&version_info_2)) && version_info_2)
+                    {
+                        UINT32 commit_count = 0;
+                        char* commit_hash   = nullptr;
+                        if (SUCCEEDED(version_info_2->GetCommitInfo(&commit_count, &commit_hash)))
+                        {
+                            stream << "." << commit_count;
+                            CoTaskMemFree(commit_hash);
+                        }
+                        version_info_2->Release();
+                    }
+
+                    m_version = stream.str();
+                }
+                else
+                {
+                    SP_LOG_ERROR("Failed to get library version");
+                }
+
+                compiler->Release();
+            });
+        }
+
+        static inline std::string m_version = "unknown";
     };
 }
@@ -21,10 +21,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ===============
+//= INCLUDES ===================
 #include "../Math/Vector2.h"
+#include "../Core/FrameAllocator.h"
 #include "RHI_Definitions.h"
-//==========================
+//===============================
 
 namespace Spartan
 {
@@ -82,7 +83,7 @@ namespace Spartan
             RHI_CommandList* cmd_list,
             const float resolution_scale,
             Cb_Frame* cb_frame,
-            std::vector<std::shared_ptr<Entity>>& entities,
+            frame_vector<std::shared_ptr<Entity>>& entities,
             int64_t index_start,
             int64_t index_end,
             RHI_Texture* tex_debug
@@ -400,6 +400,7 @@ namespace Spartan
             static VkInstance instance;
             static VkDevice device;
             static VkPhysicalDevice device_physical;
+            static VkPipelineCache pipeline_cache;
         #endif
 
         // api agnostic
@@ -165,6 +165,7 @@ namespace Spartan
     {
         clear_color.fill(rhi_color_load);
         render_target_color_textures.fill(nullptr);
+        shaders.fill(nullptr);
     }
 
     RHI_PipelineState::~RHI_PipelineState()
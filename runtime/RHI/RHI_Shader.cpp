@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "RHI_Shader.h"
 #include "RHI_InputLayout.h"
 #include "../Core/ThreadPool.h"
+#include "../IO/FileStream.h"
 //=============================
 
 //= NAMESPACES =====
@@ -32,6 +33,349 @@ using namespace std;
 
 namespace Spartan
 {
+    namespace shader_cache
+    {
+        // compiled shaders and their reflected descriptors, named after a hash of everything that went into the compilation
+        const uint32_t magic   = 0x48534353; // "SCSH"
+        const uint32_t version = 1;
+
+        RHI_CacheCounters counters;
+
+        // checks the length prefix of the next array against what's left of the file, before anything is allocated for it
+        bool next_length_fits(FileStream& file, const uint64_t file_size, const uint64_t element_size)
+        {
+            const uint64_t position = file.GetPosition();
+            const uint64_t length   = file.ReadAs<uint32_t>();
+            if (!file.IsGood()) // checked before seeking back, which clears the state
+                return false;
+
+            file.Seek(position);
+
+            return position + sizeof(uint32_t) + length * element_size <= file_size;
+        }
+
+        enum class read_result
+        {
+            success,
+            mismatch, // not a cache file, or an older version
+            corrupted
+        };
+
+        read_result read(const string& file_path, double* compile_ms, vector<uint32_t>* binary, vector<RHI_Descriptor>* descriptors)
+        {
+            error_code error;
+            const uint64_t file_size = filesystem::file_size(file_path, error);
+            if (error)
+                return read_result::mismatch;
+
+            FileStream file(file_path, FileStream_Read | FileStream_Mapped);
+            if (!file.IsOpen())
+                return read_result::mismatch;
+
+            if (file.ReadAs<uint32_t>() != magic || file.ReadAs<uint32_t>() != version)
+                return read_result::mismatch;
+
+            *compile_ms = file.ReadAs<double>();
+            if (!next_length_fits(file, file_size, sizeof(uint32_t)))
+                return read_result::corrupted;
+
+            file.Read(binary);
+            if (binary->empty())
+                return read_result::corrupted;
+
+            // a descriptor is at least an empty name, six integers and a bool
+            const uint64_t descriptor_size_min = sizeof(uint32_t) * 7 + sizeof(bool);
+            if (!next_length_fits(file, file_size, descriptor_size_min))
+                return read_result::corrupted;
+
+            descriptors->resize(file.ReadAs<uint32_t>());
+            for (RHI_Descriptor& descriptor : *descriptors)
+            {
+                if (!next_length_fits(file, file_size, sizeof(char)))
+                    return read_result::corrupted;
+
+                descriptor.name         = file.ReadAs<string>();
+                descriptor.type         = static_cast<RHI_Descriptor_Type>(file.ReadAs<uint32_t>());
+                descriptor.layout       = static_cast<RHI_Image_Layout>(file.ReadAs<uint32_t>());
+                descriptor.slot         = file.ReadAs<uint32_t>();
+                descriptor.stage        = file.ReadAs<uint32_t>();
+                descriptor.struct_size  = file.ReadAs<uint32_t>();
+                descriptor.as_array     = file.ReadAs<bool>();
+                descriptor.array_length = file.ReadAs<uint32_t>();
+            }
+
+            return file.IsGood() ? read_result::success : read_result::corrupted;
+        }
+
+    }
+
+    namespace include_cache
+    {
+        // every file that shaders include is read and split into text and include directives once, and then
+        // shared by all shaders, permutations and threads, until the file changes on the drive
+        struct Segment
+        {
+            string_view text;    // lines without include directives, new line characters included
+            string include_path; // or an include directive
+        };
+
+        struct File
+        {
+            string source;
+            vector<Segment> segments;
+            filesystem::file_time_type write_time;
+            uintmax_t size = 0;
+        };
+
+        mutex mutex_files;
+        unordered_map<string, shared_ptr<const File>> files;
+
+        // which shaders include which files (the main file included), so that a change recompiles only those
+        mutex mutex_dependents;
+        unordered_map<string, unordered_set<RHI_Shader*>> dependents;
+
+        shared_ptr<File> parse(const string& file_path)
+        {
+            static const string include_directive_prefix = "#include \"";
+
+            shared_ptr<File> file = make_shared<File>();
+            {
+                ifstream in(file_path);
+                stringstream buffer;
+                buffer << in.rdbuf();
+                file->source = buffer.str();
+            }
+
+            // getline() semantics, every line ends up terminated by a new line character
+            if (!file->source.empty() && file->source.back() != '\n')
+            {
+                file->source += '\n';
+            }
+
+            const string_view source = file->source;
+            size_t text_start        = 0;
+            size_t line_start        = 0;
+            while (line_start < source.size())
+            {
+                const size_t line_end = source.find('\n', line_start) + 1;
+                const string_view line = source.substr(line_start, line_end - line_start);
+
+                const size_t prefix = line.find(include_directive_prefix);
+                if (prefix != string_view::npos)
+                {
+                    if (line_start != text_start)
+                    {
+                        file->segments.push_back({ source.substr(text_start, line_start - text_start), "" });
+                    }
+
+                    const size_t name_start = prefix + include_directive_prefix.size();
+                    const size_t name_end   = line.find('"', name_start);
+                    const string_view name  = line.substr(name_start, name_end == string_view::npos ? string_view::npos : name_end - name_start);
+                    file->segments.push_back({ string_view(), FileSystem::GetDirectoryFromFilePath(file_path) + string(name) });
+
+                    text_start = line_end;
+                }
+
+                line_start = line_end;
+            }
+
+            if (text_start != source.size())
+            {
+                file->segments.push_back({ source.substr(text_start), "" });
+            }
+
+            return file;
+        }
+
+        shared_ptr<const File> get(const string& file_path)
+        {
+            error_code error;
+            const filesystem::file_time_type write_time = filesystem::last_write_time(file_path, error);
+            const uintmax_t size                        = error ? 0 : filesystem::file_size(file_path, error);
+
+            {
+                lock_guard<mutex> lock(mutex_files);
+                auto it = files.find(file_path);
+                if (!error && it != files.end() && it->second->write_time == write_time && it->second->size == size)
+                    return it->second;
+            }
+
+            // parse outside of the lock, two threads parsing the same file at once is harmless
+            shared_ptr<File> file = parse(file_path);
+            if (error)
+                return file;
+
+            file->write_time = write_time;
+            file->size       = size;
+
+            lock_guard<mutex> lock(mutex_files);
+            files[file_path] = file;
+
+            return file;
+        }
+
+        void set_dependencies(RHI_Shader* shader, const vector<string>& file_paths_old, const vector<string>& file_paths_new)
+        {
+            lock_guard<mutex> lock(mutex_dependents);
+
+            for (const string& file_path : file_paths_old)
+            {
+                auto it = dependents.find(file_path);
+                if (it != dependents.end())
+                {
+                    it->second.erase(shader);
+                }
+            }
+
+            for (const string& file_path : file_paths_new)
+            {
+                dependents[file_path].insert(shader);
+            }
+        }
+    }
+
+    namespace compilation
+    {
+        // async compilations have a queue of their own, ordered by priority and then by submission, and only some of
+        // them run at once, so that the thread pool keeps threads for everything else that is loading at the same time
+        struct Request
+        {
+            RHI_ShaderCompilationPriority priority = RHI_ShaderCompilationPriority::Normal;
+            uint64_t sequence                      = 0;
+            function<void()> compile;
+
+            // the heap keeps the greatest on top, which is the most important and oldest request
+            bool operator<(const Request& other) const
+            {
+                if (priority != other.priority)
+                    return priority > other.priority;
+
+                return sequence > other.sequence;
+            }
+        };
+
+        struct Record
+        {
+            string name;
+            double duration_ms = 0.0;
+        };
+
+        mutex mutex_queue;
+        vector<Request> queue;
+        uint64_t sequence = 0;
+        uint32_t running  = 0;
+
+        // report, a summary and the slowest shaders, the rest are only counted
+        const uint32_t report_slowest_count = 10;
+        uint32_t report_depth               = 0;
+        string report_title;
+        vector<Record> records;
+        chrono::steady_clock::time_point report_start;
+
+        uint32_t get_max_concurrency()
+        {
+            return max(1u, ThreadPool::GetThreadCount() / 2);
+        }
+
+        // with the queue lock held, empty if there is nothing to report yet
+        vector<Record> take_report(double* wall_ms, string* title)
+        {
+            if (report_depth != 0 || running != 0 || !queue.empty() || report_title.empty())
+                return {};
+
+            *wall_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - report_start).count();
+            *title   = move(report_title);
+            report_title.clear();
+
+            return move(records);
+        }
+
+        void log_report(vector<Record>& report, const double wall_ms, const string& title)
+        {
+            if (report.empty())
+                return;
+
+            double total_ms = 0.0;
+            for (const Record& record : report)
+            {
+                total_ms += record.duration_ms;
+            }
+
+            const size_t slowest_count = min(report.size(), static_cast<size_t>(report_slowest_count));
+            partial_sort(report.begin(), report.begin() + slowest_count, report.end(), [](const Record& a, const Record& b) { return a.duration_ms > b.duration_ms; });
+
+            SP_LOG_INFO("%s: %zu shaders in %.1f ms (%.1f ms of compilation across threads), the %zu slowest:", title.c_str(), report.size(), wall_ms, total_ms, slowest_count);
+            for (size_t i = 0; i < slowest_count; i++)
+            {
+                SP_LOG_INFO("%8.1f ms %s", report[i].duration_ms, report[i].name.c_str());
+            }
+        }
+
+        void add_record(string&& name, const double duration_ms)
+        {
+            lock_guard<mutex> lock(mutex_queue);
+            if (report_depth != 0 || !report_title.empty())
+            {
+                records.push_back({ move(name), duration_ms });
+            }
+        }
+
+        void work()
+        {
+            while (true)
+            {
+                Request request;
+                double wall_ms = 0.0;
+                string title;
+                vector<Record> report;
+                {
+                    lock_guard<mutex> lock(mutex_queue);
+                    if (queue.empty())
+                    {
+                        running--;
+                        report = take_report(&wall_ms, &title);
+                    }
+                    else
+                    {
+                        pop_heap(queue.begin(), queue.end());
+                        request = move(queue.back());
+                        queue.pop_back();
+                    }
+                }
+
+                if (!request.compile)
+                {
+                    log_report(report, wall_ms, title);
+                    return;
+                }
+
+                request.compile();
+            }
+        }
+
+        void submit(const RHI_ShaderCompilationPriority priority, function<void()> compile)
+        {
+            bool start_worker = false;
+            {
+                lock_guard<mutex> lock(mutex_queue);
+
+                queue.push_back({ priority, sequence++, move(compile) });
+                push_heap(queue.begin(), queue.end());
+
+                if (running < get_max_concurrency())
+                {
+                    running++;
+                    start_worker = true;
+                }
+            }
+
+            if (start_worker)
+            {
+                ThreadPool::AddTask(work);
+            }
+        }
+    }
+
     RHI_Shader::RHI_Shader() : SpartanObject()
     {
 
@@ -73,6 +417,18 @@ namespace Spartan
                 m_rhi_resource      = RHI_Compile();
                 m_compilation_state = m_rhi_resource ? RHI_ShaderCompilationState::Succeeded : RHI_ShaderCompilationState::Failed;
 
+                // time it, for the compilation report
+                {
+                    string name = m_object_name + " (" + GetEntryPoint();
+                    for (const auto& define : m_defines)
+                    {
+                        name += ", " + define.first;
+                    }
+                    name += ")";
+
+                    compilation::add_record(move(name), timer.GetElapsedTimeMs());
+                }
+
                 // log failure
                 if (m_compilation_state != RHI_ShaderCompilationState::Succeeded)
                 {
@@ -98,7 +454,7 @@ namespace Spartan
 
             if (async)
             {
-                ThreadPool::AddTask(compile);
+                compilation::submit(m_compilation_priority, compile);
             }
             else
             {
@@ -109,8 +465,6 @@ namespace Spartan
 
     void RHI_Shader::PreprocessIncludeDirectives(const string& file_path)
     {
-        static string include_directive_prefix = "#include \"";
-
         // Skip already parsed include directives (avoid recursive include directives)
         if (find(m_file_paths_multiple.begin(), m_file_paths_multiple.end(), file_path) == m_file_paths_multiple.end())
         {
@@ -121,32 +475,19 @@ namespace Spartan
             return;
         }
 
-        // load source
-        ifstream in(file_path);
-        stringstream buffer;
-        buffer << in.rdbuf();
-        string source = buffer.str();
-        
-        // go through every line
-        istringstream stream(source);
-        string source_line;
-        while (getline(stream, source_line))
+        // load source (split into text and include directives, once per process)
+        shared_ptr<const include_cache::File> file = include_cache::get(file_path);
+
+        // add the text to the preprocessed source and process include directives recursively
+        for (const include_cache::Segment& segment : file->segments)
         {
-            // add the line to the preprocessed source
-            bool is_include_directive = source_line.find(include_directive_prefix) != string::npos;
-            if (!is_include_directive)
+            if (segment.include_path.empty())
             {
-                m_preprocessed_source += source_line + "\n";
+                m_preprocessed_source.append(segment.text);
             }
-            // if the line is an include directive, process it recursively
             else
             {
-                // construct include file
-                string file_name         = FileSystem::GetStringBetweenExpressions(source_line, include_directive_prefix, "\"");
-                string include_file_path = FileSystem::GetDirectoryFromFilePath(file_path) + file_name;
-
-                // process
-                PreprocessIncludeDirectives(include_file_path);
+                PreprocessIncludeDirectives(segment.include_path);
             }
         }
 
@@ -157,7 +498,7 @@ namespace Spartan
         m_file_paths.emplace_back(file_path);
 
         // save source
-        m_sources.emplace_back(source);
+        m_sources.emplace_back(file->source);
     }
 
     void RHI_Shader::LoadFromDrive(const string& file_path)
@@ -167,6 +508,7 @@ namespace Spartan
         m_file_path   = file_path;
         m_preprocessed_source.clear();
         m_names.clear();
+        vector<string> file_paths_previous = move(m_file_paths);
         m_file_paths.clear();
         m_sources.clear();
         m_file_paths_multiple.clear();
@@ -191,6 +533,8 @@ namespace Spartan
         reverse(m_names.begin(), m_names.end());
         reverse(m_file_paths.begin(), m_file_paths.end());
         reverse(m_sources.begin(), m_sources.end());
+
+        include_cache::set_dependencies(this, file_paths_previous, m_file_paths);
     }
 
     void RHI_Shader::SetSource(const uint32_t index, const string& source)
@@ -204,6 +548,54 @@ namespace Spartan
         m_sources[index] = source;
     }
 
+    void RHI_Shader::CompilationReportBegin()
+    {
+        lock_guard<mutex> lock(compilation::mutex_queue);
+
+        if (compilation::report_depth == 0 && compilation::report_title.empty())
+        {
+            compilation::records.clear();
+            compilation::report_start = chrono::steady_clock::now();
+        }
+
+        compilation::report_depth++;
+    }
+
+    void RHI_Shader::CompilationReportEnd(const string& title)
+    {
+        double wall_ms = 0.0;
+        string report_title;
+        vector<compilation::Record> report;
+        {
+            lock_guard<mutex> lock(compilation::mutex_queue);
+            SP_ASSERT(compilation::report_depth != 0);
+
+            compilation::report_depth--;
+            compilation::report_title = title;
+
+            // if everything was compiled synchronously or has already finished, report now, otherwise the last worker does
+            report = compilation::take_report(&wall_ms, &report_title);
+        }
+
+        compilation::log_report(report, wall_ms, report_title);
+    }
+
+    void RHI_Shader::ClearDependencies()
+    {
+        include_cache::set_dependencies(this, m_file_paths, {});
+    }
+
+    vector<RHI_Shader*> RHI_Shader::GetDependents(const string& file_path)
+    {
+        lock_guard<mutex> lock(include_cache::mutex_dependents);
+
+        auto it = include_cache::dependents.find(file_path);
+        if (it == include_cache::dependents.end())
+            return {};
+
+        return vector<RHI_Shader*>(it->second.begin(), it->second.end());
+    }
+
     uint32_t RHI_Shader::GetVertexSize() const
     {
         return m_input_layout->GetVertexSize();
@@ -235,4 +627,63 @@ namespace Spartan
         }
     }
 
+    bool RHI_Shader::LoadFromCache(const string& file_path, vector<uint32_t>* binary)
+    {
+        if (!FileSystem::Exists(file_path))
+            return false;
+
+        const Stopwatch timer;
+
+        double compile_ms = 0.0;
+        vector<RHI_Descriptor> descriptors;
+        const shader_cache::read_result result = shader_cache::read(file_path, &compile_ms, binary, &descriptors);
+        if (result != shader_cache::read_result::success)
+        {
+            // a truncated or corrupted file is compiled again, and overwritten once it has been
+            if (result == shader_cache::read_result::corrupted)
+            {
+                SP_LOG_WARNING("\"%s\" is corrupted, compiling instead", file_path.c_str());
+            }
+
+            binary->clear();
+            return false;
+        }
+
+        m_descriptors = move(descriptors);
+
+        shader_cache::counters.Hit(compile_ms, timer.GetElapsedTimeMs());
+
+        return true;
+    }
+
+    void RHI_Shader::SaveToCache(const string& file_path, const uint32_t* binary, const uint32_t word_count, const double compile_ms)
+    {
+        shader_cache::counters.Miss();
+
+        // another thread can be compiling the same shader, the next load never sees a half written file
+        FileStream::WriteAtomic(file_path, 0, [this, binary, word_count, compile_ms](FileStream& file)
+        {
+            file.Write(shader_cache::magic);
+            file.Write(shader_cache::version);
+            file.Write(compile_ms);
+            file.Write(vector<uint32_t>(binary, binary + word_count));
+            file.Write(static_cast<uint32_t>(m_descriptors.size()));
+            for (const RHI_Descriptor& descriptor : m_descriptors)
+            {
+                file.Write(descriptor.name);
+                file.Write(static_cast<uint32_t>(descriptor.type));
+                file.Write(static_cast<uint32_t>(descriptor.layout));
+                file.Write(descriptor.slot);
+                file.Write(descriptor.stage);
+                file.Write(descriptor.struct_size);
+                file.Write(descriptor.as_array);
+                file.Write(descriptor.array_length);
+            }
+        });
+    }
+
+    RHI_CacheStats RHI_Shader::GetCacheStats()
+    {
+        return shader_cache::counters.GetStats();
+    }
 }
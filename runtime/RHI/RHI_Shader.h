@@ -41,6 +41,13 @@ namespace Spartan
         Failed
     };
 
+    enum class RHI_ShaderCompilationPriority
+    {
+        Critical, // needed to produce the first frames
+        Normal,
+        Low       // debugging and editor visualizations
+    };
+
     class RHI_Shader : public SpartanObject
     {
     public:
@@ -51,6 +58,11 @@ namespace Spartan
         void Compile(const RHI_Shader_Type type, const std::string& file_path, bool async, const RHI_Vertex_Type vertex_type = RHI_Vertex_Type::Max);
         RHI_ShaderCompilationState GetCompilationState() const { return m_compilation_state; }
         bool IsCompiled() const                                { return m_compilation_state == RHI_ShaderCompilationState::Succeeded; }
+        void SetCompilationPriority(const RHI_ShaderCompilationPriority priority) { m_compilation_priority = priority; } // async only, set before compiling
+
+        // compilations which start between these two calls are timed and logged together once they have all finished
+        static void CompilationReportBegin();
+        static void CompilationReportEnd(const std::string& title);
 
         // source
         void LoadFromDrive(const std::string& file_path);
@@ -63,21 +75,29 @@ namespace Spartan
         void AddDefine(const std::string& define, const std::string& value = "1") { m_defines[define] = value; }
         auto& GetDefines() const                                                  { return m_defines; }
 
+        // include dependencies
+        static std::vector<RHI_Shader*> GetDependents(const std::string& file_path); // shaders which include the file, or are the file
+
         // misc
         uint32_t GetVertexSize() const;
         const std::vector<RHI_Descriptor>& GetDescriptors()      const { return m_descriptors; }
         const std::shared_ptr<RHI_InputLayout>& GetInputLayout() const { return m_input_layout; } // only valid for a vertex shader
         const auto& GetFilePath()                                const { return m_file_path; }
         RHI_Shader_Type GetShaderStage()                         const { return m_shader_type; }
+        RHI_Vertex_Type GetVertexType()                          const { return m_vertex_type; }
         uint64_t GetHash()                                       const { return m_hash; }
         const char* GetEntryPoint()                              const;
         const char* GetTargetProfile()                           const;
         void* GetRhiResource()                                   const { return m_rhi_resource; }
+        static RHI_CacheStats GetCacheStats();
 
     private:
         void PreprocessIncludeDirectives(const std::string& file_path);
+        void ClearDependencies();
         void* RHI_Compile();
         void Reflect(const RHI_Shader_Type shader_type, const uint32_t* ptr, uint32_t size);
+        bool LoadFromCache(const std::string& file_path, std::vector<uint32_t>* binary);
+        void SaveToCache(const std::string& file_path, const uint32_t* binary, const uint32_t word_count, const double compile_ms);
 
         std::string m_file_path;
         std::string m_preprocessed_source;
@@ -89,6 +109,7 @@ namespace Spartan
         std::vector<RHI_Descriptor> m_descriptors;
         std::shared_ptr<RHI_InputLayout> m_input_layout;
         std::atomic<RHI_ShaderCompilationState> m_compilation_state = RHI_ShaderCompilationState::Idle;
+        RHI_ShaderCompilationPriority m_compilation_priority       = RHI_ShaderCompilationPriority::Normal;
         RHI_Shader_Type m_shader_type                              = RHI_Shader_Type::Max;
         RHI_Vertex_Type m_vertex_type                               = RHI_Vertex_Type::Max;
         uint64_t m_hash                                             = 0;
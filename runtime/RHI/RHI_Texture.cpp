@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "RHI_CommandList.h"
 #include "../IO/FileStream.h"
 #include "../Resource/Import/ImageImporter.h"
+#include "../Resource/ResourceCache.h"
 #include "../Core/ProgressTracker.h"
 SP_WARNINGS_OFF
 #include "compressonator.h"
@@ -85,15 +86,47 @@ namespace Spartan
             vector<byte> destination_data(destination_texture.dwDataSize);
             destination_texture.pData       = reinterpret_cast<uint8_t*>(destination_data.data());
 
+            // block compressed formats encode 4x4 blocks, so bands of 4 rows map to contiguous ranges of the destination
+            uint32_t block_row_size = 0;
+            {
+                CMP_Texture block_row = destination_texture;
+                block_row.dwHeight    = 4;
+                block_row_size        = CMP_CalculateBufferSize(&block_row);
+            }
+
             // compress texture
+            auto compress_rows = [&source_texture, &destination_texture, block_row_size](const uint32_t row_start, const uint32_t row_end)
             {
                 CMP_CompressOptions options = {};
                 options.dwSize              = sizeof(CMP_CompressOptions);
-                options.fquality            = 0.05f;                            // set for lower quality, faster compression
-                options.dwnumThreads        = ThreadPool::GetIdleThreadCount(); // use all free threads
-                options.nEncodeWith         = CMP_HPC;                          // set encoder
+                options.fquality            = 0.05f;   // set for lower quality, faster compression
+                options.dwnumThreads        = 1;       // the thread pool does the threading
+                options.nEncodeWith         = CMP_HPC; // set encoder
+
+                CMP_Texture source      = source_texture;
+                source.dwHeight         = row_end - row_start;
+                source.dwDataSize       = source.dwPitch * source.dwHeight;
+                source.pData           += row_start * source.dwPitch;
+
+                CMP_Texture destination = destination_texture;
+                destination.dwHeight    = source.dwHeight;
+                destination.dwDataSize  = CMP_CalculateBufferSize(&destination);
+                destination.pData      += (row_start / 4) * block_row_size;
 
-                SP_ASSERT(CMP_ConvertTexture(&source_texture, &destination_texture, &options, nullptr) == CMP_OK);
+                SP_ASSERT(CMP_ConvertTexture(&source, &destination, &options, nullptr) == CMP_OK);
+            };
+
+            if (destination_format != RHI_Format::ASTC)
+            {
+                uint32_t block_row_count = (source_texture.dwHeight + 3) / 4;
+                ThreadPool::ParallelLoop([&compress_rows, &source_texture](uint32_t block_row_start, uint32_t block_row_end)
+                {
+                    compress_rows(block_row_start * 4, min(block_row_end * 4, source_texture.dwHeight));
+                }, block_row_count, 16);
+            }
+            else
+            {
+                compress_rows(0, source_texture.dwHeight);
             }
 
             // update texture with compressed data
@@ -189,6 +222,193 @@ namespace Spartan
         }
     }
 
+    namespace texture_cache
+    {
+        // mip chains that were generated (and compressed) before are stored in the cache directory in the .texture format,
+        // named after a hash of the pixels they were generated from and of everything else that affects the result
+        const uint32_t version  = 1;
+        const size_t chunk_size = 1024 * 1024; // hashing granularity
+
+        RHI_CacheCounters counters;
+
+        // the directory is kept under a size limit, the least recently used files are deleted first,
+        // a file's write time is when it was last used, loading from it refreshes it
+        const uint64_t size_max    = 4ull * 1024 * 1024 * 1024;
+        const uint64_t size_target = size_max / 4 * 3; // trimming goes below the limit, so it doesn't run on every save
+        mutex mutex_size;
+        uint64_t size              = 0;
+        bool size_known            = false;
+
+        string get_directory()
+        {
+            return ResourceCache::GetResourceDirectory(ResourceDirectory::Cache) + "\\textures\\";
+        }
+
+        void touch(const string& file_path)
+        {
+            error_code error;
+            filesystem::last_write_time(file_path, filesystem::file_time_type::clock::now(), error);
+        }
+
+        void trim()
+        {
+            struct cached_file
+            {
+                string path;
+                uint64_t size = 0;
+                filesystem::file_time_type time;
+            };
+
+            // the running size can drift (e.g. a file that was written twice), so it's measured again
+            vector<cached_file> files;
+            size = 0;
+            for (const string& file_path : FileSystem::GetFilesInDirectory(get_directory()))
+            {
+                error_code error;
+                cached_file file;
+                file.path = file_path;
+                file.size = filesystem::file_size(file_path, error);
+                file.time = filesystem::last_write_time(file_path, error);
+                if (!error)
+                {
+                    size += file.size;
+                    files.emplace_back(move(file));
+                }
+            }
+
+            sort(files.begin(), files.end(), [](const cached_file& a, const cached_file& b) { return a.time < b.time; });
+
+            uint32_t deleted_count = 0;
+            for (const cached_file& file : files)
+            {
+                if (size <= size_target)
+                    break;
+
+                error_code error;
+                if (filesystem::remove(file.path, error))
+                {
+                    size -= min(size, file.size);
+                    deleted_count++;
+                }
+            }
+
+            SP_LOG_INFO("Texture cache exceeded %llu MB, deleted the %u least recently used files", static_cast<unsigned long long>(size_max / (1024 * 1024)), deleted_count);
+        }
+
+        // called once a file has been written to the cache
+        void on_added(const string& file_path)
+        {
+            lock_guard<mutex> lock(mutex_size);
+
+            // the directory is measured once per run, the file that was just written included
+            if (!size_known)
+            {
+                size_known = true;
+                for (const string& path : FileSystem::GetFilesInDirectory(get_directory()))
+                {
+                    error_code error;
+                    const uint64_t file_size = filesystem::file_size(path, error);
+                    size += error ? 0 : file_size;
+                }
+            }
+            else
+            {
+                error_code error;
+                const uint64_t file_size = filesystem::file_size(file_path, error);
+                size += error ? 0 : file_size;
+            }
+
+            if (size > size_max)
+            {
+                trim();
+            }
+        }
+
+        uint64_t mix(uint64_t x)
+        {
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdull;
+            x ^= x >> 33;
+            x *= 0xc4ceb9fe1a85ec53ull;
+            x ^= x >> 33;
+
+            return x;
+        }
+
+        // four independent lanes over 8 byte words, so that hashing keeps up with memory bandwidth
+        uint64_t hash_chunk(const byte* data, const size_t size)
+        {
+            uint64_t lanes[4] = { 0x243f6a8885a308d3ull, 0x13198a2e03707344ull, 0xa4093822299f31d0ull, 0x082efa98ec4e6c89ull };
+
+            size_t i = 0;
+            for (; i + 32 <= size; i += 32)
+            {
+                for (uint32_t lane = 0; lane < 4; lane++)
+                {
+                    uint64_t word;
+                    memcpy(&word, data + i + lane * 8, sizeof(word));
+                    lanes[lane] = (lanes[lane] ^ word) * 0x9e3779b97f4a7c15ull;
+                    lanes[lane] = (lanes[lane] << 31) | (lanes[lane] >> 33);
+                }
+            }
+
+            uint64_t hash = size;
+            for (const uint64_t lane : lanes)
+            {
+                hash = mix(hash ^ lane);
+            }
+
+            for (; i < size; i++)
+            {
+                hash = (hash ^ to_integer<uint64_t>(data[i])) * 1099511628211ull;
+            }
+
+            return mix(hash);
+        }
+
+        // empty if the texture can't be cached
+        string get_path(RHI_Texture* texture)
+        {
+            if (texture->GetDepth() != 1 || !texture->HasData())
+                return "";
+
+            // large textures are hashed in parallel, a chunk at a time
+            const vector<byte>& bytes  = texture->GetMip(0, 0).bytes;
+            const uint32_t chunk_count = static_cast<uint32_t>((bytes.size() + chunk_size - 1) / chunk_size);
+            vector<uint64_t> chunk_hashes(chunk_count);
+            ThreadPool::ParallelLoop([&bytes, &chunk_hashes](uint32_t chunk_start, uint32_t chunk_end)
+            {
+                for (uint32_t i = chunk_start; i < chunk_end; i++)
+                {
+                    const size_t offset = i * chunk_size;
+                    chunk_hashes[i]     = hash_chunk(bytes.data() + offset, min(chunk_size, bytes.size() - offset));
+                }
+            }, chunk_count);
+
+            const uint64_t properties[] =
+            {
+                version,
+                texture->GetWidth(),
+                texture->GetHeight(),
+                static_cast<uint64_t>(texture->GetFormat()),
+                static_cast<uint64_t>(compressonator::destination_format),
+                texture->GetFlags() & (RHI_Texture_Compress | RHI_Texture_Thumbnail)
+            };
+
+            uint64_t hash = 0;
+            for (const uint64_t value : chunk_hashes)
+            {
+                hash = mix(hash ^ value);
+            }
+            for (const uint64_t value : properties)
+            {
+                hash = mix(hash ^ value);
+            }
+
+            return get_directory() + FileSystem::HashToHex(hash) + EXTENSION_TEXTURE;
+        }
+    }
+
     RHI_Texture::RHI_Texture() : IResource(ResourceType::Texture)
     {
 
@@ -243,6 +463,10 @@ namespace Spartan
     {
         // if a file already exists, get the byte count
         m_object_size = 0;
+        bool is_compressed = false;
+        uint32_t depth_on_disk     = 0;
+        uint32_t mip_count_on_disk = 0;
+        vector<RHI_Texture_Slice> slices_on_disk;
         {
             if (FileSystem::Exists(file_path))
             {
@@ -250,18 +474,60 @@ namespace Spartan
                 if (file->IsOpen())
                 {
                     file->Read(&m_object_size);
+                    is_compressed = file->IsCompressed();
+
+                    // a compressed file can't be appended to, so when there is no data to write, the data it
+                    // already has is read back and the whole file is rewritten with the current properties
+                    if (is_compressed && m_object_size != 0 && !HasData())
+                    {
+                        file->Read(&depth_on_disk);
+                        file->Read(&mip_count_on_disk);
+                        slices_on_disk.resize(depth_on_disk);
+                        for (RHI_Texture_Slice& slice : slices_on_disk)
+                        {
+                            slice.mips.resize(mip_count_on_disk);
+                            for (RHI_Texture_Mip& mip : slice.mips)
+                            {
+                                file->Read(&mip.bytes);
+                            }
+                        }
+
+                        if (!file->IsGood())
+                        {
+                            SP_LOG_ERROR("Failed to read the existing data of \"%s\", the file was left as is", file_path.c_str());
+                            return;
+                        }
+                    }
                 }
             }
         }
 
-        bool append = true;
-        auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Append);
+        // if the existing file has texture data but we don't, don't overwrite them
+        bool dont_overwrite_data = m_object_size != 0 && !HasData();
+        bool rewrite_data        = dont_overwrite_data && is_compressed;
+        bool append              = dont_overwrite_data && !is_compressed;
+
+        auto file = make_unique<FileStream>(file_path, append ? (FileStream_Write | FileStream_Append) : (FileStream_Write | FileStream_Compressed));
         if (!file->IsOpen())
+        {
+            SP_LOG_ERROR("Failed to open \"%s\" for writing", file_path.c_str());
             return;
+        }
 
-        // if the existing file has texture data but we don't, don't overwrite them
-        bool dont_overwrite_data = m_object_size != 0 && !HasData();
-        if (dont_overwrite_data)
+        if (rewrite_data)
+        {
+            file->Write(m_object_size);
+            file->Write(depth_on_disk);
+            file->Write(mip_count_on_disk);
+            for (RHI_Texture_Slice& slice : slices_on_disk)
+            {
+                for (RHI_Texture_Mip& mip : slice.mips)
+                {
+                    file->Write(mip.bytes);
+                }
+            }
+        }
+        else if (append)
         {
             file->Skip
             (
@@ -325,7 +591,7 @@ namespace Spartan
         // load from drive
         if (FileSystem::IsEngineTextureFile(file_path))
         {
-            auto file = make_unique<FileStream>(file_path, FileStream_Read);
+            auto file = make_unique<FileStream>(file_path, FileStream_Read | FileStream_Mapped);
             if (file->IsOpen())
             {
                 // read mip info
@@ -529,59 +795,184 @@ namespace Spartan
                 SP_ASSERT(!m_slices.empty());
                 SP_ASSERT(!m_slices.front().mips.empty());
 
-                // generate mip chain
-                uint32_t mip_count = mips::compute_count(m_width, m_height);
-                for (uint32_t mip_index = 1; mip_index < mip_count; mip_index++)
+                // the mip chain (and its compression) may have been generated by a previous run
+                const string cache_path = texture_cache::get_path(this);
+                if (cache_path.empty() || !LoadFromCache(cache_path))
                 {
-                    AllocateMip();
-
-                    mips::downsample_bilinear(
-                        m_slices[0].mips[mip_index - 1].bytes, // larger
-                        m_slices[0].mips[mip_index].bytes,     // smaller
-                        max(1u, m_width  >> (mip_index - 1)),  // larger width
-                        max(1u, m_height >> (mip_index - 1))   // larger height
-                    );
-                }
+                    const Stopwatch timer;
 
-                // for thumbnails, find the appropriate mip level close to 128x128 and make it the only mip
-                if (m_flags & RHI_Texture_Thumbnail)
-                {
-                    uint32_t target_mip = 0;
-                    for (uint32_t i = 0; i < m_slices[0].mips.size(); i++)
+                    // generate mip chain
+                    uint32_t mip_count = mips::compute_count(m_width, m_height);
+                    for (uint32_t mip_index = 1; mip_index < mip_count; mip_index++)
                     {
-                        uint32_t mip_width  = max(1u, m_width >> i);
-                        uint32_t mip_height = max(1u, m_height >> i);
+                        AllocateMip();
+
+                        mips::downsample_bilinear(
+                            m_slices[0].mips[mip_index - 1].bytes, // larger
+                            m_slices[0].mips[mip_index].bytes,     // smaller
+                            max(1u, m_width  >> (mip_index - 1)),  // larger width
+                            max(1u, m_height >> (mip_index - 1))   // larger height
+                        );
+                    }
+
+                    // for thumbnails, find the appropriate mip level close to 128x128 and make it the only mip
+                    if (m_flags & RHI_Texture_Thumbnail)
+                    {
+                        uint32_t target_mip = 0;
+                        for (uint32_t i = 0; i < m_slices[0].mips.size(); i++)
+                        {
+                            uint32_t mip_width  = max(1u, m_width >> i);
+                            uint32_t mip_height = max(1u, m_height >> i);
                         
-                        if (mip_width <= 128 && mip_height <= 128)
+                            if (mip_width <= 128 && mip_height <= 128)
+                            {
+                                target_mip = i;
+                                break;
+                            }
+                        }
+
+                        // move the target mip to the top
+                        if (target_mip > 0)
                         {
-                            target_mip = i;
-                            break;
+                            m_slices[0].mips[0] = move(m_slices[0].mips[target_mip]);
+                            m_width             = max(1u, m_width >> target_mip);
+                            m_height            = max(1u, m_height >> target_mip);
                         }
+                    
+                        // clear all other mips
+                        m_slices[0].mips.resize(1);
+                        m_mip_count = static_cast<uint32_t>(m_slices[0].mips.size());
                     }
 
-                    // move the target mip to the top
-                    if (target_mip > 0)
+                    // compress
+                    bool compress       = m_flags & RHI_Texture_Compress;
+                    bool not_compressed = !IsCompressedFormat();
+                    if (compress && not_compressed)
                     {
-                        m_slices[0].mips[0] = move(m_slices[0].mips[target_mip]);
-                        m_width             = max(1u, m_width >> target_mip);
-                        m_height            = max(1u, m_height >> target_mip);
+                        compressonator::compress(this);
                     }
-                    
-                    // clear all other mips
-                    m_slices[0].mips.resize(1);
-                    m_mip_count = static_cast<uint32_t>(m_slices[0].mips.size());
-                }
 
-                // compress
-                bool compress       = m_flags & RHI_Texture_Compress;
-                bool not_compressed = !IsCompressedFormat();
-                if (compress && not_compressed)
-                {
-                    compressonator::compress(this);
+                    if (!cache_path.empty())
+                    {
+                        SaveToCache(cache_path, timer.GetElapsedTimeMs());
+                    }
                 }
             }
-            
-            // upload to gpu
+        }
+
+        // the resource cache will call UploadToGpu() from the main thread
+        if (m_defer_gpu_upload)
+            return;
+
+        UploadToGpu();
+    }
+
+    bool RHI_Texture::LoadFromCache(const string& file_path)
+    {
+        if (!FileSystem::Exists(file_path))
+            return false;
+
+        const Stopwatch timer;
+
+        FileStream file(file_path, FileStream_Read | FileStream_Mapped);
+        if (!file.IsOpen())
+            return false;
+
+        // the .texture layout, followed by how long the preparation took
+        file.ReadAs<uint64_t>(); // byte count
+        const uint32_t depth     = file.ReadAs<uint32_t>();
+        const uint32_t mip_count = file.ReadAs<uint32_t>();
+        if (depth != 1 || mip_count == 0 || mip_count > rhi_max_mip_count)
+            return false;
+
+        vector<RHI_Texture_Mip> mips(mip_count);
+        for (RHI_Texture_Mip& mip : mips)
+        {
+            file.Read(&mip.bytes);
+            if (mip.bytes.empty())
+                return false;
+        }
+
+        const uint32_t width  = file.ReadAs<uint32_t>();
+        const uint32_t height = file.ReadAs<uint32_t>();
+        file.ReadAs<uint32_t>(); // channel count
+        file.ReadAs<uint32_t>(); // bits per channel
+        file.ReadAs<uint32_t>(); // type
+        const RHI_Format format = static_cast<RHI_Format>(file.ReadAs<uint32_t>());
+        file.ReadAs<uint32_t>(); // flags
+        file.ReadAs<uint64_t>(); // id
+        file.ReadAs<string>();   // resource path
+        const double prepare_ms = file.ReadAs<double>();
+
+        // a truncated file is prepared again, and replaced once it has been
+        if (!file.IsGood())
+            return false;
+
+        m_slices[0].mips = move(mips);
+        m_mip_count      = mip_count;
+        m_width          = width;
+        m_height         = height;
+        m_format         = format;
+
+        // keeps it from being trimmed
+        file.Close();
+        texture_cache::touch(file_path);
+
+        texture_cache::counters.Hit(prepare_ms, timer.GetElapsedTimeMs());
+
+        return true;
+    }
+
+    void RHI_Texture::SaveToCache(const string& file_path, const double prepare_ms)
+    {
+        texture_cache::counters.Miss();
+
+        // another thread can be preparing the same texture, the next load never sees a half written file
+        const bool written = FileStream::WriteAtomic(file_path, FileStream_Compressed, [this, prepare_ms](FileStream& file)
+        {
+            uint64_t byte_count = 0;
+            for (const RHI_Texture_Mip& mip : m_slices[0].mips)
+            {
+                byte_count += mip.bytes.size();
+            }
+
+            file.Write(byte_count);
+            file.Write(m_depth);
+            file.Write(m_mip_count);
+            for (const RHI_Texture_Mip& mip : m_slices[0].mips)
+            {
+                file.Write(mip.bytes);
+            }
+            file.Write(m_width);
+            file.Write(m_height);
+            file.Write(m_channel_count);
+            file.Write(m_bits_per_channel);
+            file.Write(static_cast<uint32_t>(m_type));
+            file.Write(static_cast<uint32_t>(m_format));
+            file.Write(m_flags);
+            file.Write(GetObjectId());
+            file.Write(GetResourceFilePath());
+            file.Write(prepare_ms);
+        });
+
+        if (written)
+        {
+            texture_cache::on_added(file_path);
+        }
+    }
+
+    RHI_CacheStats RHI_Texture::GetCacheStats()
+    {
+        return texture_cache::counters.GetStats();
+    }
+
+    void RHI_Texture::UploadToGpu()
+    {
+        if (m_resource_state != ResourceState::PreparingForGpu)
+            return;
+
+        if (!(m_flags & RHI_Texture_DontPrepareForGpu))
+        {
             SP_ASSERT(RHI_CreateResource());
         }
 
@@ -117,8 +117,10 @@ namespace Spartan
         // misc
         void ClearData();
         void PrepareForGpu();
+        void UploadToGpu() override;
         void SaveAsImage(const std::string& file_path);
         static size_t CalculateMipSize(uint32_t width, uint32_t height, uint32_t depth, RHI_Format format, uint32_t bits_per_channel, uint32_t channel_count);
+        static RHI_CacheStats GetCacheStats();
 
         // data
         uint32_t GetMipCount() const { return m_mip_count; }
@@ -199,5 +201,7 @@ namespace Spartan
 
     private:
         void ComputeMemoryUsage();
+        bool LoadFromCache(const std::string& file_path);
+        void SaveToCache(const std::string& file_path, const double prepare_ms);
     };
 }
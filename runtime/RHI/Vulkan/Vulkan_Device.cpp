@@ -32,6 +32,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_Shader.h"
 #include "../RHI_DescriptorSetLayout.h"
 #include "../RHI_Pipeline.h"
+#include "../RHI_Texture.h"
+#include "../Core/ThreadPool.h"
+#include "../IO/FileStream.h"
+#include "../Resource/ResourceCache.h"
 SP_WARNINGS_OFF
 #define VMA_IMPLEMENTATION
 #include "vk_mem_alloc.h"
@@ -861,7 +865,7 @@ namespace Spartan
             descriptor_cache[pipeline_state_hash] = descriptors;
         }
 
-        shared_ptr<RHI_DescriptorSetLayout> get_or_create_descriptor_set_layout(RHI_PipelineState& pipeline_state)
+        shared_ptr<RHI_DescriptorSetLayout> get_or_create_descriptor_set_layout(RHI_PipelineState& pipeline_state, const bool clear_descriptor_data = true)
         {
             // get descriptors from pipeline state
             vector<RHI_Descriptor> descriptors;
@@ -887,7 +891,7 @@ namespace Spartan
             }
             shared_ptr<RHI_DescriptorSetLayout> descriptor_set_layout = it->second;
 
-            if (cached)
+            if (cached && clear_descriptor_data)
             {
                 descriptor_set_layout->ClearDescriptorData();
             }
@@ -987,7 +991,7 @@ namespace Spartan
                 }
             }
 
-            void update_textures(const array<RHI_Texture*, rhi_max_array_size>* textures, const uint32_t binding_slot)
+            void update_textures(const array<RHI_Texture*, rhi_max_array_size>* textures, const uint32_t binding_slot, const uint32_t start = 0, const uint32_t count = rhi_max_array_size)
             {
                 uint32_t texture_count = static_cast<uint32_t>(textures->size());
                 uint32_t binding       = rhi_shader_shift_register_t + binding_slot;
@@ -1001,12 +1005,14 @@ namespace Spartan
                     create_set(RHI_Device_Resource::textures_material, texture_count, debug_name);
                 }
 
-                // update
+                // update, only the requested range is written, the rest of the set is left as is
+                SP_ASSERT(start < texture_count);
+                uint32_t update_count = min(count, texture_count - start);
                 {
-                    vector<VkDescriptorImageInfo> image_infos(texture_count);
-                    for (uint32_t i = 0; i < texture_count; ++i)
+                    vector<VkDescriptorImageInfo> image_infos(update_count);
+                    for (uint32_t i = 0; i < update_count; ++i)
                     {
-                        RHI_Texture* texture = (*textures)[i];
+                        RHI_Texture* texture = (*textures)[start + i];
                         if (!texture)
                             continue;
 
@@ -1023,9 +1029,9 @@ namespace Spartan
                     descriptor_write.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
                     descriptor_write.dstSet               = sets[static_cast<uint32_t>(RHI_Device_Resource::textures_material)];
                     descriptor_write.dstBinding           = binding;
-                    descriptor_write.dstArrayElement      = 0; // starting element in the array
+                    descriptor_write.dstArrayElement      = start; // starting element in the array
                     descriptor_write.descriptorType       = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-                    descriptor_write.descriptorCount      = texture_count;
+                    descriptor_write.descriptorCount      = update_count;
                     descriptor_write.pImageInfo           = image_infos.data();
 
                     vkUpdateDescriptorSets(RHI_Context::device, 1, &descriptor_write, 0, nullptr);
@@ -1047,6 +1053,595 @@ namespace Spartan
         }
     }
 
+    namespace pipeline_cache
+    {
+        // the driver's cache of compiled pipelines, plus a description of every pipeline state seen in previous runs,
+        // those are created in the background as soon as their shaders compile, so they don't hitch on first use
+        const uint32_t version = 2;
+        const uint32_t none    = numeric_limits<uint32_t>::max();
+
+        // resources are referred to by their renderer enum, the hash/format catches enums which point to something else by now
+        struct shader_reference
+        {
+            uint32_t index = none;
+            uint64_t hash  = 0;
+        };
+
+        // render targets that the renderer doesn't own are the shadow maps of lights, which the renderer hands over, those are
+        // referred to by which of the light's textures they are and by their size, and can be matched by any light with the same ones
+        enum class texture_owner : uint32_t
+        {
+            renderer,
+            light
+        };
+
+        enum class light_texture : uint32_t
+        {
+            depth,
+            color,
+            max
+        };
+        using light_textures = array<RHI_Texture*, static_cast<uint32_t>(light_texture::max)>;
+
+        struct texture_reference
+        {
+            texture_owner owner   = texture_owner::renderer;
+            uint32_t index        = none; // Renderer_RenderTarget or light_texture
+            uint32_t format       = 0;
+            uint32_t width        = 0;
+            uint32_t depth        = 0; // array length
+
+            uint64_t get_hash() const
+            {
+                uint64_t hash = rhi_hash_combine(static_cast<uint64_t>(owner), index);
+                hash          = rhi_hash_combine(hash, format);
+                hash          = rhi_hash_combine(hash, width);
+                return rhi_hash_combine(hash, depth);
+            }
+        };
+
+        struct description
+        {
+            array<shader_reference, static_cast<uint32_t>(RHI_Shader_Type::Max)> shaders;
+            array<texture_reference, rhi_max_render_target_count> render_target_color_textures;
+            texture_reference render_target_depth_texture;
+            texture_reference vrs_input_texture;
+            uint32_t rasterizer_state          = none;
+            uint32_t blend_state               = none;
+            uint32_t depth_stencil_state       = none;
+            uint32_t primitive_topology        = 0;
+            uint32_t render_target_array_index = 0;
+            bool render_target_swapchain       = false;
+            bool instancing                    = false;
+            string name;
+
+            uint64_t get_hash() const
+            {
+                uint64_t hash = 0;
+                for (const shader_reference& shader : shaders)
+                {
+                    hash = rhi_hash_combine(hash, shader.index);
+                    hash = rhi_hash_combine(hash, shader.hash);
+                }
+                for (const texture_reference& texture : render_target_color_textures)
+                {
+                    hash = rhi_hash_combine(hash, texture.get_hash());
+                }
+                hash = rhi_hash_combine(hash, render_target_depth_texture.get_hash());
+                hash = rhi_hash_combine(hash, vrs_input_texture.get_hash());
+                hash = rhi_hash_combine(hash, rasterizer_state);
+                hash = rhi_hash_combine(hash, blend_state);
+                hash = rhi_hash_combine(hash, depth_stencil_state);
+                hash = rhi_hash_combine(hash, primitive_topology);
+                hash = rhi_hash_combine(hash, render_target_array_index);
+                hash = rhi_hash_combine(hash, static_cast<uint64_t>(render_target_swapchain));
+                hash = rhi_hash_combine(hash, static_cast<uint64_t>(instancing));
+
+                return hash;
+            }
+
+            bool uses_light_textures() const
+            {
+                bool uses = render_target_depth_texture.owner == texture_owner::light || vrs_input_texture.owner == texture_owner::light;
+                for (const texture_reference& texture : render_target_color_textures)
+                {
+                    uses |= texture.owner == texture_owner::light;
+                }
+
+                return uses;
+            }
+        };
+
+        const uint32_t blend_state_count = static_cast<uint32_t>(Renderer_BlendState::Additive) + 1;
+
+        // what gets saved, pipelines created this run and the ones from previous runs which could be created again,
+        // so that descriptions which stopped matching anything don't pile up, guarded by the pipeline mutex
+        vector<description> descriptions;
+        unordered_set<uint64_t> known;
+        vector<description> pending; // seen in previous runs and not created yet, only touched by the render thread
+        vector<light_textures> lights; // guarded by the pipeline mutex
+        atomic<bool> prewarming        = false;
+        atomic<bool> prewarm_cancelled = false; // the renderer is shutting down, its resources are about to go
+
+        string get_path()
+        {
+            return ResourceCache::GetResourceDirectory(ResourceDirectory::Cache) + "\\pipelines\\pipelines.cache";
+        }
+
+        // none for null, false for something the renderer doesn't own (those can't be described)
+        template<typename T, typename Getter>
+        bool to_index(const T* object, const uint32_t count, Getter get, uint32_t* index)
+        {
+            *index = none;
+            if (!object)
+                return true;
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (get(i) == object)
+                {
+                    *index = i;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool to_texture_reference(const RHI_Texture* texture, texture_reference* reference)
+        {
+            if (texture)
+            {
+                reference->format       = static_cast<uint32_t>(texture->GetFormat());
+                reference->width        = texture->GetWidth();
+                reference->depth        = texture->GetDepth();
+            }
+
+            auto& render_targets = Renderer::GetRenderTargets();
+            if (to_index(texture, static_cast<uint32_t>(render_targets.size()), [&render_targets](uint32_t i) { return render_targets[i].get(); }, &reference->index))
+                return true;
+
+            for (const light_textures& light : lights)
+            {
+                for (uint32_t i = 0; i < static_cast<uint32_t>(light.size()); i++)
+                {
+                    if (light[i] && light[i] == texture)
+                    {
+                        reference->owner = texture_owner::light;
+                        reference->index = i;
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+        // light textures are taken from the given light, a different size or format makes the description invalid for it
+        RHI_Texture* from_texture_reference(const texture_reference& reference, const light_textures* light, bool* valid)
+        {
+            if (reference.index == none)
+                return nullptr;
+
+            RHI_Texture* texture = nullptr;
+            if (reference.owner == texture_owner::light)
+            {
+                texture = light && reference.index < static_cast<uint32_t>(light->size()) ? (*light)[reference.index] : nullptr;
+            }
+            else if (reference.index < static_cast<uint32_t>(Renderer_RenderTarget::max))
+            {
+                texture = Renderer::GetRenderTarget(static_cast<Renderer_RenderTarget>(reference.index));
+            }
+
+            if (!texture || static_cast<uint32_t>(texture->GetFormat()) != reference.format ||
+                (reference.owner == texture_owner::light && (texture->GetWidth() != reference.width || texture->GetDepth() != reference.depth)))
+            {
+                *valid = false;
+            }
+
+            return texture;
+        }
+
+        // called when a pipeline is created, with the pipeline mutex locked
+        void record(const RHI_PipelineState& pso)
+        {
+            description desc;
+            desc.primitive_topology        = static_cast<uint32_t>(pso.primitive_toplogy);
+            desc.render_target_array_index = pso.render_target_array_index;
+            desc.render_target_swapchain   = pso.render_target_swapchain != nullptr;
+            desc.instancing                = pso.instancing;
+            desc.name                      = pso.name;
+
+            if (pso.render_target_swapchain && pso.render_target_swapchain != Renderer::GetSwapChain())
+                return;
+
+            auto& shaders = Renderer::GetShaders();
+            for (uint32_t i = 0; i < static_cast<uint32_t>(pso.shaders.size()); i++)
+            {
+                if (!to_index(pso.shaders[i], static_cast<uint32_t>(shaders.size()), [&shaders](uint32_t index) { return shaders[index].get(); }, &desc.shaders[i].index))
+                    return;
+
+                desc.shaders[i].hash = pso.shaders[i] ? pso.shaders[i]->GetHash() : 0;
+            }
+
+            for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
+            {
+                if (!to_texture_reference(pso.render_target_color_textures[i], &desc.render_target_color_textures[i]))
+                    return;
+            }
+
+            if (!to_texture_reference(pso.render_target_depth_texture, &desc.render_target_depth_texture) ||
+                !to_texture_reference(pso.vrs_input_texture, &desc.vrs_input_texture))
+                return;
+
+            if (!to_index(pso.rasterizer_state,    static_cast<uint32_t>(Renderer_RasterizerState::Max),   [](uint32_t i) { return Renderer::GetRasterizerState(static_cast<Renderer_RasterizerState>(i)); },     &desc.rasterizer_state) ||
+                !to_index(pso.blend_state,         blend_state_count,                                      [](uint32_t i) { return Renderer::GetBlendState(static_cast<Renderer_BlendState>(i)); },             &desc.blend_state) ||
+                !to_index(pso.depth_stencil_state, static_cast<uint32_t>(Renderer_DepthStencilState::Max), [](uint32_t i) { return Renderer::GetDepthStencilState(static_cast<Renderer_DepthStencilState>(i)); }, &desc.depth_stencil_state))
+                return;
+
+            if (known.insert(desc.get_hash()).second)
+            {
+                descriptions.emplace_back(move(desc));
+            }
+        }
+
+        enum class resolve_result
+        {
+            ready,
+            waiting, // for shaders to compile
+            invalid
+        };
+
+        resolve_result resolve(const description& desc, const light_textures* light, RHI_PipelineState* pso)
+        {
+            for (uint32_t i = 0; i < static_cast<uint32_t>(desc.shaders.size()); i++)
+            {
+                const shader_reference& reference = desc.shaders[i];
+                if (reference.index == none)
+                    continue;
+
+                RHI_Shader* shader = reference.index < static_cast<uint32_t>(Renderer_Shader::max) ? Renderer::GetShader(static_cast<Renderer_Shader>(reference.index)) : nullptr;
+                if (!shader || shader->GetHash() != reference.hash || shader->GetCompilationState() == RHI_ShaderCompilationState::Failed)
+                    return resolve_result::invalid;
+
+                if (!shader->IsCompiled())
+                    return resolve_result::waiting;
+
+                pso->shaders[i] = shader;
+            }
+
+            bool valid = true;
+            for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
+            {
+                pso->render_target_color_textures[i] = from_texture_reference(desc.render_target_color_textures[i], light, &valid);
+            }
+            pso->render_target_depth_texture = from_texture_reference(desc.render_target_depth_texture, light, &valid);
+            pso->vrs_input_texture           = from_texture_reference(desc.vrs_input_texture, light, &valid);
+
+            if (desc.rasterizer_state != none)
+            {
+                valid                  &= desc.rasterizer_state < static_cast<uint32_t>(Renderer_RasterizerState::Max);
+                pso->rasterizer_state   = valid ? Renderer::GetRasterizerState(static_cast<Renderer_RasterizerState>(desc.rasterizer_state)) : nullptr;
+            }
+            if (desc.blend_state != none)
+            {
+                valid            &= desc.blend_state < blend_state_count;
+                pso->blend_state  = valid ? Renderer::GetBlendState(static_cast<Renderer_BlendState>(desc.blend_state)) : nullptr;
+            }
+            if (desc.depth_stencil_state != none)
+            {
+                valid                    &= desc.depth_stencil_state < static_cast<uint32_t>(Renderer_DepthStencilState::Max);
+                pso->depth_stencil_state  = valid ? Renderer::GetDepthStencilState(static_cast<Renderer_DepthStencilState>(desc.depth_stencil_state)) : nullptr;
+            }
+
+            pso->render_target_swapchain   = desc.render_target_swapchain ? Renderer::GetSwapChain() : nullptr;
+            pso->primitive_toplogy         = static_cast<RHI_PrimitiveTopology>(desc.primitive_topology);
+            pso->render_target_array_index = desc.render_target_array_index;
+            pso->instancing                = desc.instancing;
+            pso->name                      = desc.name;
+
+            valid &= !desc.render_target_swapchain || pso->render_target_swapchain != nullptr;
+            valid &= desc.primitive_topology < static_cast<uint32_t>(RHI_PrimitiveTopology::Max);
+
+            return valid ? resolve_result::ready : resolve_result::invalid;
+        }
+
+        // unlike RHI_Device::GetOrCreatePipeline(), the driver compiles outside of the lock and the
+        // descriptor data of a cached layout is left alone, as the render thread might be using it
+        void create(RHI_PipelineState& pso)
+        {
+            pso.Prepare();
+
+            RHI_DescriptorSetLayout* descriptor_set_layout = nullptr;
+            {
+                lock_guard<mutex> lock(descriptors::descriptor_pipeline_mutex);
+                if (descriptors::pipelines.find(pso.GetHash()) != descriptors::pipelines.end())
+                    return;
+
+                descriptor_set_layout = descriptors::get_or_create_descriptor_set_layout(pso, false).get();
+            }
+
+            shared_ptr<RHI_Pipeline> pipeline = make_shared<RHI_Pipeline>(pso, descriptor_set_layout);
+
+            // if the render thread got there first, this one is released
+            lock_guard<mutex> lock(descriptors::descriptor_pipeline_mutex);
+            descriptors::pipelines.emplace(pso.GetHash(), pipeline);
+        }
+
+        void prewarm()
+        {
+            if (pending.empty() || prewarming || prewarm_cancelled)
+                return;
+
+            vector<light_textures> lights_current;
+            {
+                lock_guard<mutex> lock(descriptors::descriptor_pipeline_mutex);
+                lights_current = lights;
+            }
+
+            vector<RHI_PipelineState> states;
+            vector<description> resolved;
+            for (auto it = pending.begin(); it != pending.end();)
+            {
+                // descriptions that render to shadow maps are created for every light with matching ones,
+                // they wait for such a light to show up, and are dropped at shutdown if none did
+                resolve_result result = resolve_result::invalid;
+                if (it->uses_light_textures())
+                {
+                    for (const light_textures& light : lights_current)
+                    {
+                        RHI_PipelineState pso;
+                        resolve_result light_result = resolve(*it, &light, &pso);
+                        if (light_result == resolve_result::ready)
+                        {
+                            states.emplace_back(pso);
+                        }
+
+                        if (result != resolve_result::ready)
+                        {
+                            result = light_result;
+                        }
+                    }
+
+                    if (result == resolve_result::invalid)
+                    {
+                        result = resolve_result::waiting;
+                    }
+                }
+                else
+                {
+                    RHI_PipelineState pso;
+                    result = resolve(*it, nullptr, &pso);
+                    if (result == resolve_result::ready)
+                    {
+                        states.emplace_back(pso);
+                    }
+                }
+
+                if (result == resolve_result::waiting)
+                {
+                    it++;
+                    continue;
+                }
+
+                if (result == resolve_result::ready)
+                {
+                    resolved.emplace_back(move(*it));
+                }
+                it = pending.erase(it);
+            }
+
+            // these were valid this run, so they are saved again
+            if (!resolved.empty())
+            {
+                lock_guard<mutex> lock(descriptors::descriptor_pipeline_mutex);
+                for (description& desc : resolved)
+                {
+                    if (known.insert(desc.get_hash()).second)
+                    {
+                        descriptions.emplace_back(move(desc));
+                    }
+                }
+            }
+
+            if (states.empty())
+                return;
+
+            prewarming = true;
+            ThreadPool::AddTask([states = move(states)]() mutable
+            {
+                for (RHI_PipelineState& pso : states)
+                {
+                    if (prewarm_cancelled)
+                        break;
+
+                    create(pso);
+                }
+
+                prewarming = false;
+            });
+        }
+
+        void cancel_prewarm()
+        {
+            prewarm_cancelled = true;
+            while (prewarming)
+            {
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+
+            // the shadow maps are about to be released
+            lock_guard<mutex> lock(descriptors::descriptor_pipeline_mutex);
+            lights.clear();
+        }
+
+        // the driver data and the descriptions, false if there is no file, or it's from another version
+        bool read(const string& file_path, vector<std::byte>* data, vector<description>* file_descriptions)
+        {
+            auto read_texture_reference = [](FileStream& file, texture_reference* reference)
+            {
+                reference->owner = static_cast<texture_owner>(file.ReadAs<uint32_t>());
+                file.Read(&reference->index);
+                file.Read(&reference->format);
+                file.Read(&reference->width);
+                file.Read(&reference->depth);
+            };
+
+            FileStream file(file_path, FileStream_Read);
+            if (!file.IsOpen() || file.ReadAs<uint32_t>() != version)
+                return false;
+
+            file.Read(data);
+
+            file_descriptions->resize(file.ReadAs<uint32_t>());
+            for (description& desc : *file_descriptions)
+            {
+                for (shader_reference& shader : desc.shaders)
+                {
+                    file.Read(&shader.index);
+                    file.Read(&shader.hash);
+                }
+                for (texture_reference& texture : desc.render_target_color_textures)
+                {
+                    read_texture_reference(file, &texture);
+                }
+                read_texture_reference(file, &desc.render_target_depth_texture);
+                read_texture_reference(file, &desc.vrs_input_texture);
+                file.Read(&desc.rasterizer_state);
+                file.Read(&desc.blend_state);
+                file.Read(&desc.depth_stencil_state);
+                file.Read(&desc.primitive_topology);
+                file.Read(&desc.render_target_array_index);
+                file.Read(&desc.render_target_swapchain);
+                file.Read(&desc.instancing);
+                file.Read(&desc.name);
+            }
+
+            return file.IsGood();
+        }
+
+        void initialize()
+        {
+            vector<std::byte> data;
+            vector<description> file_descriptions;
+            if (read(get_path(), &data, &file_descriptions))
+            {
+                // they are only saved again if they can be created, or are used, this run
+                unordered_set<uint64_t> loaded;
+                for (description& desc : file_descriptions)
+                {
+                    if (loaded.insert(desc.get_hash()).second)
+                    {
+                        pending.emplace_back(move(desc));
+                    }
+                }
+            }
+            else
+            {
+                data.clear();
+            }
+
+            // the driver data is only usable by the same driver and gpu, drivers should reject it otherwise but not all of them do
+            if (data.size() >= sizeof(VkPipelineCacheHeaderVersionOne))
+            {
+                VkPhysicalDeviceProperties properties = {};
+                vkGetPhysicalDeviceProperties(RHI_Context::device_physical, &properties);
+
+                VkPipelineCacheHeaderVersionOne header = {};
+                memcpy(&header, data.data(), sizeof(header));
+
+                bool compatible = header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                                  header.vendorID      == properties.vendorID &&
+                                  header.deviceID      == properties.deviceID &&
+                                  memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+
+                if (!compatible)
+                {
+                    data.clear();
+                }
+            }
+            else
+            {
+                data.clear();
+            }
+
+            VkPipelineCacheCreateInfo create_info = {};
+            create_info.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            create_info.initialDataSize           = data.size();
+            create_info.pInitialData              = data.empty() ? nullptr : data.data();
+
+            SP_ASSERT_VK(vkCreatePipelineCache(RHI_Context::device, &create_info, nullptr, &RHI_Context::pipeline_cache));
+
+            if (!pending.empty())
+            {
+                SP_LOG_INFO("Prewarming %zu pipelines from previous runs", pending.size());
+            }
+        }
+
+        void shutdown()
+        {
+            cancel_prewarm();
+
+            vector<std::byte> data;
+            size_t size = 0;
+            if (vkGetPipelineCacheData(RHI_Context::device, RHI_Context::pipeline_cache, &size, nullptr) == VK_SUCCESS && size != 0)
+            {
+                data.resize(size);
+                if (vkGetPipelineCacheData(RHI_Context::device, RHI_Context::pipeline_cache, &size, data.data()) != VK_SUCCESS)
+                {
+                    data.clear();
+                }
+                data.resize(size);
+            }
+
+            vkDestroyPipelineCache(RHI_Context::device, RHI_Context::pipeline_cache, nullptr);
+            RHI_Context::pipeline_cache = nullptr;
+
+            const string file_path = get_path();
+            FileSystem::CreateDirectory(FileSystem::GetDirectoryFromFilePath(file_path));
+            FileStream file(file_path, FileStream_Write);
+            if (!file.IsOpen())
+                return;
+
+            auto write_texture_reference = [](FileStream& file, const texture_reference& reference)
+            {
+                file.Write(static_cast<uint32_t>(reference.owner));
+                file.Write(reference.index);
+                file.Write(reference.format);
+                file.Write(reference.width);
+                file.Write(reference.depth);
+            };
+
+            file.Write(version);
+            file.Write(data);
+            file.Write(static_cast<uint32_t>(descriptions.size()));
+            for (const description& desc : descriptions)
+            {
+                for (const shader_reference& shader : desc.shaders)
+                {
+                    file.Write(shader.index);
+                    file.Write(shader.hash);
+                }
+                for (const texture_reference& texture : desc.render_target_color_textures)
+                {
+                    write_texture_reference(file, texture);
+                }
+                write_texture_reference(file, desc.render_target_depth_texture);
+                write_texture_reference(file, desc.vrs_input_texture);
+                file.Write(desc.rasterizer_state);
+                file.Write(desc.blend_state);
+                file.Write(desc.depth_stencil_state);
+                file.Write(desc.primitive_topology);
+                file.Write(desc.render_target_array_index);
+                file.Write(desc.render_target_swapchain);
+                file.Write(desc.instancing);
+                file.Write(desc.name);
+            }
+
+            file.Close();
+        }
+    }
+
     namespace device_features
     {
         VkPhysicalDeviceFeatures2 features                          = {};
@@ -1351,6 +1946,7 @@ namespace Spartan
 
         vulkan_memory_allocator::initialize();
         CreateDescriptorPool();
+        pipeline_cache::initialize();
 
         // gpu dependent actions
         {
@@ -1382,6 +1978,9 @@ namespace Spartan
         {
             queues::regular[i]->NextCommandList();
         }
+
+        // create pipelines from previous runs whose shaders have compiled by now
+        pipeline_cache::prewarm();
     }
 
     void RHI_Device::Destroy()
@@ -1392,6 +1991,9 @@ namespace Spartan
         QueueWaitAll();
         queues::destroy();
 
+        // save the driver's pipeline cache and the pipeline states of this run
+        pipeline_cache::shutdown();
+
         // descriptor pool
         vkDestroyDescriptorPool(RHI_Context::device, descriptors::descriptor_pool, nullptr);
         descriptors::descriptor_pool = nullptr;
@@ -1767,7 +2369,7 @@ namespace Spartan
         return VkDescriptorType::VK_DESCRIPTOR_TYPE_MAX_ENUM;
     }
 
-    void RHI_Device::UpdateBindlessResources(const array<shared_ptr<RHI_Sampler>, static_cast<uint32_t>(Renderer_Sampler::Max)>* samplers, array<RHI_Texture*, rhi_max_array_size>* textures)
+    void RHI_Device::UpdateBindlessResources(const array<shared_ptr<RHI_Sampler>, static_cast<uint32_t>(Renderer_Sampler::Max)>* samplers, array<RHI_Texture*, rhi_max_array_size>* textures, const uint32_t texture_start, const uint32_t texture_count)
     {
         if (samplers)
         {
@@ -1816,9 +2418,9 @@ namespace Spartan
                 }
             }
 
-            if (textures)
+            if (textures && texture_count != 0)
             {
-                descriptors::bindless::update_textures(textures, binding_slot);
+                descriptors::bindless::update_textures(textures, binding_slot, texture_start, texture_count);
             }
         }
     }
@@ -1840,6 +2442,9 @@ namespace Spartan
         {
             // create a new pipeline
             it = descriptors::pipelines.emplace(make_pair(hash, make_shared<RHI_Pipeline>(pso, descriptor_set_layout))).first;
+
+            // remember it, so the next run can create it ahead of time
+            pipeline_cache::record(pso);
         }
 
         pipeline = it->second.get();
@@ -1850,6 +2455,17 @@ namespace Spartan
         return static_cast<uint32_t>(descriptors::pipelines.size());
     }
 
+    void RHI_Device::PipelineCacheSetLightTextures(const vector<array<RHI_Texture*, 2>>& textures)
+    {
+        lock_guard<mutex> lock(descriptors::descriptor_pipeline_mutex);
+        pipeline_cache::lights = textures;
+    }
+
+    void RHI_Device::PipelineCacheCancelPrewarm()
+    {
+        pipeline_cache::cancel_prewarm();
+    }
+
     // memory
 
     void* RHI_Device::MemoryGetMappedDataFromBuffer(void* resource)
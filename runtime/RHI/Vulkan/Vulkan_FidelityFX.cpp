@@ -1171,7 +1171,7 @@ namespace Spartan
         RHI_CommandList* cmd_list,
         const float resolution_scale,
         Cb_Frame* cb_frame,
-        vector<shared_ptr<Entity>>& entities,
+        frame_vector<shared_ptr<Entity>>& entities,
         int64_t index_start,
         int64_t index_end,
         RHI_Texture* tex_debug
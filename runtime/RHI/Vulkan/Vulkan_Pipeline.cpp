@@ -439,7 +439,7 @@ namespace Spartan
                     pipeline_info.layout                       = static_cast<VkPipelineLayout>(m_rhi_resource_pipeline);
                     pipeline_info.flags                        = m_state.vrs_input_texture ? VK_PIPELINE_CREATE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR : 0;
 
-                    SP_ASSERT_VK(vkCreateGraphicsPipelines(RHI_Context::device, nullptr, 1, &pipeline_info, nullptr, pipeline));
+                    SP_ASSERT_VK(vkCreateGraphicsPipelines(RHI_Context::device, RHI_Context::pipeline_cache, 1, &pipeline_info, nullptr, pipeline));
                     RHI_Device::SetResourceName(static_cast<void*>(*pipeline), RHI_Resource_Type::Pipeline, pipeline_state.name);
                 }
             }
@@ -450,7 +450,7 @@ namespace Spartan
                 pipeline_info.layout                      = static_cast<VkPipelineLayout>(m_rhi_resource_pipeline);
                 pipeline_info.stage                       = shader_stages[0];
 
-                SP_ASSERT_VK(vkCreateComputePipelines(RHI_Context::device, nullptr, 1, &pipeline_info, nullptr, pipeline));
+                SP_ASSERT_VK(vkCreateComputePipelines(RHI_Context::device, RHI_Context::pipeline_cache, 1, &pipeline_info, nullptr, pipeline));
                 RHI_Device::SetResourceName(static_cast<void*>(*pipeline), RHI_Resource_Type::Pipeline, pipeline_state.name);
             }
         }
@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_Shader.h"
 #include "../RHI_InputLayout.h"
 #include "../RHI_DirectXShaderCompiler.h"
+#include "../../Resource/ResourceCache.h"
 SP_WARNINGS_OFF
 #include <spirv_cross/spirv_hlsl.hpp>
 SP_WARNINGS_ON
@@ -88,10 +89,43 @@ namespace Spartan
         };
 
         atomic<bool> spriv_cross_registered = false;
+
+        // the shader hash covers the preprocessed source and the defines, the arguments cover
+        // everything else that changes the output (stage, entry point, optimization, debug info)
+        string get_cache_path(const RHI_Shader* shader, const vector<string>& arguments)
+        {
+            hash<string> hasher;
+            uint64_t hash = shader->GetHash();
+            hash          = rhi_hash_combine(hash, static_cast<uint64_t>(hasher(DirecXShaderCompiler::GetVersion())));
+            for (const string& argument : arguments)
+            {
+                hash = rhi_hash_combine(hash, static_cast<uint64_t>(hasher(argument)));
+            }
+
+            return ResourceCache::GetResourceDirectory(ResourceDirectory::Cache) + "\\shaders\\" + shader->GetObjectName() + "_" + FileSystem::HashToHex(hash) + ".spv";
+        }
+
+        VkShaderModule create_shader_module(const uint32_t* spirv, const size_t size, const char* name)
+        {
+            VkShaderModule shader_module         = nullptr;
+            VkShaderModuleCreateInfo create_info = {};
+            create_info.sType                    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+            create_info.codeSize                 = size;
+            create_info.pCode                    = spirv;
+
+            SP_ASSERT_VK(vkCreateShaderModule(RHI_Context::device, &create_info, nullptr, &shader_module));
+
+            // name the shader module (useful for gpu-based validation)
+            RHI_Device::SetResourceName(static_cast<void*>(shader_module), RHI_Resource_Type::Shader, name);
+
+            return shader_module;
+        }
     }
 
     RHI_Shader::~RHI_Shader()
     {
+        ClearDependencies();
+
         if (m_rhi_resource)
         {
             RHI_Device::DeletionQueueAdd(RHI_Resource_Type::Shader, m_rhi_resource);
@@ -154,7 +188,24 @@ namespace Spartan
             arguments.emplace_back("-D"); arguments.emplace_back(define.first + "=" + define.second);
         }
 
+        // load a previous compilation, descriptors included, if nothing that went into it has changed
+        const string cache_path = get_cache_path(this, arguments);
+        vector<uint32_t> spirv;
+        if (LoadFromCache(cache_path, &spirv))
+        {
+            VkShaderModule shader_module = create_shader_module(spirv.data(), spirv.size() * sizeof(uint32_t), m_object_name.c_str());
+
+            // create input layout
+            if (m_input_layout)
+            {
+                m_input_layout->Create(m_vertex_type, nullptr);
+            }
+
+            return static_cast<void*>(shader_module);
+        }
+
         // compile
+        const Stopwatch timer;
         if (IDxcResult* dxc_result = DirecXShaderCompiler::Compile(m_preprocessed_source, arguments))
         {
             // get compiled shader buffer
@@ -162,24 +213,12 @@ namespace Spartan
             dxc_result->GetResult(&shader_buffer);
 
             // create shader module
-            VkShaderModule shader_module         = nullptr;
-            VkShaderModuleCreateInfo create_info = {};
-            create_info.sType                    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-            create_info.codeSize                 = static_cast<size_t>(shader_buffer->GetBufferSize());
-            create_info.pCode                    = reinterpret_cast<const uint32_t*>(shader_buffer->GetBufferPointer());
-
-            SP_ASSERT_VK(vkCreateShaderModule(RHI_Context::device, &create_info, nullptr, &shader_module));
-
-            // name the shader module (useful for gpu-based validation)
-            RHI_Device::SetResourceName(static_cast<void*>(shader_module), RHI_Resource_Type::Shader, m_object_name.c_str());
+            const uint32_t* spirv_ptr    = reinterpret_cast<const uint32_t*>(shader_buffer->GetBufferPointer());
+            const uint32_t word_count    = static_cast<uint32_t>(shader_buffer->GetBufferSize() / 4);
+            VkShaderModule shader_module = create_shader_module(spirv_ptr, static_cast<size_t>(shader_buffer->GetBufferSize()), m_object_name.c_str());
 
             // reflect shader resources (so that descriptor sets can be created later)
-            Reflect
-            (
-                m_shader_type,
-                reinterpret_cast<uint32_t*>(shader_buffer->GetBufferPointer()),
-                static_cast<uint32_t>(shader_buffer->GetBufferSize() / 4)
-            );
+            Reflect(m_shader_type, spirv_ptr, word_count);
             
             // create input layout
             if (m_input_layout)
@@ -187,6 +226,9 @@ namespace Spartan
                 m_input_layout->Create(m_vertex_type, nullptr);
             }
 
+            // store for the next run
+            SaveToCache(cache_path, spirv_ptr, word_count, timer.GetElapsedTimeMs());
+
             // release
             dxc_result->Release();
 
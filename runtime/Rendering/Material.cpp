@@ -27,6 +27,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/World.h"
 #include "../Core/ProgressTracker.h"
 #include "../Core/ThreadPool.h"
+#include "../IO/Package.h"
+#include "../IO/AsyncIo.h"
+#include "../IO/FileStream.h"
 SP_WARNINGS_OFF
 #include "../IO/pugixml.hpp"
 SP_WARNINGS_ON
@@ -144,8 +147,28 @@ namespace Spartan
 
     void Material::LoadFromFile(const std::string& file_path)
     {
+        // materials inside a package, or read ahead, are parsed from memory, pugixml can only open files on disk
         pugi::xml_document doc;
-        if (!doc.load_file(file_path.c_str()))
+        bool loaded                = false;
+        const char* preloaded_data = nullptr;
+        uint64_t preloaded_size    = 0;
+        if (AsyncIo::FindPreloaded(file_path, &preloaded_data, &preloaded_size))
+        {
+            loaded = doc.load_buffer(preloaded_data, preloaded_size);
+        }
+        else if (Package::Exists(file_path))
+        {
+            FileStream file(file_path, FileStream_Read);
+            string xml;
+            file.ReadToEnd(&xml);
+            loaded = doc.load_buffer(xml.data(), xml.size());
+        }
+        else
+        {
+            loaded = doc.load_file(file_path.c_str());
+        }
+
+        if (!loaded)
         {
             SP_LOG_ERROR("Failed to load XML file");
             return;
@@ -254,7 +277,7 @@ namespace Spartan
             SetProperty(MaterialProperty::Height, multiplier);
         }
 
-        SP_FIRE_EVENT(EventType::MaterialOnChanged);
+        SP_FIRE_EVENT_DEFERRED_DATA(EventType::MaterialOnChanged, m_object_id);
     }
 
     void Material::SetTexture(const MaterialTextureType texture_type, shared_ptr<RHI_Texture> texture, const uint8_t slot)
@@ -501,13 +524,18 @@ namespace Spartan
 
         if (property_type == MaterialProperty::ColorA)
         {
-            // if an object switches from opaque to transparent or vice versa, make the world update so that the renderer
-            // goes through the entities and makes the ones that use this material, render in the correct mode.
+            // if an object switches from opaque to transparent or vice versa, update the cull mode, the renderer
+            // sorts by transparency every frame so the entities that use this material will render in the correct mode
             float current_alpha = m_properties[static_cast<uint32_t>(property_type)];
             if ((current_alpha != 1.0f && value == 1.0f) || (current_alpha == 1.0f && value != 1.0f))
             {
                 RHI_CullMode cull_mode = value < 1.0f ? RHI_CullMode::None : RHI_CullMode::Back;
                 m_properties[static_cast<uint32_t>(MaterialProperty::CullMode)] = static_cast<float>(cull_mode);
+            }
+
+            // if it becomes visible or invisible, the entities that use it have to enter or leave the render list
+            if ((current_alpha > 0.0f) != (value > 0.0f))
+            {
                 World::Resolve();
             }
 
@@ -526,7 +554,7 @@ namespace Spartan
         // also the renderer will check all the materials after loading anyway
         if (!ProgressTracker::GetProgress(ProgressType::World).IsProgressing())
         {
-            SP_FIRE_EVENT(EventType::MaterialOnChanged);
+            SP_FIRE_EVENT_DEFERRED_DATA(EventType::MaterialOnChanged, m_object_id);
         }
     }
 
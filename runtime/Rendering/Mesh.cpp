@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Resource/ResourceCache.h"
 #include "../IO/FileStream.h"
 #include "../Resource/Import/ModelImporter.h"
+#include "../Core/ThreadPool.h"
 SP_WARNINGS_OFF
 #include "meshoptimizer/meshoptimizer.h"
 SP_WARNINGS_ON
@@ -155,7 +156,96 @@ namespace Spartan
                 
                SP_LOG_INFO("Mesh: %s | Cache miss ratio: %.2f | Transformed vertex ratio: %.2f | Fetch overfetch: %.2f", name, vcs.acmr, vcs.atvr, vfs.overfetch);
             }
+
+            // the geometry of .model files is stored with the vertex and index codecs, in chunks that decode independently
+            // the codecs are lossless, except that the index codec may rotate the vertices of a triangle (the winding is kept),
+            // the order of triangles and vertices is kept since renderables reference ranges of the buffers
+            const uint32_t chunk_vertex_count = 64 * 1024;
+            const uint32_t chunk_index_count  = 3 * 64 * 1024;
+
+            void encode(const vector<RHI_Vertex_PosTexNorTan>& vertices, const vector<uint32_t>& indices, vector<uint32_t>* index_chunk_sizes, vector<uint32_t>* vertex_chunk_sizes, vector<byte>* data)
+            {
+                SP_ASSERT_MSG(indices.size() % 3 == 0, "The index codec expects a triangle list");
+
+                for (size_t first = 0; first < indices.size(); first += chunk_index_count)
+                {
+                    const size_t count  = min<size_t>(chunk_index_count, indices.size() - first);
+                    const size_t offset = data->size();
+                    data->resize(offset + meshopt_encodeIndexBufferBound(count, vertices.size()));
+
+                    const size_t size = meshopt_encodeIndexBuffer(reinterpret_cast<unsigned char*>(data->data() + offset), data->size() - offset, &indices[first], count);
+                    data->resize(offset + size);
+                    index_chunk_sizes->emplace_back(static_cast<uint32_t>(size));
+                }
+
+                for (size_t first = 0; first < vertices.size(); first += chunk_vertex_count)
+                {
+                    const size_t count  = min<size_t>(chunk_vertex_count, vertices.size() - first);
+                    const size_t offset = data->size();
+                    data->resize(offset + meshopt_encodeVertexBufferBound(count, sizeof(RHI_Vertex_PosTexNorTan)));
+
+                    const size_t size = meshopt_encodeVertexBuffer(reinterpret_cast<unsigned char*>(data->data() + offset), data->size() - offset, &vertices[first], count, sizeof(RHI_Vertex_PosTexNorTan));
+                    data->resize(offset + size);
+                    vertex_chunk_sizes->emplace_back(static_cast<uint32_t>(size));
+                }
+            }
+
+            bool decode(const byte* data, const uint64_t data_size, const vector<uint32_t>& index_chunk_sizes, const vector<uint32_t>& vertex_chunk_sizes, vector<RHI_Vertex_PosTexNorTan>* vertices, vector<uint32_t>* indices)
+            {
+                struct chunk
+                {
+                    uint64_t offset;
+                    uint32_t size;
+                    size_t first;
+                    size_t count;
+                    bool is_index;
+                };
+
+                // lay out the chunks and make sure they match the buffers before touching any of them
+                vector<chunk> chunks;
+                uint64_t offset = 0;
+                for (size_t i = 0; i < index_chunk_sizes.size(); i++)
+                {
+                    const size_t first = i * chunk_index_count;
+                    chunks.push_back({ offset, index_chunk_sizes[i], first, min<size_t>(chunk_index_count, indices->size() - min(first, indices->size())), true });
+                    offset += index_chunk_sizes[i];
+                }
+                for (size_t i = 0; i < vertex_chunk_sizes.size(); i++)
+                {
+                    const size_t first = i * chunk_vertex_count;
+                    chunks.push_back({ offset, vertex_chunk_sizes[i], first, min<size_t>(chunk_vertex_count, vertices->size() - min(first, vertices->size())), false });
+                    offset += vertex_chunk_sizes[i];
+                }
+
+                const size_t index_chunk_count  = (indices->size() + chunk_index_count - 1) / chunk_index_count;
+                const size_t vertex_chunk_count = (vertices->size() + chunk_vertex_count - 1) / chunk_vertex_count;
+                if (offset != data_size || index_chunk_sizes.size() != index_chunk_count || vertex_chunk_sizes.size() != vertex_chunk_count)
+                    return false;
+
+                atomic<bool> success = true;
+                ThreadPool::ParallelLoop([&](uint32_t start, uint32_t end)
+                {
+                    for (uint32_t i = start; i < end; i++)
+                    {
+                        const chunk& c                = chunks[i];
+                        const unsigned char* encoded = reinterpret_cast<const unsigned char*>(data + c.offset);
+                        const int result             = c.is_index ?
+                            meshopt_decodeIndexBuffer(&(*indices)[c.first], c.count, encoded, c.size) :
+                            meshopt_decodeVertexBuffer(&(*vertices)[c.first], c.count, sizeof(RHI_Vertex_PosTexNorTan), encoded, c.size);
+
+                        if (result != 0)
+                        {
+                            success = false;
+                        }
+                    }
+                }, static_cast<uint32_t>(chunks.size()));
+
+                return success;
+            }
         }
+
+        const uint32_t model_magic   = 0x4C444D53; // "SMDL", files without it are from before the geometry was encoded
+        const uint32_t model_version = 1;
     }
 
     Mesh::Mesh() : IResource(ResourceType::Mesh)
@@ -192,15 +282,38 @@ namespace Spartan
         if (FileSystem::GetExtensionFromFilePath(file_path) == EXTENSION_MODEL)
         {
             // deserialize
-            auto file = make_unique<FileStream>(file_path, FileStream_Read);
+            auto file = make_unique<FileStream>(file_path, FileStream_Read | FileStream_Mapped);
             if (!file->IsOpen())
                 return;
 
-            SetResourceFilePath(file->ReadAs<string>());
-            file->Read(&m_indices);
-            file->Read(&m_vertices);
+            if (file->ReadAs<uint32_t>() != model_magic)
+            {
+                file->Seek(0);
+                SetResourceFilePath(file->ReadAs<string>());
+                file->Read(&m_indices);
+                file->Read(&m_vertices);
 
-            PostProcess();
+                PostProcess();
+            }
+            else
+            {
+                const uint32_t version = file->ReadAs<uint32_t>();
+                if (version > model_version)
+                {
+                    SP_LOG_ERROR("\"%s\" is of a newer version (%u) than supported (%u)", file_path.c_str(), version, model_version);
+                    return;
+                }
+
+                SetResourceFilePath(file->ReadAs<string>());
+                if (!ReadGeometry(file.get()))
+                {
+                    SP_LOG_ERROR("Failed to decode the geometry of \"%s\"", file_path.c_str());
+                    return;
+                }
+
+                // saved after post processing, so only the gpu buffers are left to do
+                CreateGpuBuffers();
+            }
         }
         // load foreign format
         else
@@ -211,31 +324,67 @@ namespace Spartan
                 return;
         }
 
-        // compute memory usage
-        {
-            if (m_vertex_buffer && m_index_buffer)
-            {
-                m_object_size = m_vertex_buffer->GetObjectSize();
-                m_object_size += m_index_buffer->GetObjectSize();
-            }
-        }
-
         SP_LOG_INFO("Loading \"%s\" took %d ms", FileSystem::GetFileNameFromFilePath(file_path).c_str(), static_cast<int>(timer.GetElapsedTimeMs()));
     }
 
     void Mesh::SaveToFile(const string& file_path)
     {
-        auto file = make_unique<FileStream>(file_path, FileStream_Write);
+        auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Compressed);
         if (!file->IsOpen())
             return;
 
+        file->Write(model_magic);
+        file->Write(model_version);
         file->Write(GetResourceFilePath());
-        file->Write(m_indices);
-        file->Write(m_vertices);
+        WriteGeometry(file.get());
 
         file->Close();
     }
 
+    void Mesh::WriteGeometry(FileStream* stream)
+    {
+        vector<uint32_t> index_chunk_sizes;
+        vector<uint32_t> vertex_chunk_sizes;
+        vector<byte> encoded;
+        meshoptimizer::encode(m_vertices, m_indices, &index_chunk_sizes, &vertex_chunk_sizes, &encoded);
+
+        stream->Write(BoundingBox(m_vertices.data(), static_cast<uint32_t>(m_vertices.size())));
+        stream->Write(static_cast<uint32_t>(m_indices.size()));
+        stream->Write(static_cast<uint32_t>(m_vertices.size()));
+        stream->Write(index_chunk_sizes);
+        stream->Write(vertex_chunk_sizes);
+        stream->Write(static_cast<uint64_t>(encoded.size()));
+        stream->WriteBytes(encoded.data(), encoded.size());
+    }
+
+    bool Mesh::ReadGeometry(FileStream* stream)
+    {
+        stream->Read(&m_aabb);
+        m_indices.resize(stream->ReadAs<uint32_t>());
+        m_vertices.resize(stream->ReadAs<uint32_t>());
+
+        vector<uint32_t> index_chunk_sizes;
+        vector<uint32_t> vertex_chunk_sizes;
+        stream->Read(&index_chunk_sizes);
+        stream->Read(&vertex_chunk_sizes);
+        const uint64_t encoded_size = stream->ReadAs<uint64_t>();
+        const byte* encoded         = stream->ReadBytes(encoded_size);
+
+        const Stopwatch timer;
+        if (!encoded || !meshoptimizer::decode(encoded, encoded_size, index_chunk_sizes, vertex_chunk_sizes, &m_vertices, &m_indices))
+        {
+            Clear();
+            return false;
+        }
+
+        const double decode_ms = timer.GetElapsedTimeMs();
+        const double raw_mb    = GetMemoryUsage() / (1024.0 * 1024.0);
+        SP_LOG_INFO("Geometry of \"%s\": %.1f MB encoded to %.1f MB, decoded in %.1f ms (%.0f MB/s)",
+            m_object_name.c_str(), raw_mb, encoded_size / (1024.0 * 1024.0), decode_ms, decode_ms != 0.0 ? raw_mb / (decode_ms / 1000.0) : 0.0);
+
+        return true;
+    }
+
     uint32_t Mesh::GetMemoryUsage() const
     {
         uint32_t size = 0;
@@ -312,6 +461,15 @@ namespace Spartan
     }
 
     void Mesh::CreateGpuBuffers()
+    {
+        // the resource cache will call UploadToGpu() from the main thread
+        if (m_defer_gpu_upload)
+            return;
+
+        UploadToGpu();
+    }
+
+    void Mesh::UploadToGpu()
     {
         m_vertex_buffer = make_shared<RHI_Buffer>(RHI_Buffer_Type::Vertex,
             sizeof(m_vertices[0]),
@@ -328,6 +486,10 @@ namespace Spartan
             false,
             (string("mesh_index_buffer_") + m_object_name).c_str()
         );
+
+        // compute memory usage
+        m_object_size  = m_vertex_buffer->GetObjectSize();
+        m_object_size += m_index_buffer->GetObjectSize();
     }
 
     void Mesh::PostProcess()
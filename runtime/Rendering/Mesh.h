@@ -32,6 +32,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    class FileStream;
+
     enum class MeshFlags : uint32_t
     {
         ImportRemoveRedundantData = 1 << 0,
@@ -62,6 +64,7 @@ namespace Spartan
         // iresource
         void LoadFromFile(const std::string& file_path) override;
         void SaveToFile(const std::string& file_path) override;
+        void UploadToGpu() override;
 
         // geometry
         void Clear();
@@ -75,6 +78,10 @@ namespace Spartan
         );
         uint32_t GetMemoryUsage() const;
 
+        // encoded geometry (and its bounding box), as stored in .model files
+        void WriteGeometry(FileStream* stream);
+        bool ReadGeometry(FileStream* stream);
+
         // add geometry
         void AddVertices(const std::vector<RHI_Vertex_PosTexNorTan>& vertices, uint32_t* vertex_offset_out = nullptr);
         void AddIndices(const std::vector<uint32_t>& indices, uint32_t* index_offset_out = nullptr);
@@ -90,7 +97,7 @@ namespace Spartan
         // aabb
         const Math::BoundingBox& GetAabb() const { return m_aabb; }
 
-        // gpu buffers
+        // gpu buffers, deferred to UploadToGpu() when loading asynchronously
         void CreateGpuBuffers();
         RHI_Buffer* GetIndexBuffer()  { return m_index_buffer.get();  }
         RHI_Buffer* GetVertexBuffer() { return m_vertex_buffer.get(); }
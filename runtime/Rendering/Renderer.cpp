@@ -66,6 +66,8 @@ namespace Spartan
     atomic<bool> Renderer::m_initialized_third_party              = false;
     atomic<uint32_t> Renderer::m_environment_mips_to_filter_count = 0;
     unordered_map<Renderer_Entity, vector<shared_ptr<Entity>>> Renderer::m_renderables;
+    unordered_map<const Entity*, shared_ptr<Entity>> Renderer::m_renderables_meshes;
+    vector<shared_ptr<Entity>> Renderer::m_renderables_visible;
     mutex Renderer::m_mutex_renderables;
 
     namespace
@@ -81,9 +83,128 @@ namespace Spartan
 
         // bindless
         static array<RHI_Texture*, rhi_max_array_size> bindless_textures;
-        bool bindless_materials_dirty = true;
+        static array<Sb_Material, rhi_max_array_size> bindless_material_properties; // mapped to the gpu as a structured properties buffer
+        bool bindless_materials_dirty = true; // every slot needs to be written
         bool bindless_lights_dirty    = true;
 
+        // every material that's used by a renderable mesh owns a slot for as long as it's in use, so that
+        // changes to the render list or to a single material only have to write the affected slots
+        struct bindless_material
+        {
+            Material* material = nullptr;
+            uint32_t slot      = 0;
+            uint32_t ref_count = 0;
+        };
+        const uint32_t bindless_material_stride = static_cast<uint32_t>(MaterialTextureType::Max) * Material::slots_per_texture_type;
+        unordered_map<uint64_t, bindless_material> bindless_materials;   // material id -> slot
+        unordered_map<uint64_t, uint64_t> bindless_material_per_entity; // entity id -> material id
+        vector<Material*> bindless_material_slots;                        // slot -> material, null if free
+        vector<uint32_t> bindless_material_slots_free;
+        set<uint32_t> bindless_material_slots_dirty;
+
+        // meshes which can't be rendered yet (still loading or invisible), they are checked again every frame
+        vector<shared_ptr<Entity>> renderables_pending;
+
+        void bindless_material_acquire(Material* material, const uint64_t entity_id)
+        {
+            bindless_material& entry = bindless_materials[material->GetObjectId()];
+            if (entry.ref_count++ == 0)
+            {
+                if (bindless_material_slots_free.empty())
+                {
+                    entry.slot = static_cast<uint32_t>(bindless_material_slots.size());
+                    bindless_material_slots.emplace_back(nullptr);
+                }
+                else
+                {
+                    entry.slot = bindless_material_slots_free.back();
+                    bindless_material_slots_free.pop_back();
+                }
+                SP_ASSERT((entry.slot + 1) * bindless_material_stride <= rhi_max_array_size);
+
+                entry.material                       = material;
+                bindless_material_slots[entry.slot] = material;
+                bindless_material_slots_dirty.insert(entry.slot);
+                material->SetIndex(entry.slot * bindless_material_stride);
+            }
+
+            bindless_material_per_entity[entity_id] = material->GetObjectId();
+        }
+
+        void bindless_material_release(const uint64_t entity_id)
+        {
+            auto it_entity = bindless_material_per_entity.find(entity_id);
+            if (it_entity == bindless_material_per_entity.end())
+                return;
+
+            auto it = bindless_materials.find(it_entity->second);
+            bindless_material_per_entity.erase(it_entity);
+            if (it == bindless_materials.end() || --it->second.ref_count != 0)
+                return;
+
+            bindless_material_slots[it->second.slot] = nullptr;
+            bindless_material_slots_free.emplace_back(it->second.slot);
+            bindless_material_slots_dirty.insert(it->second.slot);
+            bindless_materials.erase(it);
+        }
+
+        void bindless_material_reset()
+        {
+            bindless_materials.clear();
+            bindless_material_per_entity.clear();
+            bindless_material_slots.clear();
+            bindless_material_slots_free.clear();
+            bindless_material_slots_dirty.clear();
+            bindless_materials_dirty = true;
+        }
+
+        bool is_renderable_ready(const shared_ptr<Renderable>& renderable)
+        {
+            // a mesh can be uninitialized if it's currently loading in a different thread
+            Material* material = renderable->GetMaterial();
+            return material && material->IsVisible() && renderable->GetVertexBuffer() && renderable->GetIndexBuffer();
+        }
+
+        // returns true if the entity was added to the light list
+        bool add_entity(unordered_map<Renderer_Entity, vector<shared_ptr<Entity>>>& renderables, unordered_map<const Entity*, shared_ptr<Entity>>& meshes, const shared_ptr<Entity>& entity)
+        {
+            if (!entity->IsActive())
+                return false;
+
+            if (shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>())
+            {
+                if (is_renderable_ready(renderable))
+                {
+                    renderables[Renderer_Entity::Mesh].emplace_back(entity);
+                    meshes[entity.get()] = entity;
+                    renderable->SetFlag(RenderableFlags::OccludedCpu, true); // until the visibility pass finds it
+                    bindless_material_acquire(renderable->GetMaterial(), entity->GetObjectId());
+                }
+                else
+                {
+                    renderables_pending.emplace_back(entity);
+                }
+            }
+
+            if (shared_ptr<Camera> camera = entity->GetComponent<Camera>())
+            {
+                renderables[Renderer_Entity::Camera].emplace_back(entity);
+            }
+
+            if (shared_ptr<AudioSource> audio_source = entity->GetComponent<AudioSource>())
+            {
+                renderables[Renderer_Entity::AudioSource].emplace_back(entity);
+            }
+
+            if (shared_ptr<Light> light = entity->GetComponent<Light>())
+            {
+                renderables[Renderer_Entity::Light].emplace_back(entity);
+                return true;
+            }
+
+            return false;
+        }
+
         // misc
         unordered_map<Renderer_Option, float> m_options;
         uint64_t frame_num                   = 0;
@@ -217,7 +338,7 @@ namespace Spartan
             // subscribe
             SP_SUBSCRIBE_TO_EVENT(EventType::WorldClear,              SP_EVENT_HANDLER_STATIC(OnClear));
             SP_SUBSCRIBE_TO_EVENT(EventType::WindowFullScreenToggled, SP_EVENT_HANDLER_STATIC(OnFullScreenToggled));
-            SP_SUBSCRIBE_TO_EVENT(EventType::MaterialOnChanged,       SP_EVENT_HANDLER_EXPRESSION_STATIC( bindless_materials_dirty = true; ));
+            SP_SUBSCRIBE_TO_EVENT(EventType::MaterialOnChanged,       SP_EVENT_HANDLER_VARIANT_STATIC(OnMaterialChanged));
             SP_SUBSCRIBE_TO_EVENT(EventType::LightOnChanged,          SP_EVENT_HANDLER_EXPRESSION_STATIC( bindless_lights_dirty    = true; ));
 
             // fire
@@ -258,6 +379,9 @@ namespace Spartan
 
     void Renderer::Shutdown()
     {
+        // pipelines from previous runs are created in the background with the renderer's shaders and render targets
+        RHI_Device::PipelineCacheCancelPrewarm();
+
         SP_FIRE_EVENT(EventType::RendererOnShutdown);
 
         // manually invoke the deconstructors so that ParseDeletionQueue()
@@ -266,6 +390,8 @@ namespace Spartan
             DestroyResources();
 
             m_renderables.clear();
+            m_renderables_meshes.clear();
+            m_renderables_visible.clear();
             swap_chain            = nullptr;
             m_vertex_buffer_lines = nullptr;
         }
@@ -289,6 +415,20 @@ namespace Spartan
                 SP_FIRE_EVENT(EventType::RendererOnFirstFrameCompleted);
             }
 
+            // pipelines that render to shadow maps are recorded and prewarmed against the lights' textures
+            {
+                vector<array<RHI_Texture*, 2>> light_textures;
+                lock_guard lock(m_mutex_renderables);
+                for (const shared_ptr<Entity>& entity : m_renderables[Renderer_Entity::Light])
+                {
+                    if (Light* light = entity->GetComponent<Light>().get())
+                    {
+                        light_textures.push_back({ light->GetDepthTexture(), light->GetColorTexture() });
+                    }
+                }
+                RHI_Device::PipelineCacheSetLightTextures(light_textures);
+            }
+
             RHI_Device::Tick(frame_num);
             RHI_FidelityFX::Tick(&m_cb_frame_cpu);
             dynamic_resolution();
@@ -489,48 +629,67 @@ namespace Spartan
 
         // clear previous state
         m_renderables.clear();
+        m_renderables_meshes.clear();
+        m_renderables_visible.clear();
+        renderables_pending.clear();
+        bindless_material_reset();
 
         for (auto it : entities)
         {
-            shared_ptr<Entity>& entity = it.second;
+            add_entity(m_renderables, m_renderables_meshes, it.second);
+        }
 
-            if (!entity->IsActive())
-                continue;
+        m_mutex_renderables.unlock();
+        bindless_materials_dirty = true;
+        bindless_lights_dirty    = true;
+    }
 
-            if (shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>())
-            {
-                if (Material* material = renderable->GetMaterial())
-                {
-                    if (material->IsVisible())
-                    {
-                        // a mesh can be uninitialized if it's currently loading in a different thread
-                        if (renderable->GetVertexBuffer() && renderable->GetIndexBuffer())
-                        { 
-                            m_renderables[Renderer_Entity::Mesh].emplace_back(entity);
-                        }
-                    }
-                }
-            }
+    void Renderer::UpdateEntities(const vector<shared_ptr<Entity>>& entities_changed, const vector<uint64_t>& entities_removed)
+    {
+        unordered_set<uint64_t> ids(entities_removed.begin(), entities_removed.end());
+        for (const shared_ptr<Entity>& entity : entities_changed)
+        {
+            ids.insert(entity->GetObjectId());
+        }
 
-            if (shared_ptr<Light> light = entity->GetComponent<Light>())
-            {
-                m_renderables[Renderer_Entity::Light].emplace_back(entity);
-            }
+        if (ids.empty())
+            return;
 
-            if (shared_ptr<Camera> camera = entity->GetComponent<Camera>())
-            {
-                m_renderables[Renderer_Entity::Camera].emplace_back(entity);
-            }
+        lock_guard lock(m_mutex_renderables);
 
-            if (shared_ptr<AudioSource> audio_source = entity->GetComponent<AudioSource>())
+        // take out every entity that changed, the ones which still qualify are added back below
+        auto is_affected = [&ids](const shared_ptr<Entity>& entity) { return ids.find(entity->GetObjectId()) != ids.end(); };
+        bool lights_changed = false;
+        for (const shared_ptr<Entity>& entity : m_renderables[Renderer_Entity::Mesh])
+        {
+            if (is_affected(entity))
             {
-                m_renderables[Renderer_Entity::AudioSource].emplace_back(entity);
+                m_renderables_meshes.erase(entity.get());
             }
         }
+        for (auto& it : m_renderables)
+        {
+            vector<shared_ptr<Entity>>& list = it.second;
+            size_t count_before              = list.size();
+            list.erase(remove_if(list.begin(), list.end(), is_affected), list.end());
+            lights_changed |= it.first == Renderer_Entity::Light && list.size() != count_before;
+        }
+        renderables_pending.erase(remove_if(renderables_pending.begin(), renderables_pending.end(), is_affected), renderables_pending.end());
 
-        m_mutex_renderables.unlock();
-        bindless_materials_dirty = true;
-        bindless_lights_dirty    = true;
+        for (const uint64_t id : ids)
+        {
+            bindless_material_release(id);
+        }
+
+        for (const shared_ptr<Entity>& entity : entities_changed)
+        {
+            lights_changed |= add_entity(m_renderables, m_renderables_meshes, entity);
+        }
+
+        if (lights_changed)
+        {
+            bindless_lights_dirty = true;
+        }
     }
 
     bool Renderer::CanUseCmdList()
@@ -541,7 +700,31 @@ namespace Spartan
 
     void Renderer::OnClear()
     {
+        lock_guard lock(m_mutex_renderables);
+
         m_renderables.clear();
+        m_renderables_meshes.clear();
+        m_renderables_visible.clear();
+        renderables_pending.clear();
+        bindless_material_reset();
+    }
+
+    void Renderer::OnMaterialChanged(const sp_variant& data)
+    {
+        // the event carries the id of the material that changed, or nothing if the change can't be attributed
+        uint64_t material_id = holds_alternative<uint64_t>(data) ? get<uint64_t>(data) : 0;
+        if (material_id == 0)
+        {
+            bindless_materials_dirty = true;
+            return;
+        }
+
+        lock_guard lock(m_mutex_renderables);
+        auto it = bindless_materials.find(material_id);
+        if (it != bindless_materials.end())
+        {
+            bindless_material_slots_dirty.insert(it->second.slot);
+        }
     }
 
     void Renderer::OnFullScreenToggled()
@@ -596,11 +779,34 @@ namespace Spartan
             }
         }
 
-        if (bindless_materials_dirty)
+        // meshes that were still loading might be ready now
+        if (!renderables_pending.empty())
+        {
+            lock_guard lock(m_mutex_renderables);
+
+            auto is_ready = [](const shared_ptr<Entity>& entity)
+            {
+                shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
+                return !renderable || is_renderable_ready(renderable);
+            };
+
+            auto it_ready = partition(renderables_pending.begin(), renderables_pending.end(), [&is_ready](const shared_ptr<Entity>& entity) { return !is_ready(entity); });
+            for (auto it = it_ready; it != renderables_pending.end(); it++)
+            {
+                if (shared_ptr<Renderable> renderable = (*it)->GetComponent<Renderable>())
+                {
+                    m_renderables[Renderer_Entity::Mesh].emplace_back(*it);
+                    m_renderables_meshes[it->get()] = *it;
+                    renderable->SetFlag(RenderableFlags::OccludedCpu, true); // until the visibility pass finds it
+                    bindless_material_acquire(renderable->GetMaterial(), (*it)->GetObjectId());
+                }
+            }
+            renderables_pending.erase(it_ready, renderables_pending.end());
+        }
+
+        if (bindless_materials_dirty || !bindless_material_slots_dirty.empty())
         {
-            BindlessUpdateMaterials(cmd_list);                                // properties
-            RHI_Device::UpdateBindlessResources(nullptr, &bindless_textures); // textures
-            bindless_materials_dirty = false;
+            BindlessUpdateMaterials(cmd_list); // properties and textures
         }
 
         if (bindless_lights_dirty)
@@ -739,7 +945,7 @@ namespace Spartan
             }
             else if (option == Renderer_Option::FogVolumetric || option == Renderer_Option::ScreenSpaceShadows)
             {
-                SP_FIRE_EVENT(EventType::LightOnChanged);
+                SP_FIRE_EVENT_DEFERRED(EventType::LightOnChanged);
             }
             else if (option == Renderer_Option::PerformanceMetrics)
             {
@@ -852,61 +1058,65 @@ namespace Spartan
     
     void Renderer::BindlessUpdateMaterials(RHI_CommandList* cmd_list)
     {
-        static array<Sb_Material, rhi_max_array_size> properties; // mapped to the gpu as a structured properties buffer
-        static unordered_set<uint64_t> unique_material_ids;
-        static uint32_t index = 0;
-    
-        auto update_material = [](Material* material)
+        // the dirty state is kept, so that whatever changed while loading is written once loading is done
+        if (ProgressTracker::IsLoading())
+            return;
+
+        lock_guard lock(m_mutex_renderables);
+
+        auto update_slot = [](const uint32_t slot)
         {
-            // check if the material's ID is already processed
-            if (unique_material_ids.find(material->GetObjectId()) != unique_material_ids.end())
+            uint32_t index     = slot * bindless_material_stride;
+            Material* material = slot < bindless_material_slots.size() ? bindless_material_slots[slot] : nullptr;
+            if (!material)
+            {
+                bindless_material_properties[index] = Sb_Material{};
+                fill_n(bindless_textures.begin() + index, bindless_material_stride, nullptr);
                 return;
-    
-            // if not, add it to the list
-            unique_material_ids.insert(material->GetObjectId());
-    
+            }
+
             // properties
             {
-                SP_ASSERT(index < rhi_max_array_size);
-    
-                properties[index].world_space_height     = material->GetProperty(MaterialProperty::WorldSpaceHeight);
-                properties[index].color.x                = material->GetProperty(MaterialProperty::ColorR);
-                properties[index].color.y                = material->GetProperty(MaterialProperty::ColorG);
-                properties[index].color.z                = material->GetProperty(MaterialProperty::ColorB);
-                properties[index].color.w                = material->GetProperty(MaterialProperty::ColorA);
-                properties[index].tiling_uv.x            = material->GetProperty(MaterialProperty::TextureTilingX);
-                properties[index].tiling_uv.y            = material->GetProperty(MaterialProperty::TextureTilingY);
-                properties[index].offset_uv.x            = material->GetProperty(MaterialProperty::TextureOffsetX);
-                properties[index].offset_uv.y            = material->GetProperty(MaterialProperty::TextureOffsetY);
-                properties[index].roughness_mul          = material->GetProperty(MaterialProperty::Roughness);
-                properties[index].metallic_mul           = material->GetProperty(MaterialProperty::Metalness);
-                properties[index].normal_mul             = material->GetProperty(MaterialProperty::Normal);
-                properties[index].height_mul             = material->GetProperty(MaterialProperty::Height);
-                properties[index].anisotropic            = material->GetProperty(MaterialProperty::Anisotropic);
-                properties[index].anisotropic_rotation   = material->GetProperty(MaterialProperty::AnisotropicRotation);
-                properties[index].clearcoat              = material->GetProperty(MaterialProperty::Clearcoat);
-                properties[index].clearcoat_roughness    = material->GetProperty(MaterialProperty::Clearcoat_Roughness);
-                properties[index].sheen                  = material->GetProperty(MaterialProperty::Sheen);
-                properties[index].sheen_tint             = material->GetProperty(MaterialProperty::SheenTint);
-                properties[index].subsurface_scattering  = material->GetProperty(MaterialProperty::SubsurfaceScattering);
-                properties[index].ior                    = material->GetProperty(MaterialProperty::Ior);
-              
+                Sb_Material& properties = bindless_material_properties[index];
+
+                properties.world_space_height     = material->GetProperty(MaterialProperty::WorldSpaceHeight);
+                properties.color.x                = material->GetProperty(MaterialProperty::ColorR);
+                properties.color.y                = material->GetProperty(MaterialProperty::ColorG);
+                properties.color.z                = material->GetProperty(MaterialProperty::ColorB);
+                properties.color.w                = material->GetProperty(MaterialProperty::ColorA);
+                properties.tiling_uv.x            = material->GetProperty(MaterialProperty::TextureTilingX);
+                properties.tiling_uv.y            = material->GetProperty(MaterialProperty::TextureTilingY);
+                properties.offset_uv.x            = material->GetProperty(MaterialProperty::TextureOffsetX);
+                properties.offset_uv.y            = material->GetProperty(MaterialProperty::TextureOffsetY);
+                properties.roughness_mul          = material->GetProperty(MaterialProperty::Roughness);
+                properties.metallic_mul           = material->GetProperty(MaterialProperty::Metalness);
+                properties.normal_mul             = material->GetProperty(MaterialProperty::Normal);
+                properties.height_mul             = material->GetProperty(MaterialProperty::Height);
+                properties.anisotropic            = material->GetProperty(MaterialProperty::Anisotropic);
+                properties.anisotropic_rotation   = material->GetProperty(MaterialProperty::AnisotropicRotation);
+                properties.clearcoat              = material->GetProperty(MaterialProperty::Clearcoat);
+                properties.clearcoat_roughness    = material->GetProperty(MaterialProperty::Clearcoat_Roughness);
+                properties.sheen                  = material->GetProperty(MaterialProperty::Sheen);
+                properties.sheen_tint             = material->GetProperty(MaterialProperty::SheenTint);
+                properties.subsurface_scattering  = material->GetProperty(MaterialProperty::SubsurfaceScattering);
+                properties.ior                    = material->GetProperty(MaterialProperty::Ior);
+
                 // flags
-                properties[index].flags  = material->HasTextureOfType(MaterialTextureType::Height)     ? (1U << 0)  : 0;
-                properties[index].flags |= material->HasTextureOfType(MaterialTextureType::Normal)     ? (1U << 1)  : 0;
-                properties[index].flags |= material->HasTextureOfType(MaterialTextureType::Color)      ? (1U << 2)  : 0;
-                properties[index].flags |= material->HasTextureOfType(MaterialTextureType::Roughness)  ? (1U << 3)  : 0;
-                properties[index].flags |= material->HasTextureOfType(MaterialTextureType::Metalness)  ? (1U << 4)  : 0;
-                properties[index].flags |= material->HasTextureOfType(MaterialTextureType::AlphaMask)  ? (1U << 5)  : 0;
-                properties[index].flags |= material->HasTextureOfType(MaterialTextureType::Emission)   ? (1U << 6)  : 0;
-                properties[index].flags |= material->HasTextureOfType(MaterialTextureType::Occlusion)  ? (1U << 7)  : 0;
-                properties[index].flags |= material->GetProperty(MaterialProperty::TextureSlopeBased)  ? (1U << 8)  : 0;
-                properties[index].flags |= material->GetProperty(MaterialProperty::VertexAnimateWind)  ? (1U << 9) : 0;
-                properties[index].flags |= material->GetProperty(MaterialProperty::VertexAnimateWater) ? (1U << 10) : 0;
-                properties[index].flags |= material->IsTessellated()                                   ? (1U << 11) : 0;
+                properties.flags  = material->HasTextureOfType(MaterialTextureType::Height)     ? (1U << 0)  : 0;
+                properties.flags |= material->HasTextureOfType(MaterialTextureType::Normal)     ? (1U << 1)  : 0;
+                properties.flags |= material->HasTextureOfType(MaterialTextureType::Color)      ? (1U << 2)  : 0;
+                properties.flags |= material->HasTextureOfType(MaterialTextureType::Roughness)  ? (1U << 3)  : 0;
+                properties.flags |= material->HasTextureOfType(MaterialTextureType::Metalness)  ? (1U << 4)  : 0;
+                properties.flags |= material->HasTextureOfType(MaterialTextureType::AlphaMask)  ? (1U << 5)  : 0;
+                properties.flags |= material->HasTextureOfType(MaterialTextureType::Emission)   ? (1U << 6)  : 0;
+                properties.flags |= material->HasTextureOfType(MaterialTextureType::Occlusion)  ? (1U << 7)  : 0;
+                properties.flags |= material->GetProperty(MaterialProperty::TextureSlopeBased)  ? (1U << 8)  : 0;
+                properties.flags |= material->GetProperty(MaterialProperty::VertexAnimateWind)  ? (1U << 9) : 0;
+                properties.flags |= material->GetProperty(MaterialProperty::VertexAnimateWater) ? (1U << 10) : 0;
+                properties.flags |= material->IsTessellated()                                   ? (1U << 11) : 0;
                 // when changing the bit flags, ensure that you also update the Surface struct in common_structs.hlsl, so that it reads those flags as expected
             }
-    
+
             // textures
             {
                 // iterate through all texture types and their slots
@@ -916,59 +1126,57 @@ namespace Spartan
                     {
                         // calculate the final index in the bindless array
                         uint32_t bindless_index = index + (type * Material::slots_per_texture_type) + slot;
-                        
+
                         // get the texture from the material using type and slot
                         bindless_textures[bindless_index] = material->GetTexture(static_cast<MaterialTextureType>(type), slot);
                     }
                 }
             }
-    
-            material->SetIndex(index);
 
-            // update index increment to account for all texture slots
-            index += static_cast<uint32_t>(MaterialTextureType::Max) * Material::slots_per_texture_type;
+            material->SetIndex(index);
         };
-    
-        auto update_entities = [update_material](vector<shared_ptr<Entity>>& entities)
+
+        // cpu, only the dirty slots are written, unless everything is dirty
+        uint32_t slot_first = 0;
+        uint32_t slot_last  = 0;
+        if (bindless_materials_dirty)
         {
-            for (shared_ptr<Entity> entity : entities)
+            bindless_material_properties.fill(Sb_Material{});
+            bindless_textures.fill(nullptr);
+
+            uint32_t slot_count = static_cast<uint32_t>(bindless_material_slots.size());
+            for (uint32_t slot = 0; slot < slot_count; slot++)
             {
-                if (entity)
-                {
-                    if (shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>())
-                    {
-                        if (Material* material = renderable->GetMaterial())
-                        {
-                            update_material(material);
-                        }
-                    }
-                }
+                update_slot(slot);
             }
-        };
-    
-        if (ProgressTracker::IsLoading())
-            return;
-    
-        lock_guard lock(m_mutex_renderables);
-    
-        // cpu
+
+            slot_last = max(slot_count, 1u) - 1;
+        }
+        else
         {
-            // clear
-            properties.fill(Sb_Material{});
-            bindless_textures.fill(nullptr);
-            unique_material_ids.clear();
-            update_entities(m_renderables[Renderer_Entity::Mesh]);
+            for (const uint32_t slot : bindless_material_slots_dirty)
+            {
+                update_slot(slot);
+            }
+
+            slot_first = *bindless_material_slots_dirty.begin();
+            slot_last  = *bindless_material_slots_dirty.rbegin();
         }
-    
-        // gpu
+        bindless_materials_dirty = false;
+        bindless_material_slots_dirty.clear();
+
+        // gpu, the range that covers the dirty slots
         {
+            uint32_t index_first = slot_first * bindless_material_stride;
+            uint32_t index_count = (slot_last - slot_first + 1) * bindless_material_stride;
+
             // material properties
-            Renderer::GetBuffer(Renderer_Buffer::StorageMaterials)->ResetOffset();
-            uint32_t update_size = static_cast<uint32_t>(sizeof(Sb_Material)) * index;
-            Renderer::GetBuffer(Renderer_Buffer::StorageMaterials)->Update(cmd_list, &properties[0], update_size);
-        }
+            uint32_t property_count = (slot_last - slot_first) * bindless_material_stride + 1;
+            cmd_list->UpdateBuffer(Renderer::GetBuffer(Renderer_Buffer::StorageMaterials), index_first * sizeof(Sb_Material), property_count * sizeof(Sb_Material), &bindless_material_properties[index_first]);
 
-        index = 0;
+            // textures
+            RHI_Device::UpdateBindlessResources(nullptr, &bindless_textures, index_first, index_count);
+        }
     }
 
     void Renderer::BindlessUpdateLights(RHI_CommandList* cmd_list)
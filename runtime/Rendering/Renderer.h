@@ -29,6 +29,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Mesh.h"
 #include "Renderer_Buffers.h"
 #include "Font/Font.h"
+#include "../Core/Event.h"
 #include <unordered_map>
 #include <atomic>
 //===============================
@@ -82,6 +83,7 @@ namespace Spartan
         static RHI_Api_Type GetRhiApiType();
         static void Screenshot(const std::string& file_path);
         static void SetEntities(std::unordered_map<uint64_t, std::shared_ptr<Entity>>& entities);
+        static void UpdateEntities(const std::vector<std::shared_ptr<Entity>>& entities_changed, const std::vector<uint64_t>& entities_removed);
         static bool CanUseCmdList();
 
         //= RESOLUTION/SIZE =============================================================================
@@ -180,6 +182,7 @@ namespace Spartan
 
         // event handlers
         static void OnClear();
+        static void OnMaterialChanged(const sp_variant& data);
         static void OnFullScreenToggled();
         static void OnUpdateBuffers(RHI_CommandList* cmd_list);
 
@@ -194,6 +197,8 @@ namespace Spartan
 
         // misc
         static std::unordered_map<Renderer_Entity, std::vector<std::shared_ptr<Entity>>> m_renderables;
+        static std::unordered_map<const Entity*, std::shared_ptr<Entity>> m_renderables_meshes; // m_renderables[Renderer_Entity::Mesh] by address, to match world queries against
+        static std::vector<std::shared_ptr<Entity>> m_renderables_visible;                      // the meshes inside the view frustum, sorted by the visibility pass
         static Cb_Frame m_cb_frame_cpu;
         static Pcb_Pass m_pcb_pass_cpu;
         static std::shared_ptr<RHI_Buffer> m_vertex_buffer_lines;
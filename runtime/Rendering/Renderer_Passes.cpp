@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include "Renderer.h"
 #include "../Profiling/Profiler.h"
+#include "../Core/FrameAllocator.h"
 #include "../World/Entity.h"
 #include "../World/Components/Camera.h"
 #include "../World/Components/Light.h"
@@ -49,6 +50,7 @@ namespace Spartan
     namespace
     {
         bool light_integration_brdf_speculat_lut_completed = false;
+        bool shadow_casters_transparent                    = false;
         int64_t mesh_index_transparent                     = 0;
         int64_t mesh_index_non_instanced_transparent       = 0;
 
@@ -56,15 +58,16 @@ namespace Spartan
 
         namespace visibility
         {
-            unordered_map<uint64_t, float> distances_squared;
-            unordered_map<uint64_t, Rectangle> rectangles;
-            unordered_map<uint64_t, BoundingBox> boxes;
+            // rebuilt every frame, so they live in the frame allocator
+            frame_unordered_map<uint64_t, float>* distances_squared = nullptr;
+            frame_unordered_map<uint64_t, Rectangle>* rectangles    = nullptr;
+            frame_unordered_map<uint64_t, BoundingBox>* boxes       = nullptr;
 
             void clear()
             {
-                distances_squared.clear();
-                rectangles.clear();
-                boxes.clear();
+                distances_squared = FrameAllocator::New<frame_unordered_map<uint64_t, float>>();
+                rectangles        = FrameAllocator::New<frame_unordered_map<uint64_t, Rectangle>>();
+                boxes             = FrameAllocator::New<frame_unordered_map<uint64_t, BoundingBox>>();
             }
 
             float get_squared_distance(const shared_ptr<Entity>& entity)
@@ -72,8 +75,8 @@ namespace Spartan
                 Vector3 camera_position = Renderer::GetCamera()->GetEntity()->GetPosition();
                 uint64_t entity_id      = entity->GetObjectId();
 
-                auto it = distances_squared.find(entity_id);
-                if (it != distances_squared.end())
+                auto it = distances_squared->find(entity_id);
+                if (it != distances_squared->end())
                 {
                     return it->second;
                 }
@@ -82,19 +85,39 @@ namespace Spartan
                     shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
                     Vector3 position                  = renderable->GetBoundingBox(BoundingBoxType::Transformed).GetCenter();
                     float distance_squared            = (position - camera_position).LengthSquared();
-                    distances_squared[entity_id]      = distance_squared;
+                    (*distances_squared)[entity_id]   = distance_squared;
 
                     return distance_squared;
                 }
             }
 
-            void frustum_culling(vector<shared_ptr<Entity>>& renderables)
+            void frustum_culling(const unordered_map<const Entity*, shared_ptr<Entity>>& meshes, vector<shared_ptr<Entity>>& visible)
             {
-                for (shared_ptr<Entity>& entity : renderables)
+                // what was visible last frame is assumed to be outside of the view frustum
+                for (shared_ptr<Entity>& entity : visible)
                 {
-                    shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
-                    renderable->SetFlag(RenderableFlags::OccludedCpu, !Renderer::GetCamera()->IsInViewFrustum(renderable));
-                    renderable->SetFlag(RenderableFlags::Occluder, false);
+                    if (shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>())
+                    {
+                        renderable->SetFlag(RenderableFlags::OccludedCpu, true);
+                        renderable->SetFlag(RenderableFlags::OccludedGpu, false); // its query result is stale by the time it's back in view
+                        renderable->SetFlag(RenderableFlags::Occluder, false);
+                    }
+                }
+                visible.clear();
+
+                // and let the bounding volume hierarchy of the world find what's inside, so the cost scales with what's visible
+                for (Entity* entity : World::Query(Renderer::GetCamera()->GetFrustum()))
+                {
+                    // skip what the renderer doesn't draw (yet), e.g. meshes that are still loading
+                    auto it = meshes.find(entity);
+                    if (it == meshes.end())
+                        continue;
+
+                    if (shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>())
+                    {
+                        renderable->SetFlag(RenderableFlags::OccludedCpu, false);
+                        visible.emplace_back(it->second);
+                    }
                 }
             }
 
@@ -103,10 +126,6 @@ namespace Spartan
                 // 1. sort by depth
                 sort(renderables.begin(), renderables.end(), [](const shared_ptr<Entity>& a, const shared_ptr<Entity>& b)
                 {
-                    // skip entities which are outside of the view frustum
-                    if (a->GetComponent<Renderable>()->HasFlag(OccludedCpu) || b->GetComponent<Renderable>()->HasFlag(OccludedCpu))
-                        return false;
-                    
                     // front-to-back for opaque (todo, handle inverse sorting for transparents)
                     return get_squared_distance(a) < get_squared_distance(b);
                 });
@@ -128,13 +147,13 @@ namespace Spartan
                 });
             }
 
-            void frustum_cull_and_sort(vector<shared_ptr<Entity>>& renderables)
+            void frustum_cull_and_sort(const unordered_map<const Entity*, shared_ptr<Entity>>& meshes, vector<shared_ptr<Entity>>& visible)
             {
-                frustum_culling(renderables);
-                sort(renderables);
+                frustum_culling(meshes, visible);
+                sort(visible);
 
                 // find transparent index
-                auto transparent_start = find_if(renderables.begin(), renderables.end(), [](const shared_ptr<Entity>& entity)
+                auto transparent_start = find_if(visible.begin(), visible.end(), [](const shared_ptr<Entity>& entity)
                 {
                     Material* material = entity->GetComponent<Renderable>()->GetMaterial();
                     bool is_transparent = material->IsTransparent();
@@ -142,17 +161,17 @@ namespace Spartan
                 });
 
                 // check if any transparent object was found
-                if (transparent_start == renderables.end())
+                if (transparent_start == visible.end())
                 {
                     mesh_index_transparent = -1;
                 }
                 else
                 {
-                    mesh_index_transparent = distance(renderables.begin(), transparent_start);
+                    mesh_index_transparent = distance(visible.begin(), transparent_start);
                 }
 
                 // find non-instanced index for opaque objects
-                auto non_instanced_opaque_start = find_if(renderables.begin(), renderables.end(), [&](const shared_ptr<Entity>& entity)
+                auto non_instanced_opaque_start = find_if(visible.begin(), visible.end(), [&](const shared_ptr<Entity>& entity)
                 {
                     shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
                     bool is_transparent               = renderable->GetMaterial()->IsTransparent();
@@ -161,36 +180,36 @@ namespace Spartan
                 });
 
                 // find non-instanced index for transparent objects
-                auto non_instanced_transparent_start = find_if(transparent_start, renderables.end(), [&](const shared_ptr<Entity>& entity)
+                auto non_instanced_transparent_start = find_if(transparent_start, visible.end(), [&](const shared_ptr<Entity>& entity)
                 {
                     return !entity->GetComponent<Renderable>()->HasInstancing();
                 });
 
                 // check if any non-instanced transparent object was found
-                if (non_instanced_transparent_start == renderables.end())
+                if (non_instanced_transparent_start == visible.end())
                 {
                     mesh_index_non_instanced_transparent = -1;
                 }
                 else
                 {
-                    mesh_index_non_instanced_transparent = distance(renderables.begin(), non_instanced_transparent_start);
+                    mesh_index_non_instanced_transparent = distance(visible.begin(), non_instanced_transparent_start);
                 }
             }
 
-            void determine_occluders(vector<shared_ptr<Entity>>& renderables)
+            void determine_occluders(vector<shared_ptr<Entity>>& visible)
             {
                 uint32_t occluder_count = 0;
-                for (shared_ptr<Entity>& entity : renderables)
+                for (shared_ptr<Entity>& entity : visible)
                 {
                     shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
-                    if (!renderable || renderable->HasFlag(RenderableFlags::OccludedCpu))
+                    if (!renderable)
                         continue;
 
                     // compute screen space rectangle
-                    BoundingBox box                   = renderable->GetBoundingBox(BoundingBoxType::Transformed);
-                    Rectangle rectangle               = Renderer::GetCamera()->WorldToScreenCoordinates(box);
-                    boxes[entity->GetObjectId()]      = box;
-                    rectangles[entity->GetObjectId()] = rectangle;
+                    BoundingBox box                      = renderable->GetBoundingBox(BoundingBoxType::Transformed);
+                    Rectangle rectangle                  = Renderer::GetCamera()->WorldToScreenCoordinates(box);
+                    (*boxes)[entity->GetObjectId()]      = box;
+                    (*rectangles)[entity->GetObjectId()] = rectangle;
 
                     bool factor_screen_size = rectangle.Area() >= 65536.0f;
                     bool factor_inside      = box.Contains(Renderer::GetCamera()->GetEntity()->GetPosition()); // say we are in a building
@@ -221,8 +240,8 @@ namespace Spartan
                     if (renderable_occluder->HasFlag(Occluder))
                     {
                         // project world space axis-aligned bounding boxes into screen space
-                        Rectangle& rectangle_occludee = rectangles[entity_occludee->GetObjectId()];
-                        Rectangle& rectangle_occluder = rectangles[entity_occluder->GetObjectId()];
+                        Rectangle& rectangle_occludee = (*rectangles)[entity_occludee->GetObjectId()];
+                        Rectangle& rectangle_occluder = (*rectangles)[entity_occluder->GetObjectId()];
 
                         // if it's contained by at least one occluder, it's not visible
                         if (rectangle_occluder.Contains(rectangle_occludee))
@@ -245,33 +264,24 @@ namespace Spartan
                 }
             }
 
-            void get_gpu_occlusion_query_results(RHI_CommandList* cmd_list, unordered_map<Renderer_Entity, vector<shared_ptr<Entity>>>& renderables)
+            void get_gpu_occlusion_query_results(RHI_CommandList* cmd_list, vector<shared_ptr<Entity>>& visible)
             {
                 cmd_list->UpdateOcclusionQueries();
 
-                bool is_transparent_pass = false;
-                uint32_t start_index     = !is_transparent_pass ? 0 : 2;
-                uint32_t end_index       = !is_transparent_pass ? 2 : 4;
-                for (uint32_t i = start_index; i < end_index; i++)
+                // only what's in the view frustum was queried
+                for (shared_ptr<Entity>& entity : visible)
                 {
-                    auto& entities = renderables[static_cast<Renderer_Entity>(i)];
-                    if (entities.empty())
+                    shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
+                    if (!renderable)
                         continue;
 
-                    for (shared_ptr<Entity>& entity : entities)
-                    {
-                        shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
-                        if (!renderable)
-                            continue;
-
-                        bool occluded = cmd_list->GetOcclusionQueryResult(entity->GetObjectId());
-                        renderable->SetFlag(RenderableFlags::OccludedGpu, occluded);
+                    bool occluded = cmd_list->GetOcclusionQueryResult(entity->GetObjectId());
+                    renderable->SetFlag(RenderableFlags::OccludedGpu, occluded);
 
-                        // counter occlusion query latency by removing false gpu occlusions
-                        if (occluded)
-                        {
-                            remove_false_gpu_occlusion(entity, entities);
-                        }
+                    // counter occlusion query latency by removing false gpu occlusions
+                    if (occluded)
+                    {
+                        remove_false_gpu_occlusion(entity, visible);
                     }
                 }
             }
@@ -397,7 +407,7 @@ namespace Spartan
             // shadow maps
             {
                 Pass_ShadowMaps(cmd_list_graphics, false);
-                if (mesh_index_transparent != -1)
+                if (shadow_casters_transparent)
                 {
                     Pass_ShadowMaps(cmd_list_graphics, true);
                 }
@@ -497,6 +507,12 @@ namespace Spartan
         lock_guard lock(m_mutex_renderables);
         cmd_list->BeginTimeblock(is_transparent_pass ? "shadow_maps_alpha_color" : "shadow_maps_depth");
 
+        // the opaque pass finds out if the transparent one is needed
+        if (!is_transparent_pass)
+        {
+            shadow_casters_transparent = false;
+        }
+
         // set pso
         static RHI_PipelineState pso;
         pso.name                             = "shadow_maps_depth";
@@ -538,21 +554,30 @@ namespace Spartan
                 pso.render_target_array_index = array_index;
                 cmd_list->SetIgnoreClearValues(is_transparent_pass);
 
-                // iterate over entities
-                int64_t index_start = get_mesh_indices(m_renderables[Renderer_Entity::Mesh], is_transparent_pass, true);
-                int64_t index_end   = get_mesh_indices(m_renderables[Renderer_Entity::Mesh], is_transparent_pass, false);
-                for (int64_t i = index_start; i < index_end; i++)
+                // iterate over the entities inside the volume of the light, found by the bounding volume hierarchy of the world
+                frame_vector<Entity*> entities_in_light = light->GetLightType() == LightType::Point ?
+                    World::Query(Sphere(light_entity->GetPosition(), light->GetRange())) :
+                    World::Query(light->GetFrustum(array_index), light->GetLightType() == LightType::Directional);
+                for (Entity* entity_in_light : entities_in_light)
                 {
-                    // this can happen during async loading
-                    if (i >= static_cast<int64_t>(m_renderables[Renderer_Entity::Mesh].size()))
+                    // skip what the renderer doesn't draw (yet), e.g. meshes that are still loading
+                    auto it = m_renderables_meshes.find(entity_in_light);
+                    if (it == m_renderables_meshes.end())
                         continue;
 
-                    shared_ptr<Entity>& entity        = m_renderables[Renderer_Entity::Mesh][i];
+                    shared_ptr<Entity>& entity        = it->second;
                     shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
                     if (!renderable || !renderable->HasFlag(RenderableFlags::CastsShadows))
                         continue;
 
-                    if (!light->IsInViewFrustum(renderable.get(), array_index))
+                    // opaque and transparent casters are drawn by separate passes
+                    bool is_transparent         = renderable->GetMaterial()->IsTransparent();
+                    shadow_casters_transparent |= is_transparent;
+                    if (is_transparent != is_transparent_pass)
+                        continue;
+
+                    // paraboloids only cover one hemisphere each
+                    if (light->GetLightType() == LightType::Point && !light->IsInViewFrustum(renderable.get(), array_index))
                         continue;
 
                     cmd_list->SetCullMode(static_cast<RHI_CullMode>(renderable->GetMaterial()->GetProperty(MaterialProperty::CullMode)));
@@ -610,11 +635,12 @@ namespace Spartan
         cmd_list->BeginTimeblock("visibility", false, false);
 
         visibility::clear();
-        visibility::frustum_cull_and_sort(m_renderables[Renderer_Entity::Mesh]);
+        lock_guard lock(m_mutex_renderables);
+        visibility::frustum_cull_and_sort(m_renderables_meshes, m_renderables_visible);
 
         if (GetOption<bool>(Renderer_Option::OcclusionCulling))
         {
-            visibility::determine_occluders(m_renderables[Renderer_Entity::Mesh]);
+            visibility::determine_occluders(m_renderables_visible);
         }
 
         cmd_list->EndTimeblock();
@@ -637,17 +663,13 @@ namespace Spartan
         auto pass = [cmd_list, shader_h, shader_d, shader_p](RHI_PipelineState& pso, bool is_transparent_pass, bool is_back_face_pass)
         {
             bool set_pipeline   = true;
-            int64_t index_start = get_mesh_indices(m_renderables[Renderer_Entity::Mesh], is_transparent_pass, true);
-            int64_t index_end   = get_mesh_indices(m_renderables[Renderer_Entity::Mesh], is_transparent_pass, false);
+            int64_t index_start = get_mesh_indices(m_renderables_visible, is_transparent_pass, true);
+            int64_t index_end   = get_mesh_indices(m_renderables_visible, is_transparent_pass, false);
             for (int64_t i = index_start; i < index_end; i++)
             {
-                // this can happen during async loading
-                if (i >= static_cast<int64_t>(m_renderables[Renderer_Entity::Mesh].size()))
-                    continue;
-
-                shared_ptr<Entity>& entity        = m_renderables[Renderer_Entity::Mesh][i];
+                shared_ptr<Entity>& entity        = m_renderables_visible[i];
                 shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
-                if (!renderable || renderable->HasFlag(RenderableFlags::OccludedCpu))
+                if (!renderable)
                     continue;
 
                 // toggles
@@ -751,7 +773,7 @@ namespace Spartan
         // front face
         cmd_list->SetIgnoreClearValues(false);
         pass(pso, false, false);
-        visibility::get_gpu_occlusion_query_results(cmd_list, m_renderables);
+        visibility::get_gpu_occlusion_query_results(cmd_list, m_renderables_visible);
         cmd_list->Blit(tex_depth, tex_depth_opaque, false);
 
         // back face (only for materials with subsurface scattering)
@@ -816,15 +838,11 @@ namespace Spartan
         cmd_list->SetPipelineState(pso);
 
         lock_guard lock(m_mutex_renderables);
-        int64_t index_start = get_mesh_indices(m_renderables[Renderer_Entity::Mesh], is_transparent_pass, true);
-        int64_t index_end   = get_mesh_indices(m_renderables[Renderer_Entity::Mesh], is_transparent_pass, false);
+        int64_t index_start = get_mesh_indices(m_renderables_visible, is_transparent_pass, true);
+        int64_t index_end   = get_mesh_indices(m_renderables_visible, is_transparent_pass, false);
         for (int64_t i = index_start; i < index_end; i++)
         {
-            // this can happen during async loading
-            if (i >= static_cast<int64_t>(m_renderables[Renderer_Entity::Mesh].size()))
-                continue;
-
-            shared_ptr<Entity>& entity        = m_renderables[Renderer_Entity::Mesh][i];
+            shared_ptr<Entity>& entity        = m_renderables_visible[i];
             shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
             if (!renderable || !renderable->IsVisible())
                 continue;
@@ -1188,17 +1206,26 @@ namespace Spartan
 
             // update
             {
-                vector<shared_ptr<Entity>>& entities = m_renderables[Renderer_Entity::Mesh];
-                int64_t index_start                  = get_mesh_indices(m_renderables[Renderer_Entity::Mesh], false, true);
-                int64_t index_end                    = get_mesh_indices(m_renderables[Renderer_Entity::Mesh], false, false);
+                // all opaque meshes, not only the visible ones, since they all contribute light
+                lock_guard lock(m_mutex_renderables);
+                frame_vector<shared_ptr<Entity>> entities;
+                entities.reserve(m_renderables[Renderer_Entity::Mesh].size());
+                for (const shared_ptr<Entity>& entity : m_renderables[Renderer_Entity::Mesh])
+                {
+                    shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
+                    if (renderable && !renderable->GetMaterial()->IsTransparent())
+                    {
+                        entities.emplace_back(entity);
+                    }
+                }
 
                 RHI_FidelityFX::BrixelizerGI_Update(
                     cmd_list,
                     GetOption<float>(Renderer_Option::ResolutionScale),
                     &m_cb_frame_cpu,
                     entities,
-                    index_start,
-                    index_end,
+                    0,
+                    static_cast<int64_t>(entities.size()),
                     GetRenderTarget(Renderer_RenderTarget::light_diffuse_gi) // use as debug output (if needed)
                 );
             }
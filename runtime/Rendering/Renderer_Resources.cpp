@@ -272,32 +272,42 @@ namespace Spartan
         const string shader_dir = ResourceCache::GetResourceDirectory(ResourceDirectory::Shaders) + "\\";
         #define shader(x) shaders[static_cast<uint8_t>(x)]
 
+        // log how long each shader took to compile, once the last one has finished
+        RHI_Shader::CompilationReportBegin();
+
         // debug
         {
             // line
             shader(Renderer_Shader::line_v) = make_shared<RHI_Shader>();
+            shader(Renderer_Shader::line_v)->SetCompilationPriority(RHI_ShaderCompilationPriority::Low);
             shader(Renderer_Shader::line_v)->Compile(RHI_Shader_Type::Vertex, shader_dir + "line.hlsl", async, RHI_Vertex_Type::PosCol);
             shader(Renderer_Shader::line_p) = make_shared<RHI_Shader>();
+            shader(Renderer_Shader::line_p)->SetCompilationPriority(RHI_ShaderCompilationPriority::Low);
             shader(Renderer_Shader::line_p)->Compile(RHI_Shader_Type::Pixel, shader_dir + "line.hlsl", async);
 
             // grid
             {
                 shader(Renderer_Shader::grid_v) = make_shared<RHI_Shader>();
+                shader(Renderer_Shader::grid_v)->SetCompilationPriority(RHI_ShaderCompilationPriority::Low);
                 shader(Renderer_Shader::grid_v)->Compile(RHI_Shader_Type::Vertex, shader_dir + "grid.hlsl", async, RHI_Vertex_Type::PosUvNorTan);
 
                 shader(Renderer_Shader::grid_p) = make_shared<RHI_Shader>();
+                shader(Renderer_Shader::grid_p)->SetCompilationPriority(RHI_ShaderCompilationPriority::Low);
                 shader(Renderer_Shader::grid_p)->Compile(RHI_Shader_Type::Pixel, shader_dir + "grid.hlsl", async);
             }
 
             // outline
             {
                 shader(Renderer_Shader::outline_v) = make_shared<RHI_Shader>();
+                shader(Renderer_Shader::outline_v)->SetCompilationPriority(RHI_ShaderCompilationPriority::Low);
                 shader(Renderer_Shader::outline_v)->Compile(RHI_Shader_Type::Vertex, shader_dir + "outline.hlsl", async, RHI_Vertex_Type::PosUvNorTan);
 
                 shader(Renderer_Shader::outline_p) = make_shared<RHI_Shader>();
+                shader(Renderer_Shader::outline_p)->SetCompilationPriority(RHI_ShaderCompilationPriority::Low);
                 shader(Renderer_Shader::outline_p)->Compile(RHI_Shader_Type::Pixel, shader_dir + "outline.hlsl", async);
 
                 shader(Renderer_Shader::outline_c) = make_shared<RHI_Shader>();
+                shader(Renderer_Shader::outline_c)->SetCompilationPriority(RHI_ShaderCompilationPriority::Low);
                 shader(Renderer_Shader::outline_c)->Compile(RHI_Shader_Type::Compute, shader_dir + "outline.hlsl", async);
             }
         }
@@ -305,9 +315,11 @@ namespace Spartan
         // depth pre-pass
         {
             shader(Renderer_Shader::depth_prepass_v) = make_shared<RHI_Shader>();
+            shader(Renderer_Shader::depth_prepass_v)->SetCompilationPriority(RHI_ShaderCompilationPriority::Critical);
             shader(Renderer_Shader::depth_prepass_v)->Compile(RHI_Shader_Type::Vertex, shader_dir + "depth_prepass.hlsl", async, RHI_Vertex_Type::PosUvNorTan);
 
             shader(Renderer_Shader::depth_prepass_alpha_test_p) = make_shared<RHI_Shader>();
+            shader(Renderer_Shader::depth_prepass_alpha_test_p)->SetCompilationPriority(RHI_ShaderCompilationPriority::Critical);
             shader(Renderer_Shader::depth_prepass_alpha_test_p)->Compile(RHI_Shader_Type::Pixel, shader_dir + "depth_prepass.hlsl", async);
         }
 
@@ -323,9 +335,11 @@ namespace Spartan
         // g-buffer
         {
             shader(Renderer_Shader::gbuffer_v) = make_shared<RHI_Shader>();
+            shader(Renderer_Shader::gbuffer_v)->SetCompilationPriority(RHI_ShaderCompilationPriority::Critical);
             shader(Renderer_Shader::gbuffer_v)->Compile(RHI_Shader_Type::Vertex, shader_dir + "g_buffer.hlsl", async, RHI_Vertex_Type::PosUvNorTan);
 
             shader(Renderer_Shader::gbuffer_p) = make_shared<RHI_Shader>();
+            shader(Renderer_Shader::gbuffer_p)->SetCompilationPriority(RHI_ShaderCompilationPriority::Critical);
             shader(Renderer_Shader::gbuffer_p)->Compile(RHI_Shader_Type::Pixel, shader_dir + "g_buffer.hlsl", async);
         }
 
@@ -347,19 +361,23 @@ namespace Spartan
 
             // environment prefilter - compile synchronously as it's needed immediately
             shader(Renderer_Shader::light_integration_environment_filter_c) = make_shared<RHI_Shader>();
+            shader(Renderer_Shader::light_integration_environment_filter_c)->SetCompilationPriority(RHI_ShaderCompilationPriority::Critical);
             shader(Renderer_Shader::light_integration_environment_filter_c)->AddDefine("ENVIRONMENT_FILTER");
             shader(Renderer_Shader::light_integration_environment_filter_c)->Compile(RHI_Shader_Type::Compute, shader_dir + "light_integration.hlsl", async);
 
             // light
             shader(Renderer_Shader::light_c) = make_shared<RHI_Shader>();
+            shader(Renderer_Shader::light_c)->SetCompilationPriority(RHI_ShaderCompilationPriority::Critical);
             shader(Renderer_Shader::light_c)->Compile(RHI_Shader_Type::Compute, shader_dir + "light.hlsl", async);
 
             // composition
             shader(Renderer_Shader::light_composition_c) = make_shared<RHI_Shader>();
+            shader(Renderer_Shader::light_composition_c)->SetCompilationPriority(RHI_ShaderCompilationPriority::Critical);
             shader(Renderer_Shader::light_composition_c)->Compile(RHI_Shader_Type::Compute, shader_dir + "light_composition.hlsl", async);
 
             // image based
             shader(Renderer_Shader::light_image_based_c) = make_shared<RHI_Shader>();
+            shader(Renderer_Shader::light_image_based_c)->SetCompilationPriority(RHI_ShaderCompilationPriority::Critical);
             shader(Renderer_Shader::light_image_based_c)->Compile(RHI_Shader_Type::Compute, shader_dir + "light_image_based.hlsl", async);
         }
 
@@ -423,9 +441,11 @@ namespace Spartan
         // sky
         {
             shader(Renderer_Shader::skysphere_c) = make_shared<RHI_Shader>();
+            shader(Renderer_Shader::skysphere_c)->SetCompilationPriority(RHI_ShaderCompilationPriority::Critical);
             shader(Renderer_Shader::skysphere_c)->Compile(RHI_Shader_Type::Compute, shader_dir + "skysphere.hlsl", async);
 
             shader(Renderer_Shader::skysphere_to_skybox_c) = make_shared<RHI_Shader>();
+            shader(Renderer_Shader::skysphere_to_skybox_c)->SetCompilationPriority(RHI_ShaderCompilationPriority::Critical);
             shader(Renderer_Shader::skysphere_to_skybox_c)->Compile(RHI_Shader_Type::Compute, shader_dir + "skysphere_to_skybox.hlsl", async);
         }
 
@@ -449,6 +469,7 @@ namespace Spartan
 
         // tone-mapping & gamma correction
         shader(Renderer_Shader::output_c) = make_shared<RHI_Shader>();
+        shader(Renderer_Shader::output_c)->SetCompilationPriority(RHI_ShaderCompilationPriority::Critical);
         shader(Renderer_Shader::output_c)->Compile(RHI_Shader_Type::Compute, shader_dir + "output.hlsl", async);
 
         // motion blur
@@ -474,6 +495,8 @@ namespace Spartan
         // additive transparent
         shader(Renderer_Shader::additive_transparent_c) = make_shared<RHI_Shader>();
         shader(Renderer_Shader::additive_transparent_c)->Compile(RHI_Shader_Type::Compute, shader_dir + "additive_transparent.hlsl", async);
+
+        RHI_Shader::CompilationReportEnd("Shader compilation at startup");
     }
 
     void Renderer::CreateFonts()
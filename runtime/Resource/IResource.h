@@ -87,6 +87,11 @@ namespace Spartan
         virtual void SaveToFile(const std::string& file_path)   { }
         virtual void LoadFromFile(const std::string& file_path) { }
 
+        // asynchronous loading (see ResourceCache::LoadAsync), LoadFromFile() runs on a worker and stops
+        // short of the gpu upload, which is done later by UploadToGpu() on the main thread, within a time budget
+        void SetDeferGpuUpload(const bool defer) { m_defer_gpu_upload = defer; }
+        virtual void UploadToGpu()               { }
+
         // type
         template <typename T>
         static constexpr ResourceType TypeToEnum();
@@ -97,6 +102,7 @@ namespace Spartan
         ResourceType m_resource_type                = ResourceType::Max;
         std::atomic<ResourceState> m_resource_state = ResourceState::Max;
         uint32_t m_flags                            = 0;
+        bool m_defer_gpu_upload                     = false;
 
     private:
         std::string m_resource_file_path;
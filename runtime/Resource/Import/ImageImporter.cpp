@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include "ImageImporter.h"
 #include "../../RHI/RHI_Texture.h"
+#include "../../IO/AsyncIo.h"
 SP_WARNINGS_OFF
 #define FREEIMAGE_LIB
 #include <FreeImage/FreeImage.h>
@@ -376,10 +377,19 @@ namespace Spartan
             return;
         }
 
+        // if the file was read ahead, decode it from memory
+        const char* preloaded_data = nullptr;
+        uint64_t preloaded_size    = 0;
+        unique_ptr<FIMEMORY, decltype(&FreeImage_CloseMemory)> memory(nullptr, &FreeImage_CloseMemory);
+        if (AsyncIo::FindPreloaded(file_path, &preloaded_data, &preloaded_size))
+        {
+            memory.reset(FreeImage_OpenMemory(reinterpret_cast<BYTE*>(const_cast<char*>(preloaded_data)), static_cast<DWORD>(preloaded_size)));
+        }
+
         // acquire image format
         FREE_IMAGE_FORMAT format = FIF_UNKNOWN;
         {
-            format = FreeImage_GetFileType(file_path.c_str(), 0);
+            format = memory ? FreeImage_GetFileTypeFromMemory(memory.get(), 0) : FreeImage_GetFileType(file_path.c_str(), 0);
 
             // if the format is unknown, try to work it out from the file path
             if (format == FIF_UNKNOWN)
@@ -403,7 +413,7 @@ namespace Spartan
         {
             // load
             tinyddsloader::DDSFile dds_file;
-            auto result = dds_file.Load(file_path.c_str());
+            auto result = memory ? dds_file.Load(reinterpret_cast<const uint8_t*>(preloaded_data), preloaded_size) : dds_file.Load(file_path.c_str());
             if (result != tinyddsloader::Success)
             {
                 SP_LOG_ERROR("Failed to load DSS file");
@@ -450,7 +460,7 @@ namespace Spartan
         }
 
         // load
-        FIBITMAP* bitmap = FreeImage_Load(format, file_path.c_str());
+        FIBITMAP* bitmap = memory ? FreeImage_LoadFromMemory(format, memory.get()) : FreeImage_Load(format, file_path.c_str());
         if (!bitmap)
         {
             SP_LOG_ERROR("Failed to load \"%s\"", file_path.c_str());
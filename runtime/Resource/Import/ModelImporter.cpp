@@ -30,6 +30,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../World/Entity.h"
 #include "../../World/Components/Light.h"
 #include "../../Resource/ResourceCache.h"
+#include "../../IO/FileStream.h"
 SP_WARNINGS_OFF
 #include "assimp/scene.h"
 #include "assimp/ProgressHandler.hpp"
@@ -55,6 +56,308 @@ namespace Spartan
         bool model_has_animation = false;
         const aiScene* scene     = nullptr;
 
+        // import cache, what an import produces is stored in engine format so that the next load skips assimp
+        // it's keyed by the size and write time of the source files and the import flags, so it invalidates itself
+        const uint32_t import_cache_magic   = 0x504D4953; // "SIMP"
+        const uint32_t import_cache_version = 2;
+
+        struct cached_material
+        {
+            string file_path;
+            array<float, static_cast<uint32_t>(MaterialProperty::Max)> properties;
+            vector<pair<uint32_t, string>> textures; // type and path
+        };
+
+        struct cached_renderable
+        {
+            uint32_t index_offset  = 0;
+            uint32_t index_count   = 0;
+            uint32_t vertex_offset = 0;
+            uint32_t vertex_count  = 0;
+            BoundingBox aabb;
+            uint32_t material      = numeric_limits<uint32_t>::max();
+        };
+
+        struct cached_entity
+        {
+            uint32_t parent = numeric_limits<uint32_t>::max();
+            string name;
+            Vector3 position;
+            Quaternion rotation;
+            Vector3 scale;
+            bool has_renderable = false;
+            cached_renderable renderable;
+        };
+    }
+
+    // what an import records while parsing, for the import cache, materials are recorded before they are handed
+    // to renderables (which prepare them for the gpu), it lives for a single import
+    struct ModelImportContext
+    {
+        vector<cached_material> materials;
+        unordered_map<const Entity*, cached_renderable> renderables;
+    };
+
+    namespace
+    {
+        uint32_t record_material(ModelImportContext& context, Material* material)
+        {
+            cached_material& record = context.materials.emplace_back();
+            record.file_path        = material->GetResourceFilePath();
+
+            for (uint32_t i = 0; i < static_cast<uint32_t>(MaterialProperty::Max); i++)
+            {
+                record.properties[i] = material->GetProperty(static_cast<MaterialProperty>(i));
+            }
+
+            for (uint32_t i = 0; i < static_cast<uint32_t>(MaterialTextureType::Max); i++)
+            {
+                const string texture_path = material->GetTexturePathByType(static_cast<MaterialTextureType>(i));
+                if (!texture_path.empty())
+                {
+                    record.textures.emplace_back(i, texture_path);
+                }
+            }
+
+            return static_cast<uint32_t>(context.materials.size() - 1);
+        }
+
+        string get_import_cache_path(const string& file_path)
+        {
+            // the path is hashed in, models are often named the same (scene.gltf)
+            const string hash_hex = FileSystem::HashToHex(FileSystem::Hash(FileSystem::GetRelativePath(file_path)));
+
+            return ResourceCache::GetResourceDirectory(ResourceDirectory::Cache) + "\\models\\" + FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path) + "_" + hash_hex + ".import";
+        }
+
+        // a hash of the import flags and of the size and write time of the model and the files next to it
+        // that share its name (gltf buffers, obj material libraries), the files themselves aren't read
+        uint64_t compute_import_cache_key(const string& file_path, const uint32_t flags)
+        {
+            uint64_t hash = FileSystem::Hash(&import_cache_version, sizeof(import_cache_version));
+            hash          = FileSystem::Hash(&flags, sizeof(flags), hash);
+
+            const string name     = FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
+            vector<string> files  = { file_path };
+            for (const string& path : FileSystem::GetFilesInDirectory(FileSystem::GetDirectoryFromFilePath(file_path)))
+            {
+                if (FileSystem::GetFileNameWithoutExtensionFromFilePath(path) == name &&
+                    FileSystem::GetFileNameFromFilePath(path) != FileSystem::GetFileNameFromFilePath(file_path) &&
+                    !FileSystem::IsSupportedImageFile(path) && !FileSystem::IsEngineFile(path))
+                {
+                    files.emplace_back(path);
+                }
+            }
+            sort(files.begin() + 1, files.end());
+
+            for (const string& path : files)
+            {
+                const string file_name = FileSystem::GetFileNameFromFilePath(path);
+                hash                   = FileSystem::Hash(file_name, hash);
+
+                error_code error;
+                const uintmax_t size     = filesystem::file_size(path, error);
+                const int64_t write_time = error ? 0 : static_cast<int64_t>(filesystem::last_write_time(path, error).time_since_epoch().count());
+                hash                     = FileSystem::Hash(&size, sizeof(size), hash);
+                hash                     = FileSystem::Hash(&write_time, sizeof(write_time), hash);
+            }
+
+            return hash;
+        }
+
+        void save_import_cache(const ModelImportContext& context, const string& cache_path, const uint64_t key, Mesh* mesh)
+        {
+            shared_ptr<Entity> root = mesh->GetRootEntity().lock();
+            if (!root)
+                return;
+
+            // flatten the hierarchy, parents before their children
+            vector<pair<Entity*, uint32_t>> entities = { { root.get(), numeric_limits<uint32_t>::max() } };
+            for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+            {
+                for (Entity* child : entities[i].first->GetChildren())
+                {
+                    entities.emplace_back(child, i);
+                }
+            }
+
+            FileSystem::CreateDirectory(FileSystem::GetDirectoryFromFilePath(cache_path));
+            FileStream file(cache_path, FileStream_Write | FileStream_Compressed);
+            if (!file.IsOpen())
+                return;
+
+            file.Write(import_cache_magic);
+            file.Write(import_cache_version);
+            file.Write(key);
+
+            file.Write(static_cast<uint32_t>(context.materials.size()));
+            for (const cached_material& material : context.materials)
+            {
+                file.Write(material.file_path);
+                for (const float value : material.properties)
+                {
+                    file.Write(value);
+                }
+
+                file.Write(static_cast<uint32_t>(material.textures.size()));
+                for (const auto& [type, texture_path] : material.textures)
+                {
+                    file.Write(type);
+                    file.Write(texture_path);
+                }
+            }
+
+            file.Write(static_cast<uint32_t>(entities.size()));
+            for (const auto& [entity, parent] : entities)
+            {
+                file.Write(parent);
+                file.Write(entity->GetObjectName());
+                file.Write(entity->GetPositionLocal());
+                file.Write(entity->GetRotationLocal());
+                file.Write(entity->GetScaleLocal());
+
+                auto it = context.renderables.find(entity);
+                file.Write(it != context.renderables.end());
+                if (it != context.renderables.end())
+                {
+                    const cached_renderable& renderable = it->second;
+                    file.Write(renderable.index_offset);
+                    file.Write(renderable.index_count);
+                    file.Write(renderable.vertex_offset);
+                    file.Write(renderable.vertex_count);
+                    file.Write(renderable.aabb);
+                    file.Write(renderable.material);
+                }
+            }
+
+            mesh->WriteGeometry(&file);
+            file.Close();
+        }
+
+        bool load_import_cache(const string& cache_path, const uint64_t key, Mesh* mesh)
+        {
+            if (!FileSystem::Exists(cache_path))
+                return false;
+
+            FileStream file(cache_path, FileStream_Read | FileStream_Mapped);
+            if (!file.IsOpen() || file.ReadAs<uint32_t>() != import_cache_magic || file.ReadAs<uint32_t>() != import_cache_version || file.ReadAs<uint64_t>() != key)
+                return false;
+
+            // read and validate everything before creating any entities
+            vector<cached_material> materials(file.ReadAs<uint32_t>());
+            for (cached_material& material : materials)
+            {
+                file.Read(&material.file_path);
+                for (float& value : material.properties)
+                {
+                    file.Read(&value);
+                }
+
+                material.textures.resize(file.ReadAs<uint32_t>());
+                for (auto& [type, texture_path] : material.textures)
+                {
+                    file.Read(&type);
+                    file.Read(&texture_path);
+                    if (type >= static_cast<uint32_t>(MaterialTextureType::Max))
+                        return false;
+                }
+            }
+
+            vector<cached_entity> entities(file.ReadAs<uint32_t>());
+            for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+            {
+                cached_entity& entity = entities[i];
+                file.Read(&entity.parent);
+                file.Read(&entity.name);
+                file.Read(&entity.position);
+                file.Read(&entity.rotation);
+                file.Read(&entity.scale);
+                file.Read(&entity.has_renderable);
+                if (entity.has_renderable)
+                {
+                    cached_renderable& renderable = entity.renderable;
+                    file.Read(&renderable.index_offset);
+                    file.Read(&renderable.index_count);
+                    file.Read(&renderable.vertex_offset);
+                    file.Read(&renderable.vertex_count);
+                    file.Read(&renderable.aabb);
+                    file.Read(&renderable.material);
+                }
+
+                const bool valid_parent   = i == 0 ? entity.parent == numeric_limits<uint32_t>::max() : entity.parent < i;
+                const bool valid_material = !entity.has_renderable || entity.renderable.material == numeric_limits<uint32_t>::max() || entity.renderable.material < materials.size();
+                if (!valid_parent || !valid_material)
+                    return false;
+            }
+
+            if (entities.empty() || !mesh->ReadGeometry(&file))
+                return false;
+
+            // materials
+            vector<shared_ptr<Material>> materials_engine;
+            for (const cached_material& material : materials)
+            {
+                shared_ptr<Material> material_engine = make_shared<Material>();
+                material_engine->SetResourceFilePath(material.file_path);
+
+                // textures first, setting them can touch properties which are then restored to what the import ended with
+                for (const auto& [type, texture_path] : material.textures)
+                {
+                    material_engine->SetTexture(static_cast<MaterialTextureType>(type), texture_path);
+                }
+
+                for (uint32_t i = 0; i < static_cast<uint32_t>(MaterialProperty::Max); i++)
+                {
+                    material_engine->SetProperty(static_cast<MaterialProperty>(i), material.properties[i]);
+                }
+
+                materials_engine.emplace_back(material_engine);
+            }
+
+            // entities, the root is created as inactive for thread-safety, same as when importing
+            vector<shared_ptr<Entity>> entities_engine;
+            for (const cached_entity& entity : entities)
+            {
+                shared_ptr<Entity> entity_engine = World::CreateEntity();
+                if (entities_engine.empty())
+                {
+                    mesh->SetRootEntity(entity_engine);
+                    entity_engine->SetActive(false);
+                }
+
+                entity_engine->SetObjectName(entity.name);
+                entity_engine->SetParent(entities_engine.empty() ? nullptr : entities_engine[entity.parent]);
+                entity_engine->SetPositionLocal(entity.position);
+                entity_engine->SetRotationLocal(entity.rotation);
+                entity_engine->SetScaleLocal(entity.scale);
+
+                if (entity.has_renderable)
+                {
+                    const cached_renderable& renderable = entity.renderable;
+                    entity_engine->AddComponent<Renderable>()->SetGeometry(
+                        mesh,
+                        renderable.aabb,
+                        renderable.index_offset,
+                        renderable.index_count,
+                        renderable.vertex_offset,
+                        renderable.vertex_count
+                    );
+
+                    if (renderable.material != numeric_limits<uint32_t>::max())
+                    {
+                        mesh->SetMaterial(materials_engine[renderable.material], entity_engine.get());
+                    }
+                }
+
+                entities_engine.emplace_back(entity_engine);
+            }
+
+            mesh->CreateGpuBuffers();
+            entities_engine[0]->SetActive(true);
+
+            return true;
+        }
+
         Matrix to_matrix(const aiMatrix4x4& transform)
         {
             return Matrix
@@ -428,6 +731,18 @@ namespace Spartan
         mesh            = mesh_in;
         mesh->SetObjectName(model_name);
 
+        // skip assimp if this import is cached, lights aren't recorded so importing them always goes through assimp
+        const bool use_cache     = !(mesh->GetFlags() & static_cast<uint32_t>(MeshFlags::ImportLights));
+        const string cache_path  = get_import_cache_path(file_path);
+        const uint64_t cache_key = use_cache ? compute_import_cache_key(file_path, mesh->GetFlags()) : 0;
+        if (use_cache && load_import_cache(cache_path, cache_key, mesh))
+        {
+            SP_LOG_INFO("Loaded \"%s\" from the import cache", model_name.c_str());
+            mesh = nullptr;
+            return true;
+        }
+        ModelImportContext context;
+
         // set up the importer
         Importer importer;
         {
@@ -491,7 +806,7 @@ namespace Spartan
             model_has_animation = scene->mNumAnimations != 0;
 
             // recursively parse nodes
-            ParseNode(scene->mRootNode);
+            ParseNode(context, scene->mRootNode);
 
             // update model geometry
             {
@@ -504,9 +819,13 @@ namespace Spartan
                 mesh->PostProcess();
             }
 
-            // make the root entity active since it's now thread-safe
+            // make the root entity active since it's now thread-safe, this also hands the model over to the renderer
             mesh->GetRootEntity().lock()->SetActive(true);
-            World::Resolve();
+
+            if (use_cache)
+            {
+                save_import_cache(context, cache_path, cache_key, mesh);
+            }
         }
         else
         {
@@ -520,7 +839,7 @@ namespace Spartan
         return scene != nullptr;
     }
 
-    void ModelImporter::ParseNode(const aiNode* node, shared_ptr<Entity> parent_entity)
+    void ModelImporter::ParseNode(ModelImportContext& context, const aiNode* node, shared_ptr<Entity> parent_entity)
     {
         // create an entity that will match this node.
         shared_ptr<Entity> entity = World::CreateEntity();
@@ -551,7 +870,7 @@ namespace Spartan
         // mesh components
         if (node->mNumMeshes > 0)
         {
-            ParseNodeMeshes(node, entity);
+            ParseNodeMeshes(context, node, entity);
         }
 
         // light component
@@ -563,14 +882,14 @@ namespace Spartan
         // children nodes
         for (uint32_t i = 0; i < node->mNumChildren; i++)
         {
-            ParseNode(node->mChildren[i], entity);
+            ParseNode(context, node->mChildren[i], entity);
         }
 
         // update progress tracking
         ProgressTracker::GetProgress(ProgressType::ModelImporter).JobDone();
     }
 
-    void ModelImporter::ParseNodeMeshes(const aiNode* assimp_node, shared_ptr<Entity> node_entity)
+    void ModelImporter::ParseNodeMeshes(ModelImportContext& context, const aiNode* assimp_node, shared_ptr<Entity> node_entity)
     {
         // An aiNode can have any number of meshes (albeit typically, it's one).
         // If it has more than one meshes, then we create children entities to store them.
@@ -600,7 +919,7 @@ namespace Spartan
             entity->SetObjectName(node_name);
             
             // load the mesh onto the entity (via a Renderable component)
-            ParseMesh(node_mesh, entity);
+            ParseMesh(context, node_mesh, entity);
         }
     }
 
@@ -649,7 +968,7 @@ namespace Spartan
         }
     }
 
-    void ModelImporter::ParseMesh(aiMesh* assimp_mesh, shared_ptr<Entity> entity_parent)
+    void ModelImporter::ParseMesh(ModelImportContext& context, aiMesh* assimp_mesh, shared_ptr<Entity> entity_parent)
     {
         SP_ASSERT(assimp_mesh != nullptr);
         SP_ASSERT(entity_parent != nullptr);
@@ -726,6 +1045,13 @@ namespace Spartan
         // add a renderable component to this entity
         shared_ptr<Renderable> renderable = entity_parent->AddComponent<Renderable>();
 
+        cached_renderable& record = context.renderables[entity_parent.get()];
+        record.index_offset       = index_offset;
+        record.index_count        = static_cast<uint32_t>(indices.size());
+        record.vertex_offset      = vertex_offset;
+        record.vertex_count       = static_cast<uint32_t>(vertices.size());
+        record.aabb               = aabb;
+
         // set the geometry
         renderable->SetGeometry(
             mesh,
@@ -744,6 +1070,7 @@ namespace Spartan
 
             // convert it and add it to the model
             shared_ptr<Material> material = load_material(mesh, model_file_path, assimp_material);
+            record.material               = record_material(context, material.get());
 
             mesh->SetMaterial(material, entity_parent.get());
         }
@@ -32,6 +32,7 @@ namespace Spartan
 {
     class Entity;
     class Mesh;
+    struct ModelImportContext;
 
     class ModelImporter
     {
@@ -40,11 +41,11 @@ namespace Spartan
         static bool Load(Mesh* mesh, const std::string& file_path);
 
     private:
-        static void ParseNode(const aiNode* node, std::shared_ptr<Entity> parent_entity = nullptr);
-        static void ParseNodeMeshes(const aiNode* node, std::shared_ptr<Entity> new_entity);
+        static void ParseNode(ModelImportContext& context, const aiNode* node, std::shared_ptr<Entity> parent_entity = nullptr);
+        static void ParseNodeMeshes(ModelImportContext& context, const aiNode* node, std::shared_ptr<Entity> new_entity);
         static void ParseNodeLight(const aiNode* node, std::shared_ptr<Entity> new_entity);
         static void ParseAnimations();
-        static void ParseMesh(aiMesh* mesh, std::shared_ptr<Entity> entity_parent);
+        static void ParseMesh(ModelImportContext& context, aiMesh* mesh, std::shared_ptr<Entity> entity_parent);
         static void ParseNodes(const aiMesh* mesh);
     };
 }
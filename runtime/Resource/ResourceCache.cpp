@@ -24,10 +24,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "ResourceCache.h"
 #include "../World/World.h"
 #include "../IO/FileStream.h"
+#include "../IO/Package.h"
+#include "../IO/AsyncIo.h"
 #include "../RHI/RHI_Texture.h"
 #include "../Audio/AudioClip.h"
 #include "../Rendering/Mesh.h"
 #include "../Core/ProgressTracker.h"
+#include "../Core/ThreadPool.h"
 //==================================
 
 //= NAMESPACES ================
@@ -39,20 +42,143 @@ namespace Spartan
 {
     namespace
     {
-        array<string, 6> m_standard_resource_directories;
+        array<string, 7> m_standard_resource_directories;
         string m_project_directory;
         vector<shared_ptr<IResource>> m_resources;
         mutex m_mutex;
         bool use_root_shader_directory = false;
+
+        // asynchronous loading
+        mutex mutex_requests;
+        unordered_map<string, shared_ptr<ResourceLoadRequest>> requests_in_flight; // keyed by type and path
+        vector<shared_ptr<ResourceLoadRequest>> requests_queued;
+        vector<shared_ptr<ResourceLoadRequest>> requests_uploading;
+        uint64_t request_sequence = 0;
+        float upload_budget_ms    = 2.0f;
+
+        string get_request_key(const string& file_path, const ResourceType type)
+        {
+            return to_string(static_cast<uint32_t>(type)) + ":" + FileSystem::GetRelativePath(file_path);
+        }
+
+        // expects mutex_requests to be locked
+        void remove_in_flight(const shared_ptr<ResourceLoadRequest>& request)
+        {
+            auto it = requests_in_flight.find(get_request_key(request->file_path, request->resource->GetResourceType()));
+            if (it != requests_in_flight.end() && it->second == request)
+            {
+                requests_in_flight.erase(it);
+            }
+        }
+
+        // a request whose last handle went away is being cancelled, even if its state doesn't say so yet, so
+        // the count is never raised from zero, false means the request can't be joined and a new one is needed
+        bool add_handle(ResourceLoadRequest& request)
+        {
+            uint32_t count = request.handle_count.load();
+            while (count != 0)
+            {
+                if (!request.handle_count.compare_exchange_weak(count, count + 1))
+                    continue;
+
+                if (request.state != ResourceLoadState::Cancelled)
+                    return true;
+
+                request.handle_count--;
+                return false;
+            }
+
+            return false;
+        }
+
+        // expects mutex_requests to be locked, returns the highest priority request (oldest first) and discards cancelled ones
+        shared_ptr<ResourceLoadRequest> pop_next(vector<shared_ptr<ResourceLoadRequest>>& requests)
+        {
+            requests.erase(remove_if(requests.begin(), requests.end(), [](const shared_ptr<ResourceLoadRequest>& request)
+            {
+                if (request->state != ResourceLoadState::Cancelled)
+                    return false;
+
+                remove_in_flight(request);
+                return true;
+            }), requests.end());
+
+            auto it = min_element(requests.begin(), requests.end(), [](const shared_ptr<ResourceLoadRequest>& a, const shared_ptr<ResourceLoadRequest>& b)
+            {
+                return a->priority != b->priority ? a->priority > b->priority : a->sequence < b->sequence;
+            });
+
+            if (it == requests.end())
+                return nullptr;
+
+            shared_ptr<ResourceLoadRequest> request = *it;
+            requests.erase(it);
+            return request;
+        }
+
+        // files that are parsed by the engine (rather than by assimp or fmod) can be read ahead asynchronously,
+        // packed files are already in memory
+        bool can_read_ahead(const string& file_path)
+        {
+            const string extension = FileSystem::GetExtensionFromFilePath(file_path);
+            const bool parsed      = extension == EXTENSION_MODEL || extension == EXTENSION_TEXTURE || extension == EXTENSION_MATERIAL || FileSystem::IsSupportedImageFile(file_path);
+
+            return parsed && !Package::Exists(file_path);
+        }
+
+        // every request schedules one of these, which loads whatever is the most important request at the time it runs
+        void load_next()
+        {
+            shared_ptr<ResourceLoadRequest> request;
+            {
+                lock_guard<mutex> lock(mutex_requests);
+                request = pop_next(requests_queued);
+            }
+
+            if (!request)
+                return;
+
+            ResourceLoadState expected = ResourceLoadState::Queued;
+            if (request->state.compare_exchange_strong(expected, ResourceLoadState::Loading))
+            {
+                request->resource->SetDeferGpuUpload(true);
+                AsyncIo::SetPreloaded(request->file_path, request->file_data.empty() ? nullptr : &request->file_data);
+                request->resource->LoadFromFile(request->file_path);
+                AsyncIo::SetPreloaded(request->file_path, nullptr);
+                request->file_data = vector<byte>();
+
+                expected = ResourceLoadState::Loading;
+                if (request->state.compare_exchange_strong(expected, ResourceLoadState::Uploading))
+                {
+                    lock_guard<mutex> lock(mutex_requests);
+                    requests_uploading.emplace_back(request);
+                    return;
+                }
+            }
+
+            // cancelled
+            lock_guard<mutex> lock(mutex_requests);
+            remove_in_flight(request);
+        }
     }
 
     void ResourceCache::Initialize()
     {
+        // mount the packages in the working directory, their files are found before the loose ones
+        for (const string& file_path : FileSystem::GetFilesInDirectory(FileSystem::GetWorkingDirectory()))
+        {
+            if (FileSystem::GetExtensionFromFilePath(file_path) == EXTENSION_PACKAGE)
+            {
+                Package::Mount(file_path);
+            }
+        }
+
         // create project directory
         SetProjectDirectory("project\\");
 
         // add engine standard resource directories
         const string data_dir = "data\\";
+        AddResourceDirectory(ResourceDirectory::Cache,          m_project_directory + "cache");
         AddResourceDirectory(ResourceDirectory::Environment,    m_project_directory + "environment");
         AddResourceDirectory(ResourceDirectory::Fonts,          data_dir + "fonts");
         AddResourceDirectory(ResourceDirectory::Icons,          data_dir + "icons");
@@ -156,8 +282,195 @@ namespace Spartan
         // todo: we just need to load the resource paths, simple and reliable
     }
 
+    void ResourceCache::Tick()
+    {
+        const auto time_start = chrono::steady_clock::now();
+
+        // upload at least one resource per frame, so loading always makes progress
+        while (true)
+        {
+            shared_ptr<ResourceLoadRequest> request;
+            {
+                lock_guard<mutex> lock(mutex_requests);
+                request = pop_next(requests_uploading);
+            }
+
+            if (!request)
+                break;
+
+            request->resource->UploadToGpu();
+            request->resource->SetDeferGpuUpload(false);
+
+            // the file might have been cached in the meantime (e.g. by a synchronous load), handles then get that instance
+            if (request->state == ResourceLoadState::Uploading)
+            {
+                shared_ptr<IResource> resource_cached = Cache<IResource>(request->resource);
+                if (resource_cached != request->resource)
+                {
+                    request->resource_cached = resource_cached;
+                }
+
+                ResourceLoadState expected = ResourceLoadState::Uploading;
+                request->state.compare_exchange_strong(expected, ResourceLoadState::Completed);
+            }
+
+            {
+                lock_guard<mutex> lock(mutex_requests);
+                remove_in_flight(request);
+            }
+
+            if (chrono::duration<float, milli>(chrono::steady_clock::now() - time_start).count() >= upload_budget_ms)
+                break;
+        }
+    }
+
+    void ResourceCache::SetUploadBudget(const float budget_ms)
+    {
+        upload_budget_ms = budget_ms;
+    }
+
+    uint32_t ResourceCache::GetLoadRequestCount()
+    {
+        lock_guard<mutex> lock(mutex_requests);
+        return static_cast<uint32_t>(requests_in_flight.size());
+    }
+
+    shared_ptr<ResourceLoadRequest> ResourceCache::FindLoadRequest(const string& file_path, const ResourceType type, const ResourceLoadPriority priority)
+    {
+        // loading
+        {
+            lock_guard<mutex> lock(mutex_requests);
+
+            auto it = requests_in_flight.find(get_request_key(file_path, type));
+            if (it != requests_in_flight.end() && add_handle(*it->second))
+            {
+                shared_ptr<ResourceLoadRequest>& request = it->second;
+                if (priority > request->priority)
+                {
+                    request->priority = priority;
+                }
+
+                return request;
+            }
+        }
+
+        // loaded
+        const string file_path_relative = FileSystem::GetRelativePath(file_path);
+        lock_guard<mutex> lock(m_mutex);
+        for (shared_ptr<IResource>& resource : m_resources)
+        {
+            if (resource->GetResourceType() == type && resource->GetResourceFilePath() == file_path_relative)
+            {
+                shared_ptr<ResourceLoadRequest> request = make_shared<ResourceLoadRequest>();
+                request->resource     = resource;
+                request->file_path    = file_path;
+                request->state        = ResourceLoadState::Completed;
+                request->handle_count = 1;
+
+                return request;
+            }
+        }
+
+        return nullptr;
+    }
+
+    shared_ptr<ResourceLoadRequest> ResourceCache::AddLoadRequest(shared_ptr<IResource> resource, const string& file_path, const ResourceLoadPriority priority)
+    {
+        shared_ptr<ResourceLoadRequest> request = make_shared<ResourceLoadRequest>();
+        request->resource     = resource;
+        request->file_path    = file_path;
+        request->priority     = priority;
+        request->handle_count = 1;
+        const bool read_ahead = can_read_ahead(file_path);
+
+        {
+            lock_guard<mutex> lock(mutex_requests);
+
+            // another thread might have requested the same file in the meantime
+            shared_ptr<ResourceLoadRequest>& request_in_flight = requests_in_flight[get_request_key(file_path, resource->GetResourceType())];
+            if (request_in_flight && add_handle(*request_in_flight))
+            {
+                if (priority > request_in_flight->priority)
+                {
+                    request_in_flight->priority = priority;
+                }
+
+                return request_in_flight;
+            }
+
+            request->sequence = request_sequence++;
+            request_in_flight = request;
+            if (!read_ahead)
+            {
+                requests_queued.emplace_back(request);
+            }
+        }
+
+        if (!read_ahead)
+        {
+            ThreadPool::AddJob(load_next);
+            return request;
+        }
+
+        // read the file without occupying a worker, then queue the request for parsing
+        AsyncIo::Read(file_path, [request](vector<byte>& data, const bool success)
+        {
+            if (request->state == ResourceLoadState::Cancelled)
+            {
+                lock_guard<mutex> lock(mutex_requests);
+                remove_in_flight(request);
+                return;
+            }
+
+            // on failure, the loader reads the file by path and reports the error
+            if (success)
+            {
+                request->file_data = move(data);
+            }
+
+            {
+                lock_guard<mutex> lock(mutex_requests);
+                requests_queued.emplace_back(request);
+            }
+
+            load_next();
+        });
+
+        return request;
+    }
+
+    void ResourceCache::LoadFromFile(IResource* resource, const string& file_path)
+    {
+        // read the file in one go (through io_uring where it's available) instead of the loader's small reads
+        vector<byte> file_data;
+        if (can_read_ahead(file_path) && AsyncIo::ReadAndWait(file_path, &file_data))
+        {
+            AsyncIo::SetPreloaded(file_path, &file_data);
+            resource->LoadFromFile(file_path);
+            AsyncIo::SetPreloaded(file_path, nullptr);
+            return;
+        }
+
+        // on failure, the loader reads the file by path and reports the error
+        resource->LoadFromFile(file_path);
+    }
+
     void ResourceCache::Shutdown()
     {
+        // cancel pending loads, loads that are running will be dropped once they finish
+        {
+            lock_guard<mutex> lock(mutex_requests);
+
+            for (auto& [key, request] : requests_in_flight)
+            {
+                request->state = ResourceLoadState::Cancelled;
+            }
+
+            requests_in_flight.clear();
+            requests_queued.clear();
+            requests_uploading.clear();
+        }
+
         uint32_t resource_count = static_cast<uint32_t>(m_resources.size());
         m_resources.clear();
         SP_LOG_INFO("%d resources have been cleared", resource_count);
@@ -30,6 +30,7 @@ namespace Spartan
 {
     enum class ResourceDirectory
     {
+        Cache,
         Environment,
         Fonts,
         Icons,
@@ -38,6 +39,119 @@ namespace Spartan
         Textures
     };
 
+    enum class ResourceLoadPriority : uint8_t
+    {
+        Low,
+        Normal,
+        High,
+        Critical
+    };
+
+    enum class ResourceLoadState : uint8_t
+    {
+        Queued,    // waiting for a worker
+        Loading,   // LoadFromFile() is running on a worker
+        Uploading, // waiting for its turn in the main thread's per-frame upload budget
+        Completed, // cached and ready
+        Cancelled  // every handle cancelled it before it completed
+    };
+
+    // shared by all the handles that requested the same file
+    struct ResourceLoadRequest
+    {
+        std::shared_ptr<IResource> resource;
+        std::shared_ptr<IResource> resource_cached; // the instance in the cache, if the file was cached by another load in the meantime, set before completing
+        std::string file_path;
+        std::atomic<ResourceLoadState> state       = ResourceLoadState::Queued;
+        std::atomic<ResourceLoadPriority> priority = ResourceLoadPriority::Normal;
+        std::atomic<uint32_t> handle_count         = 0;
+        uint64_t sequence                          = 0; // requests of the same priority are served in order
+        std::vector<std::byte> file_data;                   // the file, if it was read ahead
+    };
+
+    template <class T>
+    class ResourceHandle
+    {
+    public:
+        ResourceHandle() = default;
+        ResourceHandle(const std::shared_ptr<ResourceLoadRequest>& request) : m_request(request) { }
+
+        // a handle is one count of the request's handle_count, so it can be moved but not copied
+        ResourceHandle(const ResourceHandle&) = delete;
+        ResourceHandle& operator=(const ResourceHandle&) = delete;
+        ResourceHandle(ResourceHandle&& other) noexcept : m_request(std::move(other.m_request)), m_cancelled(other.m_cancelled)
+        {
+            other.m_cancelled = false;
+        }
+        ResourceHandle& operator=(ResourceHandle&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Cancel();
+
+                m_request         = std::move(other.m_request);
+                m_cancelled       = other.m_cancelled;
+                other.m_cancelled = false;
+            }
+
+            return *this;
+        }
+
+        // dropping a handle gives up on the request, like Cancel() does, a moved-from handle has no request and does nothing
+        ~ResourceHandle() { Cancel(); }
+
+        // until IsReady() returns true, this is a placeholder that is still loading (its resource state tells how far it is)
+        std::shared_ptr<T> Get() const
+        {
+            if (!m_request)
+                return nullptr;
+
+            return std::static_pointer_cast<T>(IsReady() && m_request->resource_cached ? m_request->resource_cached : m_request->resource);
+        }
+
+        ResourceLoadState GetState() const { return m_request ? m_request->state.load() : ResourceLoadState::Cancelled; }
+        bool IsReady() const               { return GetState() == ResourceLoadState::Completed; }
+        bool IsValid() const               { return m_request != nullptr; }
+
+        // the priority can be raised or lowered while the request is queued
+        void SetPriority(const ResourceLoadPriority priority)
+        {
+            if (m_request)
+            {
+                m_request->priority = priority;
+            }
+        }
+
+        // the request is only cancelled once every handle that asked for it has cancelled
+        void Cancel()
+        {
+            if (!m_request || m_cancelled)
+                return;
+
+            m_cancelled = true;
+            if (m_request->handle_count.fetch_sub(1) == 1)
+            {
+                // whoever owns the request at its current step will see this and drop it
+                for (ResourceLoadState state : { ResourceLoadState::Queued, ResourceLoadState::Loading, ResourceLoadState::Uploading })
+                {
+                    if (m_request->state.compare_exchange_strong(state, ResourceLoadState::Cancelled))
+                        break;
+                }
+            }
+        }
+
+        // lets the request complete without this handle, for callers that don't need to track it (the resource is still cached)
+        void Detach()
+        {
+            m_request.reset();
+            m_cancelled = false;
+        }
+
+    private:
+        std::shared_ptr<ResourceLoadRequest> m_request;
+        bool m_cancelled = false;
+    };
+
     class ResourceCache
     {
     public:
@@ -59,6 +173,7 @@ namespace Spartan
         template <class T>
         static std::shared_ptr<T> GetByPath(const std::string& path)
         {
+            std::lock_guard<std::mutex> guard(GetMutex());
             for (std::shared_ptr<IResource>& resource : GetResources())
             {
                 if (path == resource->GetResourceFilePath())
@@ -75,12 +190,17 @@ namespace Spartan
             if (!resource)
                 return nullptr;
 
+            // look up and insert under one lock, resources are cached from several threads at once (e.g. parallel world loading)
+            std::lock_guard<std::mutex> guard(GetMutex());
+
             // if cached, return the cached resource
-            if (IsCached(resource->GetResourceFilePath(), resource->GetResourceType()))
-                return GetByPath<T>(resource->GetResourceFilePath());
+            for (std::shared_ptr<IResource>& resource_cached : GetResources())
+            {
+                if (resource_cached->GetResourceType() == resource->GetResourceType() && resource_cached->GetResourceFilePath() == resource->GetResourceFilePath())
+                    return std::static_pointer_cast<T>(resource_cached);
+            }
 
             // if not, cache it and return the cached resource
-            std::lock_guard<std::mutex> guard(GetMutex());
             return std::static_pointer_cast<T>(GetResources().emplace_back(resource));
         }
 
@@ -111,28 +231,59 @@ namespace Spartan
             resource->SetResourceFilePath(file_path);
 
             // load
-            resource->LoadFromFile(file_path);
+            LoadFromFile(resource.get(), file_path);
 
             // returned cached reference which is guaranteed to be around after deserialization
             return Cache<T>(resource);
         }
 
+        // loads a resource on a worker and returns immediately, the gpu upload happens on the main thread within a per-frame budget
+        // concurrent requests for the same file share the same resource, the highest priority request is loaded first
+        template <class T>
+        static ResourceHandle<T> LoadAsync(const std::string& file_path, uint32_t flags = 0, const ResourceLoadPriority priority = ResourceLoadPriority::Normal)
+        {
+            if (!FileSystem::Exists(file_path))
+            {
+                SP_LOG_ERROR("\"%s\" doesn't exist.", file_path.c_str());
+                return ResourceHandle<T>();
+            }
+
+            // already loaded or loading
+            if (std::shared_ptr<ResourceLoadRequest> request = FindLoadRequest(file_path, IResource::TypeToEnum<T>(), priority))
+                return ResourceHandle<T>(request);
+
+            // create the placeholder
+            std::shared_ptr<T> resource = std::make_shared<T>();
+            if (flags != 0)
+            {
+                resource->SetFlags(flags);
+            }
+            resource->SetResourceFilePath(file_path);
+
+            return ResourceHandle<T>(AddLoadRequest(resource, file_path, priority));
+        }
+
+        // runs on the main thread, uploads loaded resources until the time budget runs out
+        static void Tick();
+        static void SetUploadBudget(const float budget_ms);
+        static uint32_t GetLoadRequestCount();
+
         template <class T>
         static void Remove(std::shared_ptr<T>& resource)
         {
             if (!resource)
                 return;
 
-            if (!IsCached(resource->GetObjectName(), resource->GetResourceType()))
-                return;
+            const uint64_t id = resource->GetObjectId();
 
+            std::lock_guard<std::mutex> guard(GetMutex());
             GetResources().erase
             (
                 std::remove_if
                 (
                     GetResources().begin(),
                     GetResources().end(),
-                    [](std::shared_ptr<IResource> resource) { return dynamic_cast<SpartanObject*>(resource.get())->GetObjectId() == resource->GetObjectId(); }
+                    [id](const std::shared_ptr<IResource>& cached) { return cached->GetObjectId() == id; }
                 ),
                 GetResources().end()
             );
@@ -157,6 +308,9 @@ namespace Spartan
         static void SetUseRootShaderDirectory(const bool use_root_shader_directory);
 
     private:
+        static std::shared_ptr<ResourceLoadRequest> FindLoadRequest(const std::string& file_path, const ResourceType type, const ResourceLoadPriority priority);
+        static std::shared_ptr<ResourceLoadRequest> AddLoadRequest(std::shared_ptr<IResource> resource, const std::string& file_path, const ResourceLoadPriority priority);
+        static void LoadFromFile(IResource* resource, const std::string& file_path);
         static bool IsCached(const uint64_t resource_id);
         static bool IsCached(const std::string& file_path, const ResourceType resource_type);
 
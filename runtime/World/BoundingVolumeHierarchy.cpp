@@ -0,0 +1,541 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ========================
+#include "pch.h"
+#include "BoundingVolumeHierarchy.h"
+#include "../Math/Frustum.h"
+#include "../Math/Ray.h"
+#include "../Math/Sphere.h"
+//===================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    namespace
+    {
+        // leaves are enlarged by this much (relative to their size, with a floor in meters)
+        // so that objects which move a little, don't have to be re-inserted
+        const float margin_relative = 0.1f;
+        const float margin_min      = 0.1f;
+
+        // balanced trees stay far below this height, even with millions of leaves
+        const uint32_t stack_size = 256;
+
+        BoundingBox merge(const BoundingBox& a, const BoundingBox& b)
+        {
+            BoundingBox box = a;
+            box.Merge(b);
+            return box;
+        }
+
+        float surface_area(const BoundingBox& box)
+        {
+            Vector3 size = box.GetSize();
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+
+        bool contains(const BoundingBox& outer, const BoundingBox& inner)
+        {
+            return outer.Intersects(inner) == Intersection::Inside;
+        }
+
+        BoundingBox enlarge(const BoundingBox& box)
+        {
+            Vector3 size   = box.GetSize();
+            Vector3 margin = Vector3(
+                max(size.x * margin_relative, margin_min),
+                max(size.y * margin_relative, margin_min),
+                max(size.z * margin_relative, margin_min)
+            );
+
+            return BoundingBox(box.GetMin() - margin, box.GetMax() + margin);
+        }
+
+        bool overlaps(const Sphere& sphere, const BoundingBox& box)
+        {
+            // squared distance from the center to the closest point of the box
+            const Vector3& box_min = box.GetMin();
+            const Vector3& box_max = box.GetMax();
+            Vector3 closest        = Vector3(
+                clamp(sphere.center.x, box_min.x, box_max.x),
+                clamp(sphere.center.y, box_min.y, box_max.y),
+                clamp(sphere.center.z, box_min.z, box_max.z)
+            );
+
+            return (closest - sphere.center).LengthSquared() <= sphere.radius * sphere.radius;
+        }
+    }
+
+    uint32_t BoundingVolumeHierarchy::Insert(const BoundingBox& box, Entity* entity)
+    {
+        SP_ASSERT(box != BoundingBox::Undefined);
+
+        uint32_t proxy = AllocateNode();
+        Node& node     = m_nodes[proxy];
+        node.box       = enlarge(box);
+        node.box_leaf  = box;
+        node.entity    = entity;
+        node.height    = 0;
+
+        InsertLeaf(proxy);
+        m_leaf_count++;
+
+        return proxy;
+    }
+
+    void BoundingVolumeHierarchy::Remove(const uint32_t proxy)
+    {
+        SP_ASSERT(proxy < m_nodes.size() && m_nodes[proxy].IsLeaf());
+
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        m_leaf_count--;
+    }
+
+    bool BoundingVolumeHierarchy::Update(const uint32_t proxy, const BoundingBox& box)
+    {
+        SP_ASSERT(proxy < m_nodes.size() && m_nodes[proxy].IsLeaf());
+        SP_ASSERT(box != BoundingBox::Undefined);
+
+        m_nodes[proxy].box_leaf = box;
+
+        // still inside the enlarged box, the tree is still valid
+        if (contains(m_nodes[proxy].box, box))
+            return false;
+
+        RemoveLeaf(proxy);
+        m_nodes[proxy].box = enlarge(box);
+        InsertLeaf(proxy);
+
+        return true;
+    }
+
+    void BoundingVolumeHierarchy::Query(const Frustum& frustum, frame_vector<Entity*>& results, const bool ignore_depth) const
+    {
+        if (m_root == node_null)
+            return;
+
+        array<uint32_t, stack_size> stack;
+        uint32_t stack_count = 0;
+        stack[stack_count++] = m_root;
+
+        while (stack_count > 0)
+        {
+            const Node& node = m_nodes[stack[--stack_count]];
+
+            if (node.IsLeaf())
+            {
+                if (frustum.CheckCube(node.box_leaf.GetCenter(), node.box_leaf.GetExtents(), ignore_depth) != Intersection::Outside)
+                {
+                    results.emplace_back(node.entity);
+                }
+
+                continue;
+            }
+
+            Intersection intersection = frustum.CheckCube(node.box.GetCenter(), node.box.GetExtents(), ignore_depth);
+            if (intersection == Intersection::Outside)
+                continue;
+
+            // fully visible, every leaf below is visible without further tests
+            if (intersection == Intersection::Inside)
+            {
+                CollectLeaves(node.left, results);
+                CollectLeaves(node.right, results);
+                continue;
+            }
+
+            SP_ASSERT(stack_count + 2 <= stack_size);
+            stack[stack_count++] = node.left;
+            stack[stack_count++] = node.right;
+        }
+    }
+
+    void BoundingVolumeHierarchy::Query(const Sphere& sphere, frame_vector<Entity*>& results) const
+    {
+        if (m_root == node_null)
+            return;
+
+        array<uint32_t, stack_size> stack;
+        uint32_t stack_count = 0;
+        stack[stack_count++] = m_root;
+
+        while (stack_count > 0)
+        {
+            const Node& node = m_nodes[stack[--stack_count]];
+
+            if (!overlaps(sphere, node.IsLeaf() ? node.box_leaf : node.box))
+                continue;
+
+            if (node.IsLeaf())
+            {
+                results.emplace_back(node.entity);
+                continue;
+            }
+
+            SP_ASSERT(stack_count + 2 <= stack_size);
+            stack[stack_count++] = node.left;
+            stack[stack_count++] = node.right;
+        }
+    }
+
+    void BoundingVolumeHierarchy::Query(const BoundingBox& box, frame_vector<Entity*>& results) const
+    {
+        if (m_root == node_null)
+            return;
+
+        array<uint32_t, stack_size> stack;
+        uint32_t stack_count = 0;
+        stack[stack_count++] = m_root;
+
+        while (stack_count > 0)
+        {
+            const Node& node = m_nodes[stack[--stack_count]];
+
+            if (box.Intersects(node.IsLeaf() ? node.box_leaf : node.box) == Intersection::Outside)
+                continue;
+
+            if (node.IsLeaf())
+            {
+                results.emplace_back(node.entity);
+                continue;
+            }
+
+            SP_ASSERT(stack_count + 2 <= stack_size);
+            stack[stack_count++] = node.left;
+            stack[stack_count++] = node.right;
+        }
+    }
+
+    void BoundingVolumeHierarchy::Query(const Ray& ray, frame_vector<pair<Entity*, float>>& results) const
+    {
+        if (m_root == node_null)
+            return;
+
+        array<uint32_t, stack_size> stack;
+        uint32_t stack_count = 0;
+        stack[stack_count++] = m_root;
+
+        while (stack_count > 0)
+        {
+            const Node& node = m_nodes[stack[--stack_count]];
+
+            float distance = ray.HitDistance(node.IsLeaf() ? node.box_leaf : node.box);
+            if (distance == Helper::INFINITY_)
+                continue;
+
+            if (node.IsLeaf())
+            {
+                results.emplace_back(node.entity, distance);
+                continue;
+            }
+
+            SP_ASSERT(stack_count + 2 <= stack_size);
+            stack[stack_count++] = node.left;
+            stack[stack_count++] = node.right;
+        }
+    }
+
+    void BoundingVolumeHierarchy::Clear()
+    {
+        m_nodes.clear();
+        m_root       = node_null;
+        m_free_list  = node_null;
+        m_leaf_count = 0;
+    }
+
+    uint32_t BoundingVolumeHierarchy::AllocateNode()
+    {
+        uint32_t index = m_free_list;
+        if (index == node_null)
+        {
+            index = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.emplace_back();
+        }
+        else
+        {
+            m_free_list = m_nodes[index].parent;
+        }
+
+        m_nodes[index]        = Node();
+        m_nodes[index].height = 0;
+
+        return index;
+    }
+
+    void BoundingVolumeHierarchy::FreeNode(const uint32_t index)
+    {
+        m_nodes[index]        = Node();
+        m_nodes[index].parent = m_free_list;
+        m_free_list           = index;
+    }
+
+    void BoundingVolumeHierarchy::InsertLeaf(const uint32_t leaf)
+    {
+        if (m_root == node_null)
+        {
+            m_root               = leaf;
+            m_nodes[leaf].parent = node_null;
+            return;
+        }
+
+        // find the best sibling, descending towards the child which grows the least (surface area heuristic)
+        const BoundingBox box_leaf = m_nodes[leaf].box;
+        uint32_t index             = m_root;
+        while (!m_nodes[index].IsLeaf())
+        {
+            const Node& node = m_nodes[index];
+
+            float area          = surface_area(node.box);
+            float area_combined = surface_area(merge(node.box, box_leaf));
+
+            // cost of creating a new parent for this node and the leaf
+            float cost = 2.0f * area_combined;
+
+            // minimum cost of pushing the leaf further down the tree
+            float cost_inheritance = 2.0f * (area_combined - area);
+
+            auto cost_descend = [&](const uint32_t child_index)
+            {
+                const Node& child = m_nodes[child_index];
+                float area_new    = surface_area(merge(child.box, box_leaf));
+                return (child.IsLeaf() ? area_new : area_new - surface_area(child.box)) + cost_inheritance;
+            };
+
+            float cost_left  = cost_descend(node.left);
+            float cost_right = cost_descend(node.right);
+
+            if (cost < cost_left && cost < cost_right)
+                break;
+
+            index = cost_left < cost_right ? node.left : node.right;
+        }
+        uint32_t sibling = index;
+
+        // create a new parent for the sibling and the leaf
+        uint32_t parent_old = m_nodes[sibling].parent;
+        uint32_t parent_new = AllocateNode();
+        {
+            Node& node  = m_nodes[parent_new];
+            node.parent = parent_old;
+            node.box    = merge(box_leaf, m_nodes[sibling].box);
+            node.height = m_nodes[sibling].height + 1;
+            node.left   = sibling;
+            node.right  = leaf;
+        }
+
+        if (parent_old != node_null)
+        {
+            Node& node = m_nodes[parent_old];
+            (node.left == sibling ? node.left : node.right) = parent_new;
+        }
+        else
+        {
+            m_root = parent_new;
+        }
+
+        m_nodes[sibling].parent = parent_new;
+        m_nodes[leaf].parent    = parent_new;
+
+        Refit(m_nodes[leaf].parent);
+    }
+
+    void BoundingVolumeHierarchy::RemoveLeaf(const uint32_t leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = node_null;
+            return;
+        }
+
+        uint32_t parent      = m_nodes[leaf].parent;
+        uint32_t grandparent = m_nodes[parent].parent;
+        uint32_t sibling     = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+
+        // the sibling takes the place of the parent
+        if (grandparent != node_null)
+        {
+            Node& node = m_nodes[grandparent];
+            (node.left == parent ? node.left : node.right) = sibling;
+            m_nodes[sibling].parent = grandparent;
+            FreeNode(parent);
+
+            Refit(grandparent);
+        }
+        else
+        {
+            m_root                  = sibling;
+            m_nodes[sibling].parent = node_null;
+            FreeNode(parent);
+        }
+
+        m_nodes[leaf].parent = node_null;
+    }
+
+    void BoundingVolumeHierarchy::Refit(uint32_t index)
+    {
+        // walk back up the tree, balancing and fixing the boxes and heights
+        while (index != node_null)
+        {
+            index = Balance(index);
+
+            Node& node  = m_nodes[index];
+            node.height = 1 + max(m_nodes[node.left].height, m_nodes[node.right].height);
+            node.box    = merge(m_nodes[node.left].box, m_nodes[node.right].box);
+
+            index = node.parent;
+        }
+    }
+
+    uint32_t BoundingVolumeHierarchy::Balance(const uint32_t index_a)
+    {
+        // performs a left or right rotation if a is imbalanced, returns the new root of the subtree
+        Node& a = m_nodes[index_a];
+        if (a.IsLeaf() || a.height < 2)
+            return index_a;
+
+        uint32_t index_b = a.left;
+        uint32_t index_c = a.right;
+        Node& b          = m_nodes[index_b];
+        Node& c          = m_nodes[index_c];
+        int32_t balance  = c.height - b.height;
+
+        auto replace_in_parent = [this](const uint32_t parent, const uint32_t child_old, const uint32_t child_new)
+        {
+            if (parent != node_null)
+            {
+                Node& node = m_nodes[parent];
+                (node.left == child_old ? node.left : node.right) = child_new;
+            }
+            else
+            {
+                m_root = child_new;
+            }
+        };
+
+        // rotate c up
+        if (balance > 1)
+        {
+            uint32_t index_f = c.left;
+            uint32_t index_g = c.right;
+            Node& f          = m_nodes[index_f];
+            Node& g          = m_nodes[index_g];
+
+            // swap a and c
+            c.left   = index_a;
+            c.parent = a.parent;
+            a.parent = index_c;
+            replace_in_parent(c.parent, index_a, index_c);
+
+            // rotate
+            if (f.height > g.height)
+            {
+                c.right  = index_f;
+                a.right  = index_g;
+                g.parent = index_a;
+                a.box    = merge(b.box, g.box);
+                c.box    = merge(a.box, f.box);
+                a.height = 1 + max(b.height, g.height);
+                c.height = 1 + max(a.height, f.height);
+            }
+            else
+            {
+                c.right  = index_g;
+                a.right  = index_f;
+                f.parent = index_a;
+                a.box    = merge(b.box, f.box);
+                c.box    = merge(a.box, g.box);
+                a.height = 1 + max(b.height, f.height);
+                c.height = 1 + max(a.height, g.height);
+            }
+
+            return index_c;
+        }
+
+        // rotate b up
+        if (balance < -1)
+        {
+            uint32_t index_d = b.left;
+            uint32_t index_e = b.right;
+            Node& d          = m_nodes[index_d];
+            Node& e          = m_nodes[index_e];
+
+            // swap a and b
+            b.left   = index_a;
+            b.parent = a.parent;
+            a.parent = index_b;
+            replace_in_parent(b.parent, index_a, index_b);
+
+            // rotate
+            if (d.height > e.height)
+            {
+                b.right  = index_d;
+                a.left   = index_e;
+                e.parent = index_a;
+                a.box    = merge(c.box, e.box);
+                b.box    = merge(a.box, d.box);
+                a.height = 1 + max(c.height, e.height);
+                b.height = 1 + max(a.height, d.height);
+            }
+            else
+            {
+                b.right  = index_e;
+                a.left   = index_d;
+                d.parent = index_a;
+                a.box    = merge(c.box, d.box);
+                b.box    = merge(a.box, e.box);
+                a.height = 1 + max(c.height, d.height);
+                b.height = 1 + max(a.height, e.height);
+            }
+
+            return index_b;
+        }
+
+        return index_a;
+    }
+
+    void BoundingVolumeHierarchy::CollectLeaves(const uint32_t index, frame_vector<Entity*>& results) const
+    {
+        array<uint32_t, stack_size> stack;
+        uint32_t stack_count = 0;
+        stack[stack_count++] = index;
+
+        while (stack_count > 0)
+        {
+            const Node& node = m_nodes[stack[--stack_count]];
+
+            if (node.IsLeaf())
+            {
+                results.emplace_back(node.entity);
+                continue;
+            }
+
+            SP_ASSERT(stack_count + 2 <= stack_size);
+            stack[stack_count++] = node.left;
+            stack[stack_count++] = node.right;
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =========================
+#include "../Math/BoundingBox.h"
+#include "../Core/FrameAllocator.h"
+//====================================
+
+namespace Spartan
+{
+    class Entity;
+    namespace Math
+    {
+        class Frustum;
+        class Ray;
+        class Sphere;
+    }
+
+    // a dynamic aabb tree, leaves are inserted, removed and refitted incrementally
+    // and the tree is kept balanced with rotations, so queries touch o(log n) nodes
+    class BoundingVolumeHierarchy
+    {
+    public:
+        static const uint32_t node_null = 0xFFFFFFFF;
+
+        // returns a proxy which identifies the leaf
+        uint32_t Insert(const Math::BoundingBox& box, Entity* entity);
+        void Remove(const uint32_t proxy);
+
+        // returns true if the leaf had to be moved within the tree
+        bool Update(const uint32_t proxy, const Math::BoundingBox& box);
+
+        // queries, the results are tested against the exact boxes of the leaves
+        void Query(const Math::Frustum& frustum, frame_vector<Entity*>& results, const bool ignore_depth = false) const;
+        void Query(const Math::Sphere& sphere, frame_vector<Entity*>& results) const;
+        void Query(const Math::BoundingBox& box, frame_vector<Entity*>& results) const;
+        void Query(const Math::Ray& ray, frame_vector<std::pair<Entity*, float>>& results) const; // entity and hit distance
+
+        void Clear();
+        Entity* GetEntity(const uint32_t proxy) const { return m_nodes[proxy].entity; }
+        uint32_t GetLeafCount() const                  { return m_leaf_count; }
+        uint32_t GetHeight() const                     { return m_root == node_null ? 0 : static_cast<uint32_t>(m_nodes[m_root].height); }
+
+    private:
+        struct Node
+        {
+            Math::BoundingBox box;      // enlarged, so that small movements don't change the tree
+            Math::BoundingBox box_leaf; // exact, leaves only
+            Entity* entity = nullptr;
+            uint32_t parent = node_null; // next free node, when the node is free
+            uint32_t left   = node_null;
+            uint32_t right  = node_null;
+            int32_t height  = -1;        // 0 for leaves, -1 for free nodes
+
+            bool IsLeaf() const { return left == node_null; }
+        };
+
+        uint32_t AllocateNode();
+        void FreeNode(const uint32_t index);
+        void InsertLeaf(const uint32_t leaf);
+        void RemoveLeaf(const uint32_t leaf);
+        void Refit(uint32_t index);
+        uint32_t Balance(const uint32_t index);
+        void CollectLeaves(const uint32_t index, frame_vector<Entity*>& results) const;
+
+        std::vector<Node> m_nodes;
+        uint32_t m_root       = node_null;
+        uint32_t m_free_list  = node_null;
+        uint32_t m_leaf_count = 0;
+    };
+}
@@ -40,4 +40,9 @@ namespace Spartan
     {
         Audio::SetListenerEntity(m_entity_ptr);
     }
+
+    void AudioListener::OnRemove()
+    {
+        Audio::ClearListenerEntity(m_entity_ptr);
+    }
 }
@@ -34,5 +34,6 @@ namespace Spartan
         ~AudioListener() = default;
 
         void OnTick() override;
+        void OnRemove() override;
     };
 }
@@ -128,6 +128,7 @@ namespace Spartan
         }
 
         m_audio_clip = ResourceCache::Load<AudioClip>(file_path);
+        MarkModified();
     }
 
     string AudioSource::GetAudioClipName() const
@@ -178,6 +179,7 @@ namespace Spartan
     
         m_mute = mute;
         m_audio_clip->SetMute(mute);
+        MarkModified();
     }
 
     void AudioSource::SetLoop(const bool loop)
@@ -187,6 +189,7 @@ namespace Spartan
 
         m_loop = loop;
         m_audio_clip->SetLoop(loop);
+        MarkModified();
 	}
 
 	void AudioSource::SetPriority(int priority)
@@ -198,6 +201,7 @@ namespace Spartan
         // to 256 (least important), default = 128.
         m_priority = static_cast<int>(Helper::Clamp(priority, 0, 255));
         m_audio_clip->SetPriority(m_priority);
+        MarkModified();
     }
     
     void AudioSource::SetVolume(float volume)
@@ -207,6 +211,7 @@ namespace Spartan
     
         m_volume = Helper::Clamp(volume, 0.0f, 1.0f);
         m_audio_clip->SetVolume(m_volume);
+        MarkModified();
     }
     
     void AudioSource::SetPitch(float pitch)
@@ -216,6 +221,7 @@ namespace Spartan
     
         m_pitch = Helper::Clamp(pitch, 0.0f, 3.0f);
         m_audio_clip->SetPitch(m_pitch);
+        MarkModified();
     }
     
     void AudioSource::SetPan(float pan)
@@ -226,6 +232,7 @@ namespace Spartan
         // Pan level, from -1.0 (left) to 1.0 (right).
         m_pan = Helper::Clamp(pan, -1.0f, 1.0f);
         m_audio_clip->SetPan(m_pan);
+        MarkModified();
     }
 
     void AudioSource::Set3d(const bool enabled)
@@ -234,6 +241,7 @@ namespace Spartan
             return;
 
         m_3d = enabled;
+        MarkModified();
         return m_audio_clip->Set3d(enabled);
     }
 }
@@ -105,6 +105,7 @@ namespace Spartan
         {
             m_near_plane = near_plane_limited;
             SetFlag(CameraFlags::IsDirty, true);
+            MarkModified();
         }
     }
 
@@ -112,12 +113,14 @@ namespace Spartan
     {
         m_far_plane = far_plane;
         SetFlag(CameraFlags::IsDirty, true);
+        MarkModified();
     }
 
     void Camera::SetProjection(const ProjectionType projection)
     {
         m_projection_type = projection;
         SetFlag(CameraFlags::IsDirty, true);
+        MarkModified();
     }
 
     float Camera::GetFovHorizontalDeg() const
@@ -134,6 +137,7 @@ namespace Spartan
     {
         m_fov_horizontal_rad = Helper::DegreesToRadians(fov);
         SetFlag(CameraFlags::IsDirty, true);
+        MarkModified();
     }
 
     bool Camera::IsInViewFrustum(const BoundingBox& bounding_box) const
@@ -172,40 +176,9 @@ namespace Spartan
             return;
         }
 
-        // traces ray against all AABBs in the world
-        Ray ray = ComputePickingRay();
-        vector<RayHit> hits;
-        {
-            const unordered_map<uint64_t, shared_ptr<Entity>>& entities = World::GetAllEntities();
-            for (auto it : entities)
-            {
-                shared_ptr<Entity> entity = it.second;
-
-                // Make sure there entity has a renderable
-                if (!entity->GetComponent<Renderable>())
-                    continue;
-
-                // Get object oriented bounding box
-                const BoundingBox& aabb = entity->GetComponent<Renderable>()->GetBoundingBox(BoundingBoxType::Transformed);
-
-                // Compute hit distance
-                float distance = ray.HitDistance(aabb);
-
-                // Don't store hit data if there was no hit
-                if (distance == Helper::INFINITY_)
-                    continue;
-
-                hits.emplace_back(
-                    entity,                                         // entity
-                    ray.GetStart() + ray.GetDirection() * distance, // position
-                    distance,                                       // distance
-                    distance == 0.0f                                // inside
-                );
-            }
-
-            // sort by distance (ascending)
-            sort(hits.begin(), hits.end(), [](const RayHit& a, const RayHit& b) { return a.m_distance < b.m_distance; });
-        }
+        // traces ray against the bounding volume hierarchy of the world
+        Ray ray                   = ComputePickingRay();
+        frame_vector<RayHit> hits = World::Query(ray);
 
         // check if there are any hits
         if (hits.empty())
@@ -91,15 +91,15 @@ namespace Spartan
 
         // aperture
         float GetAperture() const              { return m_aperture; }
-        void SetAperture(const float aperture) { m_aperture = aperture; }
+        void SetAperture(const float aperture) { m_aperture = aperture; MarkModified(); }
 
         // shutter speed
         float GetShutterSpeed() const                   { return m_shutter_speed; }
-        void SetShutterSpeed(const float shutter_speed) { m_shutter_speed = shutter_speed; }
+        void SetShutterSpeed(const float shutter_speed) { m_shutter_speed = shutter_speed; MarkModified(); }
 
         // iso
         float GetIso() const         { return m_iso; }
-        void SetIso(const float iso) { m_iso = iso; }
+        void SetIso(const float iso) { m_iso = iso; MarkModified(); }
 
         // exposure
         float GetEv100()    const { return std::log2(m_aperture / m_shutter_speed * 100.0f / m_iso); }
@@ -120,6 +120,7 @@ namespace Spartan
         void SetFovHorizontalDeg(float fov);
   
         // frustum
+        const Math::Frustum& GetFrustum() const { return m_frustum; }
         bool IsInViewFrustum(const Math::BoundingBox& bounding_box) const;
         bool IsInViewFrustum(std::shared_ptr<Renderable> renderable) const;
 
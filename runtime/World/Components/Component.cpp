@@ -29,6 +29,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "AudioSource.h"
 #include "AudioListener.h"
 #include "Terrain.h"
+#include "../Entity.h"
 //========================
 
 //= NAMESPACES =====
@@ -43,6 +44,14 @@ namespace Spartan
         m_enabled    = true;
     }
 
+    void Component::MarkModified()
+    {
+        if (m_entity_ptr)
+        {
+            m_entity_ptr->MarkModified();
+        }
+    }
+
     template <typename T>
     inline constexpr ComponentType Component::TypeToEnum() { return ComponentType::Max; }
 
@@ -124,6 +124,9 @@ namespace Spartan
             m_attributes.emplace_back(attribute);
         }
 
+        // setters of anything that gets serialized call this, so that the entity gets saved again
+        void MarkModified();
+
         // the type of the component
         ComponentType m_type = ComponentType::Max;
         // the state of the component
@@ -134,5 +137,10 @@ namespace Spartan
     private:
         // the attributes of the component
         std::vector<Attribute> m_attributes;
+
+        // where the component lives in its pool
+        friend class ComponentPool;
+        uint32_t m_pool_slot  = 0;
+        uint32_t m_pool_index = 0;
     };
 }
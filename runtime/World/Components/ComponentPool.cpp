@@ -0,0 +1,296 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========
+#include "pch.h"
+#include "ComponentPool.h"
+//=====================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    namespace
+    {
+        const uint32_t slots_per_chunk = 64;
+
+        struct component_pool
+        {
+            // only held for bookkeeping, never while components are visited
+            mutex mutex_pool;
+
+            // slots
+            size_t slot_size      = 0;
+            size_t slot_alignment = 0;
+            vector<byte*> chunks;
+            vector<uint32_t> generations;
+            vector<Component*> slot_components;
+            vector<uint32_t> slots_free;
+
+            // live components, what systems iterate over
+            vector<Component*> packed;
+
+            // while passes are running, packed is left alone and changes to it are applied once the last pass ends
+            uint32_t passes   = 0;
+            bool packed_dirty = false; // components were unlinked, they are compacted out
+            vector<Component*> links_pending;
+            vector<Component*> destroys_pending;
+        };
+
+        // never destroyed, components held by other statics can be released after this translation unit's statics are gone
+        array<component_pool, static_cast<uint32_t>(ComponentType::Max)>& pools = *new array<component_pool, static_cast<uint32_t>(ComponentType::Max)>();
+
+        thread_local bool linking_deferred = false;
+    }
+
+    void* ComponentPool::Allocate(const ComponentType type, const size_t size, const size_t alignment, ComponentHandle* handle)
+    {
+        component_pool& pool = pools[static_cast<uint32_t>(type)];
+        lock_guard<mutex> lock(pool.mutex_pool);
+
+        // all components of a type have the same size, it's set by the first one
+        if (pool.slot_size == 0)
+        {
+            pool.slot_alignment = max(alignment, alignof(max_align_t));
+            pool.slot_size      = (size + pool.slot_alignment - 1) & ~(pool.slot_alignment - 1);
+        }
+        SP_ASSERT(size <= pool.slot_size);
+
+        // grow by a chunk, existing chunks never move
+        if (pool.slots_free.empty())
+        {
+            uint32_t slot_first = static_cast<uint32_t>(pool.chunks.size()) * slots_per_chunk;
+            pool.chunks.emplace_back(static_cast<byte*>(::operator new(pool.slot_size * slots_per_chunk, align_val_t(pool.slot_alignment))));
+            pool.generations.resize(slot_first + slots_per_chunk, 0);
+            pool.slot_components.resize(slot_first + slots_per_chunk, nullptr);
+
+            // reversed, so that slots are handed out in address order
+            for (uint32_t i = slots_per_chunk; i > 0; i--)
+            {
+                pool.slots_free.emplace_back(slot_first + i - 1);
+            }
+        }
+
+        uint32_t slot = pool.slots_free.back();
+        pool.slots_free.pop_back();
+
+        handle->type       = type;
+        handle->slot       = slot;
+        handle->generation = pool.generations[slot];
+
+        return pool.chunks[slot / slots_per_chunk] + (slot % slots_per_chunk) * pool.slot_size;
+    }
+
+    void ComponentPool::Register(const shared_ptr<Component>& component, const ComponentHandle& handle)
+    {
+        component_pool& pool = pools[static_cast<uint32_t>(handle.type)];
+        lock_guard<mutex> lock(pool.mutex_pool);
+
+        component->m_type       = handle.type;
+        component->m_pool_slot  = handle.slot;
+        component->m_pool_index = index_unlinked;
+
+        pool.slot_components[handle.slot] = component.get();
+
+        if (!linking_deferred)
+        {
+            LinkLocked(component.get());
+        }
+    }
+
+    void ComponentPool::SetLinkingDeferred(const bool deferred)
+    {
+        linking_deferred = deferred;
+    }
+
+    void ComponentPool::Link(Component* component)
+    {
+        component_pool& pool = pools[static_cast<uint32_t>(component->m_type)];
+        lock_guard<mutex> lock(pool.mutex_pool);
+
+        LinkLocked(component);
+    }
+
+    void ComponentPool::Unlink(Component* component)
+    {
+        component_pool& pool = pools[static_cast<uint32_t>(component->m_type)];
+        lock_guard<mutex> lock(pool.mutex_pool);
+
+        UnlinkLocked(component);
+    }
+
+    void ComponentPool::LinkLocked(Component* component)
+    {
+        component_pool& pool = pools[static_cast<uint32_t>(component->m_type)];
+
+        if (component->m_pool_index != index_unlinked)
+            return;
+
+        if (pool.passes != 0)
+        {
+            pool.links_pending.emplace_back(component);
+            return;
+        }
+
+        component->m_pool_index = static_cast<uint32_t>(pool.packed.size());
+        pool.packed.emplace_back(component);
+    }
+
+    void ComponentPool::UnlinkLocked(Component* component)
+    {
+        component_pool& pool = pools[static_cast<uint32_t>(component->m_type)];
+
+        // marked, so that the running passes skip it, and compacted out when they end
+        if (pool.passes != 0)
+        {
+            pool.links_pending.erase(remove(pool.links_pending.begin(), pool.links_pending.end(), component), pool.links_pending.end());
+            if (component->m_pool_index != index_unlinked)
+            {
+                atomic_ref<uint32_t>(component->m_pool_index).store(index_unlinked, memory_order_relaxed);
+                pool.packed_dirty = true;
+            }
+
+            return;
+        }
+
+        if (component->m_pool_index == index_unlinked)
+            return;
+
+        // swap and pop
+        Component* last                 = pool.packed.back();
+        last->m_pool_index              = component->m_pool_index;
+        pool.packed[last->m_pool_index] = last;
+        pool.packed.pop_back();
+
+        component->m_pool_index = index_unlinked;
+    }
+
+    void ComponentPool::Destroy(Component* component)
+    {
+        component_pool& pool = pools[static_cast<uint32_t>(component->m_type)];
+        const uint32_t slot  = component->m_pool_slot;
+
+        // unlink it first, so that nobody visits it while it's being destroyed, a running pass might be
+        // about to visit it though, so then it's only destructed once the passes end
+        {
+            lock_guard<mutex> lock(pool.mutex_pool);
+
+            UnlinkLocked(component);
+            pool.slot_components[slot] = nullptr;
+            pool.generations[slot]++;
+
+            if (pool.passes != 0)
+            {
+                pool.destroys_pending.emplace_back(component);
+                return;
+            }
+        }
+
+        component->~Component();
+
+        lock_guard<mutex> lock(pool.mutex_pool);
+        pool.slots_free.emplace_back(slot);
+    }
+
+    Component* ComponentPool::Get(const ComponentHandle& handle)
+    {
+        if (handle.type == ComponentType::Max)
+            return nullptr;
+
+        component_pool& pool = pools[static_cast<uint32_t>(handle.type)];
+        lock_guard<mutex> lock(pool.mutex_pool);
+
+        if (handle.slot >= pool.generations.size() || pool.generations[handle.slot] != handle.generation)
+            return nullptr;
+
+        return pool.slot_components[handle.slot];
+    }
+
+    Component* const* ComponentPool::BeginPass(const ComponentType type, uint32_t* count)
+    {
+        component_pool& pool = pools[static_cast<uint32_t>(type)];
+        lock_guard<mutex> lock(pool.mutex_pool);
+
+        pool.passes++;
+        *count = static_cast<uint32_t>(pool.packed.size());
+
+        return pool.packed.data();
+    }
+
+    void ComponentPool::EndPass(const ComponentType type)
+    {
+        component_pool& pool = pools[static_cast<uint32_t>(type)];
+
+        vector<Component*> destroys;
+        {
+            lock_guard<mutex> lock(pool.mutex_pool);
+
+            if (--pool.passes != 0)
+                return;
+
+            if (pool.packed_dirty)
+            {
+                pool.packed.erase(remove_if(pool.packed.begin(), pool.packed.end(), [](Component* component) { return component->m_pool_index == index_unlinked; }), pool.packed.end());
+                for (uint32_t i = 0; i < static_cast<uint32_t>(pool.packed.size()); i++)
+                {
+                    pool.packed[i]->m_pool_index = i;
+                }
+                pool.packed_dirty = false;
+            }
+
+            for (Component* component : pool.links_pending)
+            {
+                LinkLocked(component);
+            }
+            pool.links_pending.clear();
+
+            destroys.swap(pool.destroys_pending);
+        }
+
+        // destructors can release other components, so they run without the lock
+        for (Component* component : destroys)
+        {
+            const uint32_t slot = component->m_pool_slot;
+            component->~Component();
+
+            lock_guard<mutex> lock(pool.mutex_pool);
+            pool.slots_free.emplace_back(slot);
+        }
+    }
+
+    uint32_t ComponentPool::GetCount(const ComponentType type)
+    {
+        component_pool& pool = pools[static_cast<uint32_t>(type)];
+        lock_guard<mutex> lock(pool.mutex_pool);
+
+        return static_cast<uint32_t>(pool.packed.size());
+    }
+
+    uint32_t ComponentPool::GetCapacity(const ComponentType type)
+    {
+        component_pool& pool = pools[static_cast<uint32_t>(type)];
+        lock_guard<mutex> lock(pool.mutex_pool);
+
+        return static_cast<uint32_t>(pool.generations.size());
+    }
+}
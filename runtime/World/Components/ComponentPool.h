@@ -0,0 +1,108 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========
+#include <memory>
+#include <atomic>
+#include <limits>
+#include "Component.h"
+//=====================
+
+namespace Spartan
+{
+    // a stable reference to a pooled component, it goes stale (instead of dangling) once the component is destroyed
+    struct ComponentHandle
+    {
+        ComponentType type  = ComponentType::Max;
+        uint32_t slot       = 0;
+        uint32_t generation = 0;
+    };
+
+    // dense storage for components, one pool per component type
+    // - components live in fixed size chunks, so their addresses never change and neighbours are contiguous in memory
+    // - each pool also keeps a packed array of its live components, which is what systems iterate over
+    // - slots are recycled, the shared_ptr that Create() returns gives the slot back when the last reference goes away
+    class ComponentPool
+    {
+    public:
+        template <class T>
+        static std::shared_ptr<T> Create(Entity* entity)
+        {
+            const ComponentType type = Component::TypeToEnum<T>();
+
+            ComponentHandle handle;
+            void* memory = Allocate(type, sizeof(T), alignof(T), &handle);
+
+            std::shared_ptr<T> component(new (memory) T(entity), [](T* component) { Destroy(component); });
+            Register(component, handle);
+
+            return component;
+        }
+
+        // returns nullptr if the component has been destroyed
+        static Component* Get(const ComponentHandle& handle);
+
+        // visits every live component of a type, in the order they are packed in memory, without holding the pool's lock
+        // while a pass runs the packed array doesn't change, linking, unlinking and destroying are deferred until it ends,
+        // so components created by the function are not visited, components destroyed or unlinked before their turn are skipped
+        template <class F>
+        static void ForEach(const ComponentType type, F&& function)
+        {
+            uint32_t count               = 0;
+            Component* const* components = BeginPass(type, &count);
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                Component* component = components[i];
+                if (std::atomic_ref<uint32_t>(component->m_pool_index).load(std::memory_order_relaxed) != index_unlinked)
+                {
+                    function(component);
+                }
+            }
+
+            EndPass(type);
+        }
+
+        // stops visiting a component whose entity has been removed from the world, it's destroyed once its last reference goes away
+        static void Unlink(Component* component);
+
+        // components that this thread creates while linking is deferred start out unlinked, they are visited once Link() is called
+        // this is how entities are built off the main thread (see World::BeginStaging())
+        static void SetLinkingDeferred(const bool deferred);
+        static void Link(Component* component);
+
+        static uint32_t GetCount(const ComponentType type);
+        static uint32_t GetCapacity(const ComponentType type);
+
+    private:
+        static constexpr uint32_t index_unlinked = std::numeric_limits<uint32_t>::max();
+
+        static Component* const* BeginPass(const ComponentType type, uint32_t* count);
+        static void EndPass(const ComponentType type);
+        static void LinkLocked(Component* component);   // expects the pool's lock to be held
+        static void UnlinkLocked(Component* component); // expects the pool's lock to be held
+        static void* Allocate(const ComponentType type, const size_t size, const size_t alignment, ComponentHandle* handle);
+        static void Register(const std::shared_ptr<Component>& component, const ComponentHandle& handle);
+        static void Destroy(Component* component);
+    };
+}
@@ -128,6 +128,7 @@ namespace Spartan
         {
             m_constraintType = type;
             Construct();
+            MarkModified();
         }
     }
 
@@ -137,6 +138,7 @@ namespace Spartan
         {
             m_position = position;
             ApplyFrames();
+            MarkModified();
         }
     }
 
@@ -146,6 +148,7 @@ namespace Spartan
         {
             m_rotation = rotation;
             ApplyFrames();
+            MarkModified();
         }
     }
 
@@ -180,6 +183,7 @@ namespace Spartan
 
         m_bodyOther = body_other;
         Construct();
+        MarkModified();
     }
 
     void Constraint::SetHighLimit(const Vector2& limit)
@@ -188,6 +192,7 @@ namespace Spartan
         {
             m_highLimit = limit;
             ApplyLimits();
+            MarkModified();
         }
     }
 
@@ -197,6 +202,7 @@ namespace Spartan
         {
             m_lowLimit = limit;
             ApplyLimits();
+            MarkModified();
         }
     }
 
@@ -238,7 +238,8 @@ namespace Spartan
             }
 
             m_filtering_pending = true;
-            SP_FIRE_EVENT(EventType::LightOnChanged);
+            SP_FIRE_EVENT_DEFERRED(EventType::LightOnChanged);
+            MarkModified();
         }
     }
 
@@ -254,7 +255,8 @@ namespace Spartan
         SetIntensity(get_sensible_intensity(m_light_type));
 
         UpdateMatrices();
-        World::Resolve();
+        World::Resolve(m_entity_ptr);
+        MarkModified();
     }
 
     void Light::SetTemperature(const float temperature_kelvin)
@@ -263,7 +265,8 @@ namespace Spartan
         m_color_rgb          = Color(temperature_kelvin);
 
         m_filtering_pending = true;
-        SP_FIRE_EVENT(EventType::LightOnChanged);
+        SP_FIRE_EVENT_DEFERRED(EventType::LightOnChanged);
+        MarkModified();
     }
 
     void Light::SetColor(const Color& rgb)
@@ -294,7 +297,8 @@ namespace Spartan
             m_temperature_kelvin = 5500.0f;
 
         m_filtering_pending = true;
-        SP_FIRE_EVENT(EventType::LightOnChanged);
+        SP_FIRE_EVENT_DEFERRED(EventType::LightOnChanged);
+        MarkModified();
     }
 
     void Light::SetIntensity(const LightIntensity intensity)
@@ -351,7 +355,8 @@ namespace Spartan
         }
 
         m_filtering_pending = true;
-        SP_FIRE_EVENT(EventType::LightOnChanged);
+        SP_FIRE_EVENT_DEFERRED(EventType::LightOnChanged);
+        MarkModified();
     }
 
     void Light::SetIntensity(const float lumens)
@@ -360,7 +365,8 @@ namespace Spartan
         m_intensity        = LightIntensity::custom;
 
         m_filtering_pending = true;
-        SP_FIRE_EVENT(EventType::LightOnChanged);
+        SP_FIRE_EVENT_DEFERRED(EventType::LightOnChanged);
+        MarkModified();
     }
 
     float Light::GetIntensityWatt() const
@@ -397,6 +403,7 @@ namespace Spartan
 
         m_range = range;
         UpdateMatrices();
+        MarkModified();
     }
 
     void Light::SetAngle(float angle)
@@ -407,6 +414,7 @@ namespace Spartan
 
         m_angle_rad = angle;
         UpdateMatrices();
+        MarkModified();
     }
 
     void Light::DisableFilterPending()
@@ -425,7 +433,7 @@ namespace Spartan
         ComputeViewMatrix();
         ComputeProjectionMatrix();
 
-        SP_FIRE_EVENT(EventType::LightOnChanged);
+        SP_FIRE_EVENT_DEFERRED(EventType::LightOnChanged);
     }
     
     void Light::ComputeViewMatrix()
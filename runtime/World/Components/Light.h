@@ -124,6 +124,7 @@ namespace Spartan
         RHI_Texture* GetColorTexture() const { return m_texture_color.get(); }
 
         // frustum
+        const Math::Frustum& GetFrustum(const uint32_t index) const { return m_frustums[index]; }
         bool IsInViewFrustum(const Math::BoundingBox& bounding_box, const uint32_t index) const;
         bool IsInViewFrustum(Renderable* renderable, const uint32_t index) const;
 
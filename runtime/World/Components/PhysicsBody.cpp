@@ -233,6 +233,7 @@ namespace Spartan
         {
             m_mass = mass;
             AddBodyToWorld();
+            MarkModified();
         }
     }
 
@@ -243,6 +244,7 @@ namespace Spartan
 
         m_friction = friction;
         rigid_body->setFriction(friction);
+        MarkModified();
     }
 
     void PhysicsBody::SetFrictionRolling(float frictionRolling)
@@ -252,6 +254,7 @@ namespace Spartan
 
         m_friction_rolling = frictionRolling;
         rigid_body->setRollingFriction(frictionRolling);
+        MarkModified();
     }
 
     void PhysicsBody::SetRestitution(float restitution)
@@ -261,6 +264,7 @@ namespace Spartan
 
         m_restitution = restitution;
         rigid_body->setRestitution(restitution);
+        MarkModified();
     }
 
     void PhysicsBody::SetUseGravity(bool gravity)
@@ -270,6 +274,7 @@ namespace Spartan
 
         m_use_gravity = gravity;
         AddBodyToWorld();
+        MarkModified();
     }
 
     void PhysicsBody::SetGravity(const Vector3& gravity)
@@ -279,6 +284,7 @@ namespace Spartan
 
         m_gravity = gravity;
         AddBodyToWorld();
+        MarkModified();
     }
 
     void PhysicsBody::SetIsKinematic(bool kinematic)
@@ -288,6 +294,7 @@ namespace Spartan
 
         m_is_kinematic = kinematic;
         AddBodyToWorld();
+        MarkModified();
     }
 
     void PhysicsBody::SetLinearVelocity(const Vector3& velocity, const bool activate /*= true*/) const
@@ -385,6 +392,7 @@ namespace Spartan
 
         m_position_lock = lock;
         rigid_body->setLinearFactor(ToBtVector3(Vector3::One - lock));
+        MarkModified();
     }
 
     void PhysicsBody::SetRotationLock(bool lock)
@@ -404,12 +412,14 @@ namespace Spartan
         btVector3 inertia;
         rigid_body->getCollisionShape()->calculateLocalInertia(m_mass, inertia);
         rigid_body->setMassProps(m_mass, inertia * ToBtVector3(Vector3::One - lock));
+        MarkModified();
     }
 
     void PhysicsBody::SetCenterOfMass(const Vector3& center_of_mass)
     {
         m_center_of_mass = center_of_mass;
         SetPosition(GetPosition());
+        MarkModified();
     }
 
     Vector3 PhysicsBody::GetPosition() const
@@ -680,6 +690,7 @@ namespace Spartan
         m_size.z = Helper::Clamp(m_size.z, Helper::SMALL_FLOAT, INFINITY);
 
         UpdateShape();
+        MarkModified();
     }
 
     void PhysicsBody::SetShapeType(PhysicsShape type)
@@ -698,6 +709,7 @@ namespace Spartan
 
         m_shape_type = type;
         UpdateShape();
+        MarkModified();
     }
 
     void PhysicsBody::SetBodyType(const PhysicsBodyType type)
@@ -707,6 +719,7 @@ namespace Spartan
 
         m_body_type = type;
         AddBodyToWorld();
+        MarkModified();
     }
     
     bool PhysicsBody::RayTraceIsGrounded() const
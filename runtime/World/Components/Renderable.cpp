@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Rendering/Renderer.h"
 #include "../RHI/RHI_Buffer.h"
 #include "../../IO/FileStream.h"
+#include "../../Core/ThreadPool.h"
 #include "../../Resource/ResourceCache.h"
 #include "../../Rendering/GridPartitioning.h"
 //===========================================
@@ -146,6 +147,9 @@ namespace Spartan
         SP_ASSERT(m_geometry_index_count       != 0);
         SP_ASSERT(m_geometry_vertex_count      != 0);
         SP_ASSERT(m_bounding_box != BoundingBox::Undefined);
+
+        World::Resolve(m_entity_ptr);
+        MarkModified();
     }
 
     void Renderable::SetGeometry(const MeshType type)
@@ -174,13 +178,22 @@ namespace Spartan
             {
                 m_bounding_box_transformed = BoundingBox::Undefined;
                 m_bounding_box_instances.clear();
-                m_bounding_box_instances.reserve(m_instances.size());
                 m_bounding_box_instances.resize(m_instances.size());
-                for (uint32_t i = 0; i < static_cast<uint32_t>(m_instances.size()); i++)
+
+                // 1. bounding box of each instance
+                auto transform_instances = [this, &transform](uint32_t start_index, uint32_t end_index)
+                {
+                    for (uint32_t i = start_index; i < end_index; i++)
+                    {
+                        m_bounding_box_instances[i] = m_bounding_box.Transform(transform * m_instances[i]);
+                    }
+                };
+                ThreadPool::ParallelLoop(transform_instances, static_cast<uint32_t>(m_instances.size()), 256);
+
+                // 2. bounding box of all instances
+                for (const BoundingBox& bounding_box_instance : m_bounding_box_instances)
                 {
-                    const Matrix& instance_transform = m_instances[i];
-                    m_bounding_box_instances[i]      = m_bounding_box.Transform(transform * instance_transform); // 1. bounding box of the instance
-                    m_bounding_box_transformed.Merge(m_bounding_box_instances[i]);                               // 2. bounding box of all instances
+                    m_bounding_box_transformed.Merge(bounding_box_instance);
                 }
 
                 // 3. bounding boxes of instance groups
@@ -194,8 +207,7 @@ namespace Spartan
                         BoundingBox bounding_box_group = BoundingBox::Undefined;
                         for (uint32_t i = start_index; i < group_end_index; i++)
                         {
-                            BoundingBox bounding_box_instance = m_bounding_box.Transform(transform * m_instances[i]);
-                            bounding_box_group.Merge(bounding_box_instance);
+                            bounding_box_group.Merge(m_bounding_box_instances[i]);
                         }
 
                         m_bounding_box_instance_group.push_back(bounding_box_group);
@@ -237,6 +249,9 @@ namespace Spartan
         { 
             m_material->PrepareForGpu();
         }
+
+        World::Resolve(m_entity_ptr);
+        MarkModified();
     }
 
     void Renderable::SetMaterial(const string& file_path)
@@ -252,6 +267,7 @@ namespace Spartan
     {
         SetMaterial(Renderer::GetStandardMaterial());
         m_material_default = true;
+        MarkModified();
     }
 
     string Renderable::GetMaterialName() const
@@ -309,6 +325,7 @@ namespace Spartan
         );
 
         m_bounding_box_dirty = true;
+        World::Resolve(m_entity_ptr);
     }
 
     void Renderable::SetFlag(const RenderableFlags flag, const bool enable /*= true*/)
@@ -328,5 +345,10 @@ namespace Spartan
             m_flags  &= ~static_cast<uint32_t>(flag);
             disabled  = true;
         }
+
+        if (enabled || disabled)
+        {
+            MarkModified();
+        }
     }
 }
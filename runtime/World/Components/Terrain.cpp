@@ -285,7 +285,7 @@ namespace Spartan
             };
 
             uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
-            ThreadPool::ParallelLoop(compute_vertex_normals_tangents, vertex_count);
+            ThreadPool::ParallelLoop(compute_vertex_normals_tangents, vertex_count, 1024);
         }
 
         float get_random_float(float x, float y)
@@ -136,8 +136,6 @@ namespace Spartan
         if (!m_is_active)
             return;
 
-        m_time_since_last_transform_sec += static_cast<float>(Timer::GetDeltaTimeSec());
-
         for (shared_ptr<Component>& component : m_components)
         {
             if (component)
@@ -229,7 +227,7 @@ namespace Spartan
                 }
             }
 
-            UpdateTransform();
+            MarkTransformDirty();
         }
 
         // COMPONENTS
@@ -275,23 +273,37 @@ namespace Spartan
             vector<weak_ptr<Entity>> children;
             for (uint32_t i = 0; i < children_count; i++)
             {
-                shared_ptr<Entity> child = World::CreateEntity();
-
-                child->SetObjectId(stream->ReadAs<uint64_t>());
+                shared_ptr<Entity> child = World::CreateEntity(stream->ReadAs<uint64_t>());
 
                 children.emplace_back(child);
             }
 
-            // Children
+            // Children, they add themselves to this entity
             for (const auto& child : children)
             {
                 child.lock()->Deserialize(stream, World::GetEntityById(m_object_id));
             }
-
-            AcquireChildren();
         }
 
-        World::Resolve();
+        World::Resolve(this);
+    }
+
+    void Entity::SetActive(const bool active)
+    {
+        if (m_is_active == active)
+            return;
+
+        m_is_active = active;
+        MarkModified();
+
+        // the whole subtree changes visibility, so the renderer needs to know about every entity in it
+        vector<Entity*> descendants;
+        GetDescendants(&descendants);
+        World::Resolve(this);
+        for (Entity* descendant : descendants)
+        {
+            World::Resolve(descendant);
+        }
     }
 
     bool Entity::IsActive() const
@@ -341,44 +353,92 @@ namespace Spartan
             }
         }
 
-        World::Resolve();
+        World::Resolve(this);
+        MarkModified();
     }
 
-    void Entity::UpdateTransform()
+    void Entity::UpdateTransform() const
     {
+        // claim the resolve, if another thread got to it first, wait for its result
+        TransformState expected = TransformState::Dirty;
+        if (!m_transform_state.compare_exchange_strong(expected, TransformState::Resolving, memory_order_acq_rel, memory_order_acquire))
+        {
+            while (m_transform_state.load(memory_order_acquire) == TransformState::Resolving)
+            {
+                this_thread::yield();
+            }
+
+            return;
+        }
+
         // compute local transform
-        m_matrix_local = Matrix(m_position_local, m_rotation_local, m_scale_local);
+        if (m_transform_dirty_local.exchange(false, memory_order_acquire))
+        {
+            m_matrix_local = Matrix(m_position_local, m_rotation_local, m_scale_local);
+        }
 
-        // compute world transform
-        if (!m_parent.expired())
+        // compute world transform (this resolves the parent first, if needed)
+        if (shared_ptr<Entity> parent = m_parent.lock())
         {
-            m_matrix = m_matrix_local * m_parent.lock()->GetMatrix();
+            m_matrix = m_matrix_local * parent->GetMatrix();
         }
         else
         {
             m_matrix = m_matrix_local;
         }
 
-        // update children
-        for (Entity* child : m_children)
-        {
-            child->UpdateTransform();
-        }
-
         // update directions
         {
+            Quaternion rotation = m_matrix.GetRotation();
+
             // z
-            m_forward  = GetRotation() * Vector3::Forward;
+            m_forward  = rotation * Vector3::Forward;
             m_backward = -m_forward;
             // y
-            m_up       = GetRotation() * Vector3::Up;
+            m_up       = rotation * Vector3::Up;
             m_down     = -m_up;
             // x
-            m_right    = GetRotation() * Vector3::Right;
+            m_right    = rotation * Vector3::Right;
             m_left     = -m_right;
         }
 
-        m_time_since_last_transform_sec = 0.0f;
+        // publishes the matrices and directions to threads that see the transform as clean
+        m_transform_state.store(TransformState::Clean, memory_order_release);
+        World::OnTransformUpdated();
+    }
+
+    void Entity::MarkTransformDirty(const bool local /*= true*/)
+    {
+        if (local)
+        {
+            m_transform_dirty_local.store(true, memory_order_release);
+            m_modified = true;
+        }
+        m_time_last_transform_sec = Timer::GetTimeSec();
+
+        // if already dirty, so are the descendants, if it's being resolved, let that finish first so that it's not marked clean afterwards
+        TransformState state = m_transform_state.load(memory_order_acquire);
+        while (true)
+        {
+            if (state == TransformState::Dirty)
+                return;
+
+            if (state == TransformState::Resolving)
+            {
+                this_thread::yield();
+                state = m_transform_state.load(memory_order_acquire);
+                continue;
+            }
+
+            if (m_transform_state.compare_exchange_weak(state, TransformState::Dirty, memory_order_acq_rel, memory_order_acquire))
+                break;
+        }
+
+        World::OnTransformDirty(this);
+        for (Entity* child : m_children)
+        {
+            child->MarkTransformDirty(false);
+        }
     }
 
     void Entity::SetPosition(const Vector3& position)
@@ -395,7 +455,7 @@ namespace Spartan
             return;
 
         m_position_local = position;
-        UpdateTransform();
+        MarkTransformDirty();
     }
 
     void Entity::SetRotation(const Quaternion& rotation)
@@ -412,7 +472,7 @@ namespace Spartan
             return;
 
         m_rotation_local = rotation;
-        UpdateTransform();
+        MarkTransformDirty();
     }
 
     void Entity::SetScale(const Vector3& scale)
@@ -435,7 +495,7 @@ namespace Spartan
         m_scale_local.y = (m_scale_local.y == 0.0f) ? Helper::SMALL_FLOAT : m_scale_local.y;
         m_scale_local.z = (m_scale_local.z == 0.0f) ? Helper::SMALL_FLOAT : m_scale_local.z;
 
-        UpdateTransform();
+        MarkTransformDirty();
     }
 
     void Entity::Translate(const Vector3& delta)
@@ -503,8 +563,8 @@ namespace Spartan
             {
                 for (Entity* child : m_children)
                 {
-                    child->m_parent = m_parent; // directly setting parent
-                    child->UpdateTransform();   // update transform if needed
+                    child->m_parent = m_parent;    // directly setting parent
+                    child->MarkTransformDirty(); // update transform if needed
                 }
         
                 m_children.clear();
@@ -524,17 +584,22 @@ namespace Spartan
             new_parent->AddChild(this);
         }
 
-        if ((parent && !new_parent) || (!parent && new_parent))
+        m_parent = new_parent_in;
+
+        if (parent != new_parent)
         {
-            UpdateTransform();
+            MarkTransformDirty();
         }
-
-        m_parent = new_parent_in;
     }
 
     void Entity::AddChild(Entity* child)
     {
         SP_ASSERT(child != nullptr);
+
+        // a thread that's staging entities can't modify the world, the child is adopted once it's attached
+        if (!World::CanModify(this))
+            return;
+
         lock_guard lock(m_mutex_children);
 
         // ensure that the child is not this transform
@@ -545,6 +610,11 @@ namespace Spartan
         if (!(find(m_children.begin(), m_children.end(), child) != m_children.end()))
         {
             m_children.emplace_back(child);
+            World::SetHierarchyDirty();
+            MarkModified();
+
+            // a staged child might have missed this entity moving, since it wasn't a child yet
+            child->MarkTransformDirty(false);
         }
     }
 
@@ -560,6 +630,8 @@ namespace Spartan
 
         // remove the child
         m_children.erase(remove_if(m_children.begin(), m_children.end(), [child](Entity* vec_transform) { return vec_transform->GetObjectId() == child->GetObjectId(); }), m_children.end());
+        World::SetHierarchyDirty();
+        MarkModified();
 
         // remove the child's parent
         if (update_child_with_null_parent)
@@ -576,6 +648,8 @@ namespace Spartan
         lock_guard lock(m_mutex_children);
         m_children.clear();
         m_children.shrink_to_fit();
+        World::SetHierarchyDirty();
+        MarkModified();
 
         const unordered_map<uint64_t, shared_ptr<Entity>>& entities = World::GetAllEntities();
         for (auto it : entities)
@@ -628,6 +702,30 @@ namespace Spartan
         }
     }
 
+    bool Entity::IsSubtreeModified() const
+    {
+        if (m_modified)
+            return true;
+
+        for (Entity* child : m_children)
+        {
+            if (child->IsSubtreeModified())
+                return true;
+        }
+
+        return false;
+    }
+
+    void Entity::ClearSubtreeModified()
+    {
+        m_modified = false;
+
+        for (Entity* child : m_children)
+        {
+            child->ClearSubtreeModified();
+        }
+    }
+
     Entity* Entity::GetDescendantByName(const string& name)
     {
         vector<Entity*> descendants;
@@ -645,7 +743,7 @@ namespace Spartan
     bool Entity::IsMoving() const
     {
         // an entity very rarely moves only for one frame, so we consider it moving if it has moved in the last 2 seconds
-        return m_time_since_last_transform_sec <= 2.0f;
+        return (Timer::GetTimeSec() - m_time_last_transform_sec) <= 2.0;
     }
 
     Matrix Entity::GetParentTransformMatrix() const
@@ -26,7 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <array>
 #include <mutex>
 #include "World.h"
-#include "Components/Component.h"
+#include "Components/ComponentPool.h"
 #include "../Math/Quaternion.h"
 #include "../Math/Matrix.h"
 //===============================
@@ -54,9 +54,20 @@ namespace Spartan
         void Serialize(FileStream* stream);
         void Deserialize(FileStream* stream, std::shared_ptr<Entity> parent);
 
+        // anything that gets serialized flags the entity as modified, so that saving can skip the subtrees that haven't changed
+        void MarkModified()      { m_modified = true; }
+        void ClearModified()     { m_modified = false; }
+        bool IsModified() const  { return m_modified; }
+        bool IsSubtreeModified() const;
+        void ClearSubtreeModified();
+
+        // name
+        void SetObjectName(const std::string& name) { m_object_name = name; MarkModified(); }
+
         // active
         bool IsActive() const;
-        void SetActive(const bool active) { m_is_active = active; }
+        bool IsActiveSelf() const         { return m_is_active; } // ignores the parents
+        void SetActive(const bool active);
 
         // adds a component of type T
         template <class T>
@@ -68,8 +79,8 @@ namespace Spartan
             if (std::shared_ptr<T> component = GetComponent<T>())
                 return component;
 
-            // create a new component
-            std::shared_ptr<T> component = std::make_shared<T>(this);
+            // create a new component, it lives in the pool of its type
+            std::shared_ptr<T> component = ComponentPool::Create<T>(this);
 
             // save new component
             m_components[static_cast<uint32_t>(type)] = std::static_pointer_cast<Component>(component);
@@ -78,7 +89,8 @@ namespace Spartan
             component->SetType(type);
             component->OnInitialize();
 
-            World::Resolve();
+            World::Resolve(this);
+            MarkModified();
 
             return component;
         }
@@ -101,28 +113,29 @@ namespace Spartan
             const ComponentType component_type = Component::TypeToEnum<T>();
             m_components[static_cast<uint32_t>(component_type)] = nullptr;
 
-            World::Resolve();
+            World::Resolve(this);
+            MarkModified();
         }
 
         void RemoveComponentById(uint64_t id);
         const auto& GetAllComponents() const { return m_components; }
 
         //= POSITION ======================================================================
-        Math::Vector3 GetPosition()             const { return m_matrix.GetTranslation(); }
+        Math::Vector3 GetPosition()             const { return GetMatrix().GetTranslation(); }
         const Math::Vector3& GetPositionLocal() const { return m_position_local; }
         void SetPosition(const Math::Vector3& position);
         void SetPositionLocal(const Math::Vector3& position);
         //=================================================================================
 
         //= ROTATION ======================================================================
-        Math::Quaternion GetRotation()             const { return m_matrix.GetRotation(); }
+        Math::Quaternion GetRotation()             const { return GetMatrix().GetRotation(); }
         const Math::Quaternion& GetRotationLocal() const { return m_rotation_local; }
         void SetRotation(const Math::Quaternion& rotation);
         void SetRotationLocal(const Math::Quaternion& rotation);
         //=================================================================================
 
         //= SCALE ================================================================
-        Math::Vector3 GetScale()             const { return m_matrix.GetScale(); }
+        Math::Vector3 GetScale()             const { return GetMatrix().GetScale(); }
         const Math::Vector3& GetScaleLocal() const { return m_scale_local; }
         void SetScale(const Math::Vector3& scale);
         void SetScaleLocal(const Math::Vector3& scale);
@@ -133,14 +146,14 @@ namespace Spartan
         void Rotate(const Math::Quaternion& delta);
         //=========================================
 
-        //= DIRECTIONS ================================================
-        const Math::Vector3& GetUp() const       { return m_up; }
-        const Math::Vector3& GetDown() const     { return m_down; }
-        const Math::Vector3& GetForward() const  { return m_forward; }
-        const Math::Vector3& GetBackward() const { return m_backward; }
-        const Math::Vector3& GetRight() const    { return m_right; }
-        const Math::Vector3& GetLeft() const     { return m_left; }
-        //=============================================================
+        //= DIRECTIONS ====================================================================
+        const Math::Vector3& GetUp() const       { ResolveTransform(); return m_up; }
+        const Math::Vector3& GetDown() const     { ResolveTransform(); return m_down; }
+        const Math::Vector3& GetForward() const  { ResolveTransform(); return m_forward; }
+        const Math::Vector3& GetBackward() const { ResolveTransform(); return m_backward; }
+        const Math::Vector3& GetRight() const    { ResolveTransform(); return m_right; }
+        const Math::Vector3& GetLeft() const     { ResolveTransform(); return m_left; }
+        //=================================================================================
 
         //= HIERARCHY ===================================================================================
         void SetParent(std::weak_ptr<Entity> new_parent);
@@ -160,17 +173,25 @@ namespace Spartan
         std::vector<Entity*>& GetChildren()       { return m_children; }
         //===============================================================================================
 
-        const Math::Matrix& GetMatrix() const              { return m_matrix; }
-        const Math::Matrix& GetLocalMatrix() const         { return m_matrix_local; }
+        const Math::Matrix& GetMatrix() const              { ResolveTransform(); return m_matrix; }
+        const Math::Matrix& GetLocalMatrix() const         { ResolveTransform(); return m_matrix_local; }
         const Math::Matrix& GetMatrixPrevious() const      { return m_matrix_previous; }
         void SetMatrixPrevious(const Math::Matrix& matrix) { m_matrix_previous = matrix; }
         bool IsMoving() const;
 
+        // setters only flag the transform (and the descendants) as dirty, the world resolves all dirty
+        // transforms once per frame, the getters resolve on demand if they get to a dirty one first
+        // any number of threads can resolve concurrently, one computes and the others wait for its result
+        bool IsTransformDirty() const { return m_transform_state.load(std::memory_order_acquire) != TransformState::Clean; }
+        void ResolveTransform() const { if (IsTransformDirty()) UpdateTransform(); }
+        void UpdateTransform() const;
+
     private:
         std::atomic<bool> m_is_active = true;
+        std::atomic<bool> m_modified  = true;
         std::array<std::shared_ptr<Component>, 13> m_components;
 
-        void UpdateTransform();
+        void MarkTransformDirty(const bool local = true);
         Math::Matrix GetParentTransformMatrix() const;
 
         // local
@@ -178,17 +199,21 @@ namespace Spartan
         Math::Quaternion m_rotation_local = Math::Quaternion::Identity;
         Math::Vector3 m_scale_local       = Math::Vector3::One;
 
-        Math::Matrix m_matrix          = Math::Matrix::Identity;
-        Math::Matrix m_matrix_previous = Math::Matrix::Identity;
-        Math::Matrix m_matrix_local    = Math::Matrix::Identity;
+        // world, resolved lazily
+        mutable Math::Matrix m_matrix       = Math::Matrix::Identity;
+        mutable Math::Matrix m_matrix_local = Math::Matrix::Identity;
+        enum class TransformState : uint8_t { Clean, Dirty, Resolving };
+        mutable std::atomic<TransformState> m_transform_state = TransformState::Dirty; // if dirty, so are all the descendants
+        mutable std::atomic<bool> m_transform_dirty_local     = true;
+        Math::Matrix m_matrix_previous      = Math::Matrix::Identity;
 
         // computed during UpdateTransform() and cached for performance
-        Math::Vector3 m_forward  = Math::Vector3::Zero;
-        Math::Vector3 m_backward = Math::Vector3::Zero;
-        Math::Vector3 m_up       = Math::Vector3::Zero;
-        Math::Vector3 m_down     = Math::Vector3::Zero;
-        Math::Vector3 m_right    = Math::Vector3::Zero;
-        Math::Vector3 m_left     = Math::Vector3::Zero;
+        mutable Math::Vector3 m_forward  = Math::Vector3::Zero;
+        mutable Math::Vector3 m_backward = Math::Vector3::Zero;
+        mutable Math::Vector3 m_up       = Math::Vector3::Zero;
+        mutable Math::Vector3 m_down     = Math::Vector3::Zero;
+        mutable Math::Vector3 m_right    = Math::Vector3::Zero;
+        mutable Math::Vector3 m_left     = Math::Vector3::Zero;
 
         std::weak_ptr<Entity> m_parent;  // the parent of this entity
         std::vector<Entity*> m_children; // the children of this entity
@@ -196,6 +221,6 @@ namespace Spartan
         // misc
         std::mutex m_mutex_children;
         std::mutex m_mutex_parent;
-        float m_time_since_last_transform_sec = 0.0f;
+        double m_time_last_transform_sec = 0.0;
     };
 }
@@ -25,10 +25,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Entity.h"
 #include "../Game/Game.h"
 #include "../IO/FileStream.h"
+#include "../IO/AsyncIo.h"
+#include "../IO/Package.h"
 #include "../Profiling/Profiler.h"
 #include "../Rendering/Renderer.h"
 #include "../Core/ProgressTracker.h"
+#include "WorldStreaming.h"
+#include "BoundingVolumeHierarchy.h"
 #include "Components/Renderable.h"
+#include "../Core/ThreadPool.h"
+#include "../Audio/Audio.h"
 //==================================
 
 //= NAMESPACES ===============
@@ -47,6 +53,348 @@ namespace Spartan
         bool resolve             = false;
         bool was_in_editor_mode  = false;
         BoundingBox bounding_box = BoundingBox::Undefined;
+
+        // entities that this thread is building outside of the world (see World::BeginStaging())
+        thread_local bool staging = false;
+        thread_local unordered_map<uint64_t, shared_ptr<Entity>> staged;
+
+        // entities that were added, changed or removed since the renderer was last notified
+        mutex resolve_mutex;
+        vector<uint64_t> resolve_entity_ids;
+
+        // bounding volume hierarchy over the renderables, entities are taken out of it
+        // as soon as they are removed from the world, so its entity pointers are always valid
+        BoundingVolumeHierarchy bvh;
+        unordered_map<uint64_t, uint32_t> bvh_proxies; // entity id -> proxy
+        mutex bvh_mutex;
+        bool bvh_rebuild = true;
+        vector<uint64_t> bvh_entities_dirty; // might have gained or lost a renderable (guarded by resolve_mutex)
+        vector<uint64_t> bvh_entities_moved; // transform changed (guarded by resolve_mutex)
+
+        // expects bvh_mutex to be locked
+        void bvh_update(Entity* entity)
+        {
+            shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
+            const BoundingBox& box            = renderable ? renderable->GetBoundingBox(BoundingBoxType::Transformed) : BoundingBox::Undefined;
+            auto it                           = bvh_proxies.find(entity->GetObjectId());
+
+            if (box == BoundingBox::Undefined)
+            {
+                if (it != bvh_proxies.end())
+                {
+                    bvh.Remove(it->second);
+                    bvh_proxies.erase(it);
+                }
+            }
+            else if (it == bvh_proxies.end())
+            {
+                bvh_proxies[entity->GetObjectId()] = bvh.Insert(box, entity);
+            }
+            else
+            {
+                bvh.Update(it->second, box);
+            }
+        }
+
+        // expects bvh_mutex to be locked
+        void bvh_remove(const uint64_t entity_id)
+        {
+            auto it = bvh_proxies.find(entity_id);
+            if (it != bvh_proxies.end())
+            {
+                bvh.Remove(it->second);
+                bvh_proxies.erase(it);
+            }
+        }
+
+        // refits the leaves of the entities that moved, this runs before every query so the tree is never stale
+        // expects bvh_mutex to be locked
+        void bvh_refit()
+        {
+            static vector<uint64_t> ids;
+            {
+                lock_guard lock(resolve_mutex);
+                if (bvh_entities_moved.empty())
+                    return;
+
+                ids.swap(bvh_entities_moved);
+            }
+
+            for (const uint64_t id : ids)
+            {
+                auto it = bvh_proxies.find(id);
+                if (it != bvh_proxies.end())
+                {
+                    bvh_update(bvh.GetEntity(it->second));
+                }
+            }
+            ids.clear();
+        }
+
+        // expects entity_access_mutex to be locked
+        void bvh_sync()
+        {
+            static vector<uint64_t> ids;
+            {
+                lock_guard lock(resolve_mutex);
+                ids.swap(bvh_entities_dirty);
+            }
+
+            lock_guard lock(bvh_mutex);
+
+            if (bvh_rebuild)
+            {
+                bvh.Clear();
+                bvh_proxies.clear();
+                for (auto& it : entities)
+                {
+                    bvh_update(it.second.get());
+                }
+                bvh_rebuild = false;
+            }
+            else
+            {
+                for (const uint64_t id : ids)
+                {
+                    auto it = entities.find(id);
+                    if (it != entities.end())
+                    {
+                        bvh_update(it->second.get());
+                    }
+                    else
+                    {
+                        bvh_remove(id);
+                    }
+                }
+            }
+            ids.clear();
+
+            bvh_refit();
+        }
+
+        // world files are a header, one chunk per root entity with its whole subtree, so each chunk can be read
+        // independently, and a table of contents at the end, saving appends the chunks that changed and a new table
+        // of contents, then patches the header to point at it, chunks that are no longer referenced are dead space
+        const uint32_t world_file_magic   = 0x444C5257; // "WRLD"
+        const uint32_t world_file_version = 3;          // 1 had no header, 2 had the table of contents after the header
+        const uint64_t world_file_header  = sizeof(uint32_t) * 2 + sizeof(uint64_t); // magic, version, table of contents offset
+
+        struct world_chunk
+        {
+            uint64_t entity_id = 0;
+            uint64_t offset    = 0; // from the start of the file
+            uint64_t size      = 0;
+        };
+
+        // the file as it was last written or read, saving appends to it as long as nothing else touched it
+        struct world_file_state
+        {
+            string path;
+            uint64_t size = 0;
+            unordered_map<uint64_t, world_chunk> chunks; // entity id -> chunk
+        };
+        world_file_state world_file;
+        future<void> world_save_task;
+        atomic<bool> world_save_failed = false;    // set by the write, handled on the main thread once it's done
+        vector<weak_ptr<Entity>> world_save_roots; // the roots that the write serialized
+
+        // a root entity as it's about to be written, the data is empty if its chunk is already in the file
+        struct world_snapshot
+        {
+            world_chunk chunk;
+            string data;
+        };
+
+        enum class read_result
+        {
+            success,
+            unsupported, // a newer version than this one
+            corrupted    // cut short, or the header doesn't make sense
+        };
+
+        // the header and the table of contents, the stream is left where the root entities of files without chunks begin
+        read_result read_table_of_contents(FileStream& file, uint32_t* version, vector<world_chunk>* chunks)
+        {
+            // files that predate the chunked format start with the root entity count
+            uint32_t root_entity_count = file.ReadAs<uint32_t>();
+            *version                   = 1;
+            if (root_entity_count == world_file_magic)
+            {
+                *version = file.ReadAs<uint32_t>();
+                if (!file.IsGood() || *version < 2)
+                    return read_result::corrupted;
+
+                if (*version > world_file_version)
+                    return read_result::unsupported;
+
+                // since version 3 the table of contents is at the end
+                if (*version >= 3)
+                {
+                    // seeking clears the stream's error state, so a failed read has to be caught before it
+                    const uint64_t offset = file.ReadAs<uint64_t>();
+                    if (!file.IsGood())
+                        return read_result::corrupted;
+
+                    file.Seek(offset);
+                }
+
+                root_entity_count = file.ReadAs<uint32_t>();
+            }
+
+            // or just the root entity IDs, a corrupted count runs into the end of the file instead of reserving for all of it
+            for (uint32_t i = 0; i < root_entity_count && file.IsGood(); i++)
+            {
+                world_chunk& chunk = chunks->emplace_back();
+                file.Read(&chunk.entity_id);
+                if (*version >= 2)
+                {
+                    file.Read(&chunk.offset);
+                    file.Read(&chunk.size);
+                }
+            }
+
+            return file.IsGood() ? read_result::success : read_result::corrupted;
+        }
+
+        void wait_for_save()
+        {
+            if (world_save_task.valid())
+            {
+                world_save_task.wait();
+                world_save_task = future<void>();
+            }
+
+            // the snapshot cleared the modified flags, they are set again so that the next save writes these roots
+            if (world_save_failed.exchange(false))
+            {
+                for (const weak_ptr<Entity>& root : world_save_roots)
+                {
+                    if (shared_ptr<Entity> entity = root.lock())
+                    {
+                        entity->MarkModified();
+                    }
+                }
+            }
+            world_save_roots.clear();
+        }
+
+        // flattened transform hierarchy, sorted by depth so that parents always come before their children
+        vector<Entity*> transforms;
+        vector<uint32_t> transform_depth_offsets; // where each depth starts in transforms, plus the end
+        vector<uint64_t> transforms_dirty_ids;    // marked dirty since the last update (guarded by resolve_mutex)
+        vector<vector<Entity*>> transforms_dirty; // what the next update resolves, by depth
+        atomic<bool> transform_hierarchy_dirty  = true;
+        atomic<uint32_t> transform_update_count = 0;
+        uint32_t transform_update_count_last    = 0;
+
+        // expects entity_access_mutex to be locked
+        void build_transform_hierarchy()
+        {
+            transforms.clear();
+            transform_depth_offsets.clear();
+
+            // roots
+            for (auto& it : entities)
+            {
+                if (!it.second->HasParent())
+                {
+                    transforms.emplace_back(it.second.get());
+                }
+            }
+
+            // one depth at a time
+            uint32_t depth_start = 0;
+            while (depth_start < transforms.size())
+            {
+                uint32_t depth_end = static_cast<uint32_t>(transforms.size());
+                transform_depth_offsets.emplace_back(depth_start);
+
+                for (uint32_t i = depth_start; i < depth_end; i++)
+                {
+                    for (Entity* child : transforms[i]->GetChildren())
+                    {
+                        transforms.emplace_back(child);
+                    }
+                }
+
+                depth_start = depth_end;
+            }
+            transform_depth_offsets.emplace_back(static_cast<uint32_t>(transforms.size()));
+
+            transform_hierarchy_dirty = false;
+        }
+
+        void add_dirty_transform(Entity* entity, const uint32_t depth)
+        {
+            if (transforms_dirty.size() <= depth)
+            {
+                transforms_dirty.resize(depth + 1);
+            }
+
+            transforms_dirty[depth].emplace_back(entity);
+        }
+
+        // resolves all dirty transforms, depth by depth, each depth is spread across threads, a frame where nothing moved costs nothing
+        // expects entity_access_mutex to be locked
+        void update_transforms()
+        {
+            vector<uint64_t> ids;
+            {
+                lock_guard lock(resolve_mutex);
+                ids.swap(transforms_dirty_ids);
+            }
+
+            // a changed hierarchy can hold new entities, which start out dirty without being reported, so all of it is checked
+            if (transform_hierarchy_dirty)
+            {
+                build_transform_hierarchy();
+
+                for (uint32_t depth = 0; depth + 1 < transform_depth_offsets.size(); depth++)
+                {
+                    for (uint32_t i = transform_depth_offsets[depth]; i < transform_depth_offsets[depth + 1]; i++)
+                    {
+                        if (transforms[i]->IsTransformDirty())
+                        {
+                            add_dirty_transform(transforms[i], depth);
+                        }
+                    }
+                }
+            }
+            else
+            {
+                for (const uint64_t id : ids)
+                {
+                    // skip the ones that were removed, or resolved on demand since
+                    auto it = entities.find(id);
+                    if (it == entities.end() || !it->second->IsTransformDirty())
+                        continue;
+
+                    uint32_t depth = 0;
+                    for (shared_ptr<Entity> parent = it->second->GetParent(); parent; parent = parent->GetParent())
+                    {
+                        depth++;
+                    }
+
+                    add_dirty_transform(it->second.get(), depth);
+                }
+            }
+
+            for (vector<Entity*>& entities_dirty : transforms_dirty)
+            {
+                if (entities_dirty.empty())
+                    continue;
+
+                ThreadPool::ParallelLoop([&entities_dirty](uint32_t start, uint32_t end)
+                {
+                    for (uint32_t i = start; i < end; i++)
+                    {
+                        entities_dirty[i]->ResolveTransform();
+                    }
+                }, static_cast<uint32_t>(entities_dirty.size()), 256);
+
+                entities_dirty.clear();
+            }
+        }
     }
 
     void World::Initialize()
@@ -56,6 +404,7 @@ namespace Spartan
 
     void World::Shutdown()
     {
+        wait_for_save();
         Game::Shutdown();
         Clear();
     }
@@ -73,49 +422,143 @@ namespace Spartan
             const bool stopped = !Engine::IsFlagSet(EngineMode::Playing) && !was_in_editor_mode;
             was_in_editor_mode = !Engine::IsFlagSet(EngineMode::Playing);
 
-            // start
-            if (started)
+            // components are updated system style, one type at a time, walking the densely packed pool of each type
+            auto for_each_component = [](const auto& function)
             {
-                for (auto it : entities)
+                for (uint32_t type = 0; type < static_cast<uint32_t>(ComponentType::Max); type++)
                 {
-                    it.second->OnStart();
+                    ComponentPool::ForEach(static_cast<ComponentType>(type), function);
                 }
+            };
+
+            // start
+            if (started)
+            {
+                for_each_component([](Component* component) { component->OnStart(); });
             }
 
             // stop
             if (stopped)
             {
-                for (auto it : entities)
-                {
-                    it.second->OnStop();
-                }
+                for_each_component([](Component* component) { component->OnStop(); });
             }
 
             // tick
-            for (auto it : entities)
+            for_each_component([](Component* component)
             {
-                it.second->Tick();
-            }
+                if (component->GetEntity()->IsActiveSelf())
+                {
+                    component->OnTick();
+                }
+            });
+        }
+
+        // a background save that has finished is handled here, so that a failed one marks its roots modified again
+        if (world_save_task.valid() && world_save_task.wait_for(chrono::seconds(0)) == future_status::ready)
+        {
+            wait_for_save();
         }
 
+        // resolve the transforms that changed this frame, in one batch
+        update_transforms();
+        transform_update_count_last = transform_update_count.exchange(0, memory_order_relaxed);
+
+        // bring the bounding volume hierarchy up to date with the renderables
+        bvh_sync();
+
         // notify renderer
-        if (resolve && !ProgressTracker::IsLoading())
+        if (!ProgressTracker::IsLoading())
         {
-            Renderer::SetEntities(entities);
-            resolve      = false;
-            bounding_box = BoundingBox::Undefined;
+            vector<uint64_t> ids;
+            {
+                lock_guard lock(resolve_mutex);
+                ids.swap(resolve_entity_ids);
+            }
+
+            if (resolve)
+            {
+                Renderer::SetEntities(entities);
+                resolve      = false;
+                bounding_box = BoundingBox::Undefined;
+            }
+            else if (!ids.empty())
+            {
+                // only hand over what changed, anything that's no longer in the world was removed
+                sort(ids.begin(), ids.end());
+                ids.erase(unique(ids.begin(), ids.end()), ids.end());
+
+                vector<shared_ptr<Entity>> entities_changed;
+                vector<uint64_t> entities_removed;
+                for (const uint64_t id : ids)
+                {
+                    auto it = entities.find(id);
+                    if (it != entities.end())
+                    {
+                        entities_changed.emplace_back(it->second);
+                    }
+                    else
+                    {
+                        entities_removed.emplace_back(id);
+                    }
+                }
+
+                Renderer::UpdateEntities(entities_changed, entities_removed);
+                bounding_box = BoundingBox::Undefined;
+            }
         }
 
         Game::Tick();
     }
 
+    void World::SetHierarchyDirty()
+    {
+        transform_hierarchy_dirty = true;
+    }
+
+    void World::OnTransformDirty(const Entity* entity)
+    {
+        lock_guard lock(resolve_mutex);
+        bvh_entities_moved.emplace_back(entity->GetObjectId());
+        transforms_dirty_ids.emplace_back(entity->GetObjectId());
+    }
+
+    void World::OnTransformUpdated()
+    {
+        transform_update_count.fetch_add(1, memory_order_relaxed);
+    }
+
+    uint32_t World::GetTransformUpdateCount()
+    {
+        return transform_update_count_last;
+    }
+
     void World::Clear()
     {
+        // forget the streamed out entities, before the resident ones go away
+        WorldStreaming::Clear();
+
         // fire event
         SP_FIRE_EVENT(EventType::WorldClear);
         
         // clear
+        {
+            lock_guard lock(bvh_mutex);
+            bvh.Clear();
+            bvh_proxies.clear();
+            bvh_rebuild = true;
+        }
+        for (const auto& it : entities)
+        {
+            for (const shared_ptr<Component>& component : it.second->GetAllComponents())
+            {
+                if (component)
+                {
+                    ComponentPool::Unlink(component.get());
+                }
+            }
+        }
         entities.clear();
+        transform_hierarchy_dirty = true;
         name.clear();
         file_path.clear();
         
@@ -123,64 +566,196 @@ namespace Spartan
         resolve = true;
     }
 
-    bool World::SaveToFile(const string& file_path_in)
+    bool World::SaveToFile(const string& file_path_in, const bool background)
     {
+        // one save at a time, the file state belongs to the previous save until it's written
+        wait_for_save();
+
         // Add scene file extension to the filepath if it's missing
-        auto file_path = file_path_in;
-        if (FileSystem::GetExtensionFromFilePath(file_path) != EXTENSION_WORLD)
+        string path = file_path_in;
+        if (FileSystem::GetExtensionFromFilePath(path) != EXTENSION_WORLD)
         {
-            file_path += EXTENSION_WORLD;
+            path += EXTENSION_WORLD;
         }
 
-        name      = FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
-        file_path = file_path;
+        name      = FileSystem::GetFileNameWithoutExtensionFromFilePath(path);
+        file_path = path;
+
+        // streamed out entities are only on disk in the cell files, bring them back so that they are saved too
+        WorldStreaming::Restore();
 
         // Notify subsystems that need to save data
         SP_FIRE_EVENT(EventType::WorldSaveStart);
 
-        // Create a prefab file
-        auto file = make_unique<FileStream>(file_path, FileStream_Write);
-        if (!file->IsOpen())
+        // Only save root entities as they will also save their descendants
+        // saving can take longer than a frame, so this can't use GetRootEntities() which is frame allocated
+        vector<shared_ptr<Entity>> root_actors;
         {
-            SP_LOG_ERROR("Failed to open file.");
-            return false;
+            lock_guard<mutex> lock(entity_access_mutex);
+            for (const auto& it : entities)
+            {
+                if (!it.second->HasParent())
+                {
+                    root_actors.emplace_back(it.second);
+                }
+            }
         }
-
-        // Only save root entities as they will also save their descendants
-        vector<shared_ptr<Entity>> root_actors = GetRootEntities();
         const uint32_t root_entity_count = static_cast<uint32_t>(root_actors.size());
 
         // Start progress tracking and timing
         const Stopwatch timer;
         ProgressTracker::GetProgress(ProgressType::World).Start(root_entity_count, "Saving world...");
 
-        // Save root entity count
-        file->Write(root_entity_count);
+        // append to the file if it's the one that was last written or read, and it hasn't changed on disk since
+        error_code error;
+        const uint64_t size_on_disk = filesystem::file_size(path, error);
+        bool append                 = !error && world_file.path == path && size_on_disk == world_file.size;
 
-        // Save root entity IDs
-        for (shared_ptr<Entity>& root : root_actors)
+        // a root is clean if its chunk is still in the file and nothing in its subtree changed
+        vector<bool> clean(root_entity_count, false);
+        uint64_t size_clean = 0;
+        if (append)
         {
-            file->Write(root->GetObjectId());
+            for (uint32_t i = 0; i < root_entity_count; i++)
+            {
+                auto it = world_file.chunks.find(root_actors[i]->GetObjectId());
+                if (it != world_file.chunks.end() && !root_actors[i]->IsSubtreeModified())
+                {
+                    clean[i]    = true;
+                    size_clean += it->second.size;
+                }
+            }
+
+            // compact, by rewriting the whole file, once most of it would be dead chunks
+            const uint64_t size_dead = world_file.size - world_file_header - size_clean;
+            if (size_dead > world_file.size / 2)
+            {
+                append = false;
+                fill(clean.begin(), clean.end(), false);
+            }
         }
 
-        // Save root entities
-        for (shared_ptr<Entity>& root : root_actors)
+        // snapshot the subtrees that have to be written, this is the only part that touches the entities
+        vector<world_snapshot> snapshots(root_entity_count);
+        uint32_t dirty_count = 0;
+        for (uint32_t i = 0; i < root_entity_count; i++)
         {
-            root->Serialize(file.get());
+            world_snapshot& snapshot = snapshots[i];
+            snapshot.chunk.entity_id = root_actors[i]->GetObjectId();
+
+            if (clean[i])
+            {
+                snapshot.chunk = world_file.chunks[snapshot.chunk.entity_id];
+            }
+            else
+            {
+                FileStream stream("", FileStream_Memory | FileStream_Write);
+                root_actors[i]->Serialize(&stream);
+                snapshot.data = stream.GetMemory();
+                world_save_roots.emplace_back(root_actors[i]);
+                dirty_count++;
+            }
+
+            root_actors[i]->ClearSubtreeModified();
             ProgressTracker::GetProgress(ProgressType::World).JobDone();
         }
 
-        // Report time
-        SP_LOG_INFO("World \"%s\" has been saved. Duration %.2f ms", file_path.c_str(), timer.GetElapsedTimeMs());
+        auto write = [path, append, snapshots = move(snapshots), dirty_count, timer]() mutable
+        {
+            // forgetting the file has the next save write everything
+            auto fail = [&path](const char* reason)
+            {
+                world_file        = world_file_state();
+                world_save_failed = true;
+                SP_LOG_ERROR("Failed to %s \"%s\"", reason, path.c_str());
+            };
+
+            FileStream file(path, append ? (FileStream_Read | FileStream_Write) : FileStream_Write);
+            if (!file.IsOpen())
+            {
+                fail("open");
+                return;
+            }
+
+            // header, the table of contents offset is patched in once it's known
+            if (append)
+            {
+                file.Seek(world_file.size);
+            }
+            else
+            {
+                file.Write(world_file_magic);
+                file.Write(world_file_version);
+                file.Write(uint64_t(0));
+            }
+
+            // chunks
+            for (world_snapshot& snapshot : snapshots)
+            {
+                if (!snapshot.data.empty())
+                {
+                    snapshot.chunk.offset = file.GetPosition();
+                    snapshot.chunk.size   = snapshot.data.size();
+                    file.WriteBytes(snapshot.data.data(), snapshot.chunk.size);
+                }
+            }
+
+            // table of contents
+            const uint64_t toc_offset = file.GetPosition();
+            file.Write(static_cast<uint32_t>(snapshots.size()));
+            for (const world_snapshot& snapshot : snapshots)
+            {
+                file.Write(snapshot.chunk.entity_id);
+                file.Write(snapshot.chunk.offset);
+                file.Write(snapshot.chunk.size);
+            }
+            const uint64_t size = file.GetPosition();
+
+            // pointing the header to the new table of contents is the last write, so an
+            // interrupted append leaves the file as it was after the previous save
+            file.Seek(sizeof(uint32_t) * 2);
+            file.Write(toc_offset);
+            file.Close();
+            if (!file.IsGood())
+            {
+                fail("write");
+                return;
+            }
 
-        // Notify subsystems waiting for us to finish
+            world_file.path = path;
+            world_file.size = size;
+            world_file.chunks.clear();
+            for (const world_snapshot& snapshot : snapshots)
+            {
+                world_file.chunks[snapshot.chunk.entity_id] = snapshot.chunk;
+            }
+
+            // Report time
+            SP_LOG_INFO("World \"%s\" has been saved, %u of %u root entities were written%s. Duration %.2f ms",
+                path.c_str(), dirty_count, static_cast<uint32_t>(snapshots.size()), append ? "" : " (full rewrite)", timer.GetElapsedTimeMs());
+        };
+
+        if (background)
+        {
+            world_save_task = ThreadPool::AddTask(move(write));
+        }
+        else
+        {
+            write();
+            wait_for_save();
+        }
+
+        // Notify subsystems waiting for us to finish, in the background case the world is captured but the file might still be written
         SP_FIRE_EVENT(EventType::WorldSavedEnd);
 
         return true;
     }
 
-    bool World::LoadFromFile(const string& file_path_)
+    bool World::LoadFromFile(const string& file_path_, const bool parallel)
     {
+        // the file might be the one that's still being saved
+        wait_for_save();
+
         file_path = file_path_;
 
         if (!FileSystem::Exists(file_path))
@@ -189,14 +764,38 @@ namespace Spartan
             return false;
         }
 
+        // read the whole file up front (through io_uring where it's available), every stream below reads from memory,
+        // if it fails, or the file is packed, they read the file by path
+        vector<byte> file_data;
+        const bool preloaded = !Package::Exists(file_path) && AsyncIo::ReadAndWait(file_path, &file_data);
+
         // open file
+        AsyncIo::SetPreloaded(file_path, preloaded ? &file_data : nullptr);
         unique_ptr<FileStream> file = make_unique<FileStream>(file_path, FileStream_Read);
+        AsyncIo::SetPreloaded(file_path, nullptr);
         if (!file->IsOpen())
         {
             SP_LOG_ERROR("Failed to open \"%s\"", file_path.c_str());
             return false;
         }
 
+        // header and table of contents
+        uint32_t version = 0;
+        vector<world_chunk> chunks;
+        const read_result result = read_table_of_contents(*file, &version, &chunks);
+        if (result == read_result::unsupported)
+        {
+            SP_LOG_ERROR("\"%s\" is version %u, only up to version %u is supported", file_path.c_str(), version, world_file_version);
+            return false;
+        }
+        else if (result == read_result::corrupted)
+        {
+            SP_LOG_ERROR("\"%s\" is corrupted, its header or table of contents can't be read", file_path.c_str());
+            return false;
+        }
+        const bool is_chunked            = version >= 2;
+        const uint32_t root_entity_count = static_cast<uint32_t>(chunks.size());
+
         Clear();
 
         name = FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
@@ -204,25 +803,80 @@ namespace Spartan
         // notify subsystems that need to load data
         SP_FIRE_EVENT(EventType::WorldLoadStart);
 
-        // load root entity count
-        const uint32_t root_entity_count = file->ReadAs<uint32_t>();
-
         // start progress tracking and timing
         ProgressTracker::GetProgress(ProgressType::World).Start(root_entity_count, "Loading world...");
         const Stopwatch timer;
 
-        // load root entity IDs
-        for (uint32_t i = 0; i < root_entity_count; i++)
+        // create the root entities up front, so that everything can find them by id
+        vector<shared_ptr<Entity>> root_entities;
+        for (const world_chunk& chunk : chunks)
         {
-            shared_ptr<Entity> entity = CreateEntity();
-            entity->SetObjectId(file->ReadAs<uint64_t>());
+            root_entities.emplace_back(CreateEntity(chunk.entity_id));
         }
 
-        // serialize root entities
-        for (uint32_t i = 0; i < root_entity_count; i++)
+        if (is_chunked)
         {
-            entities[i]->Deserialize(file.get(), nullptr);
-            ProgressTracker::GetProgress(ProgressType::World).JobDone();
+            // the subtrees don't depend on each other, so each one can be deserialized on any thread, from its own stream
+            auto deserialize_chunks = [&chunks, &root_entities, &file_data, preloaded](uint32_t start, uint32_t end)
+            {
+                AsyncIo::SetPreloaded(file_path, preloaded ? &file_data : nullptr);
+                FileStream stream(file_path, FileStream_Read | FileStream_Mapped);
+                AsyncIo::SetPreloaded(file_path, nullptr);
+                if (!stream.IsOpen())
+                    return;
+
+                for (uint32_t i = start; i < end; i++)
+                {
+                    stream.Seek(chunks[i].offset);
+                    root_entities[i]->Deserialize(&stream, nullptr);
+
+                    if (stream.GetPosition() != chunks[i].offset + chunks[i].size)
+                    {
+                        SP_LOG_WARNING("Chunk of \"%s\" was not fully read, the file might be corrupted", root_entities[i]->GetObjectName().c_str());
+                    }
+
+                    ProgressTracker::GetProgress(ProgressType::World).JobDone();
+                }
+            };
+
+            if (parallel)
+            {
+                ThreadPool::ParallelLoop(deserialize_chunks, root_entity_count);
+            }
+            else
+            {
+                deserialize_chunks(0, root_entity_count);
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < root_entity_count; i++)
+            {
+                root_entities[i]->Deserialize(file.get(), nullptr);
+                ProgressTracker::GetProgress(ProgressType::World).JobDone();
+            }
+        }
+
+        // what was just loaded is what's on disk, so the next save only has to write what changes from here
+        {
+            lock_guard<mutex> lock(entity_access_mutex);
+            for (const auto& it : entities)
+            {
+                it.second->ClearModified();
+            }
+        }
+
+        // remember the file layout so that saving can append to it, older versions get rewritten on the first save
+        world_file = world_file_state();
+        if (version >= 3)
+        {
+            error_code error;
+            world_file.path = file_path;
+            world_file.size = filesystem::file_size(file_path, error);
+            for (const world_chunk& chunk : chunks)
+            {
+                world_file.chunks[chunk.entity_id] = chunk;
+            }
         }
 
         // report time
@@ -238,13 +892,100 @@ namespace Spartan
         resolve = true;
     }
 
-    shared_ptr<Entity> World::CreateEntity()
+    void World::Resolve(const Entity* entity)
     {
-        lock_guard lock(entity_access_mutex);
+        // staged entities are resolved once they are attached
+        if (!entity || staging)
+            return;
+
+        lock_guard lock(resolve_mutex);
+        resolve_entity_ids.emplace_back(entity->GetObjectId());
+        bvh_entities_dirty.emplace_back(entity->GetObjectId());
+    }
+
+    frame_vector<Entity*> World::Query(const Frustum& frustum, const bool ignore_depth)
+    {
+        lock_guard lock(bvh_mutex);
+        bvh_refit();
+
+        frame_vector<Entity*> results;
+        bvh.Query(frustum, results, ignore_depth);
+
+        return results;
+    }
+
+    frame_vector<Entity*> World::Query(const Sphere& sphere)
+    {
+        lock_guard lock(bvh_mutex);
+        bvh_refit();
+
+        frame_vector<Entity*> results;
+        bvh.Query(sphere, results);
+
+        return results;
+    }
+
+    frame_vector<Entity*> World::Query(const BoundingBox& box)
+    {
+        lock_guard lock(bvh_mutex);
+        bvh_refit();
+
+        frame_vector<Entity*> results;
+        bvh.Query(box, results);
+
+        return results;
+    }
+
+    frame_vector<RayHit> World::Query(const Ray& ray)
+    {
+        // the entities are needed as shared pointers, so lock them first (same order as the tick)
+        lock_guard lock_entities(entity_access_mutex);
+        lock_guard lock(bvh_mutex);
+        bvh_refit();
+
+        frame_vector<pair<Entity*, float>> hits;
+        bvh.Query(ray, hits);
 
+        frame_vector<RayHit> results;
+        results.reserve(hits.size());
+        for (const auto& [entity, distance] : hits)
+        {
+            auto it = entities.find(entity->GetObjectId());
+            if (it == entities.end())
+                continue;
+
+            results.emplace_back(
+                it->second,                                     // entity
+                ray.GetStart() + ray.GetDirection() * distance, // position
+                distance,                                       // distance
+                distance == 0.0f                                // inside
+            );
+        }
+
+        // sort by distance (ascending)
+        sort(results.begin(), results.end(), [](const RayHit& a, const RayHit& b) { return a.m_distance < b.m_distance; });
+
+        return results;
+    }
+
+    shared_ptr<Entity> World::CreateEntity(const uint64_t id)
+    {
         shared_ptr<Entity> entity = make_shared<Entity>();
+        if (id != 0)
+        {
+            entity->SetObjectId(id);
+        }
         entity->Initialize();
+
+        if (staging)
+        {
+            staged[entity->GetObjectId()] = entity;
+            return entity;
+        }
+
+        lock_guard lock(entity_access_mutex);
         entities[entity->GetObjectId()] = entity;
+        transform_hierarchy_dirty       = true;
 
         return entity;
     }
@@ -272,6 +1013,28 @@ namespace Spartan
             std::set<uint64_t> ids_to_remove;
             for (Entity* entity : entities_to_remove) {
                 ids_to_remove.insert(entity->GetObjectId());
+                Resolve(entity);
+
+                // something else might keep the entity alive, its components shouldn't tick anymore either way
+                for (const shared_ptr<Component>& component : entity->GetAllComponents())
+                {
+                    if (component)
+                    {
+                        ComponentPool::Unlink(component.get());
+                    }
+                }
+
+                // unlinked components don't get OnRemove(), so make sure audio doesn't keep using this entity as the listener
+                Audio::ClearListenerEntity(entity);
+            }
+
+            // out of the bounding volume hierarchy right away, so queries never see a removed entity
+            {
+                lock_guard lock(bvh_mutex);
+                for (const uint64_t id : ids_to_remove)
+                {
+                    bvh_remove(id);
+                }
             }
 
             // Remove entities using a single loop
@@ -280,6 +1043,7 @@ namespace Spartan
                 if (ids_to_remove.count(it->first) > 0)
                 {
                     it = entities.erase(it);
+                    transform_hierarchy_dirty = true;
                 }
                 else
                 {
@@ -293,15 +1057,13 @@ namespace Spartan
                 parent->AcquireChildren();
             }
         }
-
-        resolve = true;
     }
 
-    vector<shared_ptr<Entity>> World::GetRootEntities()
+    frame_vector<shared_ptr<Entity>> World::GetRootEntities()
     {
         lock_guard<mutex> lock(entity_access_mutex);
 
-        vector<shared_ptr<Entity>> root_entities;
+        frame_vector<shared_ptr<Entity>> root_entities;
         for (auto it : entities)
         {
             if (!it.second->HasParent())
@@ -315,6 +1077,13 @@ namespace Spartan
 
     const shared_ptr<Entity>& World::GetEntityById(const uint64_t id)
     {
+        if (staging)
+        {
+            auto it = staged.find(id);
+            if (it != staged.end())
+                return it->second;
+        }
+
         lock_guard<mutex> lock(entity_access_mutex);
 
         auto it = entities.find(id);
@@ -330,6 +1099,78 @@ namespace Spartan
         return entities;
     }
 
+    void World::BeginStaging()
+    {
+        SP_ASSERT_MSG(!staging, "Already staging");
+
+        staging = true;
+        ComponentPool::SetLinkingDeferred(true);
+    }
+
+    vector<shared_ptr<Entity>> World::EndStaging()
+    {
+        SP_ASSERT_MSG(staging, "Not staging");
+
+        vector<shared_ptr<Entity>> staged_entities;
+        staged_entities.reserve(staged.size());
+        for (auto& it : staged)
+        {
+            staged_entities.emplace_back(move(it.second));
+        }
+        staged.clear();
+
+        staging = false;
+        ComponentPool::SetLinkingDeferred(false);
+
+        return staged_entities;
+    }
+
+    void World::Attach(const vector<shared_ptr<Entity>>& staged_entities)
+    {
+        {
+            lock_guard lock(entity_access_mutex);
+
+            for (const shared_ptr<Entity>& entity : staged_entities)
+            {
+                entities[entity->GetObjectId()] = entity;
+
+                for (const shared_ptr<Component>& component : entity->GetAllComponents())
+                {
+                    if (component)
+                    {
+                        ComponentPool::Link(component.get());
+                    }
+                }
+            }
+            transform_hierarchy_dirty = true;
+        }
+
+        // entities with a parent in the world only pointed to it so far, the parent adopts them now
+        unordered_set<uint64_t> ids;
+        for (const shared_ptr<Entity>& entity : staged_entities)
+        {
+            ids.insert(entity->GetObjectId());
+        }
+
+        for (const shared_ptr<Entity>& entity : staged_entities)
+        {
+            if (shared_ptr<Entity> parent = entity->GetParent())
+            {
+                if (ids.find(parent->GetObjectId()) == ids.end())
+                {
+                    parent->AddChild(entity.get());
+                }
+            }
+
+            Resolve(entity.get());
+        }
+    }
+
+    bool World::CanModify(const Entity* entity)
+    {
+        return !staging || staged.find(entity->GetObjectId()) != staged.end();
+    }
+
     const string World::GetName()
     {
         return name;
@@ -21,12 +21,21 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ===================
+//= INCLUDES =====================
 #include "../Math/BoundingBox.h"
-//==============================
+#include "../Core/FrameAllocator.h"
+//================================
 
 namespace Spartan
 {
+    namespace Math
+    {
+        class Frustum;
+        class Sphere;
+        class Ray;
+        class RayHit;
+    }
+
     class World
     {
     public:
@@ -36,20 +45,40 @@ namespace Spartan
         static void Tick();
 
         // io
-        static bool SaveToFile(const std::string& filePath);
-        static bool LoadFromFile(const std::string& file_path);
+        static bool SaveToFile(const std::string& file_path, const bool background = false); // only writes the root subtrees that changed since the last save or load
+        static bool LoadFromFile(const std::string& file_path, const bool parallel = true);
 
         // entities
-        static std::shared_ptr<Entity> CreateEntity();
+        static std::shared_ptr<Entity> CreateEntity(const uint64_t id = 0); // 0 generates a new id
         static bool EntityExists(Entity* entity);
         static void RemoveEntity(Entity* entity);
-        static std::vector<std::shared_ptr<Entity>> GetRootEntities();
+        static frame_vector<std::shared_ptr<Entity>> GetRootEntities(); // frame allocated, don't keep it beyond the current frame
         static const std::shared_ptr<Entity>& GetEntityById(uint64_t id);
         static const std::unordered_map<uint64_t, std::shared_ptr<Entity>>& GetAllEntities();
 
+        // staging, entities that a thread creates between BeginStaging() and EndStaging() are kept out of the world, so they can be built
+        // on a worker while the world ticks, they can point to entities in the world but never modify them, Attach() adds them on the main thread
+        static void BeginStaging();
+        static std::vector<std::shared_ptr<Entity>> EndStaging();
+        static void Attach(const std::vector<std::shared_ptr<Entity>>& staged_entities);
+        static bool CanModify(const Entity* entity); // false for entities in the world while this thread is staging
+
+        // transforms
+        static void SetHierarchyDirty();
+        static void OnTransformUpdated();
+        static void OnTransformDirty(const Entity* entity);
+        static uint32_t GetTransformUpdateCount(); // transforms that were resolved during the last frame
+
+        // spatial queries against the world space bounding boxes of the renderables, frame allocated
+        static frame_vector<Entity*> Query(const Math::Frustum& frustum, const bool ignore_depth = false);
+        static frame_vector<Entity*> Query(const Math::Sphere& sphere);
+        static frame_vector<Entity*> Query(const Math::BoundingBox& box);
+        static frame_vector<Math::RayHit> Query(const Math::Ray& ray); // sorted by distance
+
         // misc
         static void Clear();
-        static void Resolve();
+        static void Resolve();                     // rebuilds the renderer's view of the world from scratch
+        static void Resolve(const Entity* entity); // only updates the renderer's view of this entity
         static const std::string GetName();
         static const std::string& GetFilePath();
         static Math::BoundingBox& GetBoundinBox();
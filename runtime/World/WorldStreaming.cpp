@@ -0,0 +1,784 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============================
+#include "pch.h"
+#include "WorldStreaming.h"
+#include "World.h"
+#include "Entity.h"
+#include "Components/Camera.h"
+#include "Components/Light.h"
+#include "Components/Terrain.h"
+#include "Components/Constraint.h"
+#include "Components/Renderable.h"
+#include "Components/PhysicsBody.h"
+#include "Components/AudioListener.h"
+#include "../IO/AsyncIo.h"
+#include "../IO/FileStream.h"
+#include "../Core/ThreadPool.h"
+#include "../Core/ProgressTracker.h"
+#include "../Profiling/Profiler.h"
+#include "../Rendering/Material.h"
+#include "../Rendering/Renderer.h"
+#include "../Resource/ResourceCache.h"
+#include "../RHI/RHI_Texture.h"
+//=========================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    namespace
+    {
+        enum class CellState : uint8_t
+        {
+            Resident,  // entities are in the world
+            Unloading, // a worker is writing the cell to disk
+            Unloaded,  // entities are on disk
+            Loading,   // a worker is deserializing the cell
+            Loaded     // deserialized, waiting to be attached to the world on the main thread
+        };
+
+        struct Cell
+        {
+            BoundingBox bounds = BoundingBox::Undefined;
+            string file_path;
+            vector<uint64_t> unit_ids;               // roots of the subtrees that belong to this cell
+            vector<uint64_t> unit_ids_modified;      // units that were modified when the cell was unloaded, for the world save
+            vector<pair<string, string>> materials; // name and path of every material the cell references
+            vector<shared_ptr<Entity>> staged;      // deserialized, but not in the world yet
+            uint64_t file_size = 0;
+            bool file_current  = false;             // the file was written this run and the units haven't changed since
+            atomic<CellState> state = CellState::Resident;
+        };
+
+        unordered_map<uint64_t, unique_ptr<Cell>> cells;
+        mutex mutex_cells;
+        bool enabled         = false;
+        bool partitioned     = false;
+        float cell_size      = 64.0f;
+        float load_radius    = 128.0f;
+        float unload_margin  = 32.0f;
+
+        // materials are counted per resident cell that references them, once that drops to zero they are evicted
+        // from the resource cache, along with the textures that only they used, and loaded back with the next cell that needs them
+        struct eviction
+        {
+            string material_name;
+            string material_path;
+            uint64_t frame = 0; // the frame the last resident cell let go of it
+        };
+        unordered_map<string, uint32_t> material_references; // material name -> resident cells
+        vector<eviction> evictions;
+
+        // the renderer lets go of removed entities on the next world tick and of their bindless slots on the frame after that
+        const uint64_t eviction_delay_frames = 3;
+
+        // jobs only start under mutex_cells, they complete under mutex_jobs, which is what waiting for them sleeps on
+        mutex mutex_jobs;
+        condition_variable condition_jobs;
+
+        // stats
+        atomic<uint32_t> jobs_in_flight      = 0;
+        atomic<uint64_t> bytes_in_flight     = 0;
+        atomic<uint32_t> cell_count          = 0;
+        atomic<uint32_t> cell_count_resident = 0;
+        atomic<uint32_t> cell_count_pending  = 0;
+
+        // anything that other systems hold on to or that moves by itself stays resident
+        bool is_streamable(Entity* entity)
+        {
+            if (entity->GetComponent<Camera>()        ||
+                entity->GetComponent<AudioListener>() ||
+                entity->GetComponent<Light>()         ||
+                entity->GetComponent<Terrain>()       ||
+                entity->GetComponent<Constraint>())
+                return false;
+
+            if (shared_ptr<PhysicsBody> physics_body = entity->GetComponent<PhysicsBody>())
+            {
+                if (physics_body->GetMass() > 0.0f)
+                    return false;
+            }
+
+            return true;
+        }
+
+        struct subtree_info
+        {
+            BoundingBox box = BoundingBox::Undefined;
+            bool streamable = true;
+        };
+
+        subtree_info gather_subtree_info(Entity* entity, unordered_map<Entity*, subtree_info>& infos)
+        {
+            subtree_info info;
+            info.streamable = is_streamable(entity);
+
+            if (shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>())
+            {
+                info.box.Merge(renderable->GetBoundingBox(BoundingBoxType::Transformed));
+            }
+
+            for (Entity* child : entity->GetChildren())
+            {
+                subtree_info info_child = gather_subtree_info(child, infos);
+                info.box.Merge(info_child.box);
+                info.streamable = info.streamable && info_child.streamable;
+            }
+
+            infos[entity] = info;
+            return info;
+        }
+
+        string get_cell_directory()
+        {
+            const string world_name = World::GetName();
+            return ResourceCache::GetProjectDirectory() + "cache/streaming/" + (world_name.empty() ? "default" : world_name) + "/";
+        }
+
+        // the largest subtrees that are streamable and small enough to fit a cell become units, the cell is picked by their center
+        void assign_to_cells(Entity* entity, const unordered_map<Entity*, subtree_info>& infos)
+        {
+            const subtree_info& info = infos.at(entity);
+            if (info.box == BoundingBox::Undefined)
+                return;
+
+            const Vector3 size = info.box.GetSize();
+            if (info.streamable && size.x <= cell_size && size.z <= cell_size)
+            {
+                const Vector3 center = info.box.GetCenter();
+                const int32_t x      = static_cast<int32_t>(floor(center.x / cell_size));
+                const int32_t z      = static_cast<int32_t>(floor(center.z / cell_size));
+                const uint64_t key   = (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(z);
+
+                unique_ptr<Cell>& cell = cells[key];
+                if (!cell)
+                {
+                    cell            = make_unique<Cell>();
+                    cell->file_path = get_cell_directory() + "cell_" + to_string(x) + "_" + to_string(z) + EXTENSION_CELL;
+                }
+
+                cell->unit_ids.emplace_back(entity->GetObjectId());
+                cell->bounds.Merge(info.box);
+
+                return;
+            }
+
+            for (Entity* child : entity->GetChildren())
+            {
+                assign_to_cells(child, infos);
+            }
+        }
+
+        // the name and path of every material that the units reference
+        void gather_materials(Cell& cell, const vector<shared_ptr<Entity>>& units)
+        {
+            cell.materials.clear();
+
+            for (const shared_ptr<Entity>& unit : units)
+            {
+                vector<Entity*> entities = { unit.get() };
+                unit->GetDescendants(&entities);
+                for (Entity* entity : entities)
+                {
+                    shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
+                    Material* material                = renderable ? renderable->GetMaterial() : nullptr;
+                    if (!material)
+                        continue;
+
+                    pair<string, string> reference = { material->GetObjectName(), material->GetResourceFilePath() };
+                    if (find(cell.materials.begin(), cell.materials.end(), reference) == cell.materials.end())
+                    {
+                        cell.materials.emplace_back(reference);
+                    }
+                }
+            }
+        }
+
+        void acquire_materials(const Cell& cell)
+        {
+            for (const auto& [name, path] : cell.materials)
+            {
+                material_references[name]++;
+            }
+        }
+
+        void release_materials(const Cell& cell)
+        {
+            for (const auto& [name, path] : cell.materials)
+            {
+                auto it = material_references.find(name);
+                if (it == material_references.end() || it->second == 0)
+                    continue;
+
+                if (--it->second == 0)
+                {
+                    evictions.push_back({ name, path, Renderer::GetFrameNumber() });
+                }
+            }
+        }
+
+        // expects mutex_cells to be locked and no cell to be staging, since staging looks materials up by name
+        void evict_materials()
+        {
+            if (evictions.empty())
+                return;
+
+            // what's due, and still unreferenced by any resident cell
+            vector<eviction> due;
+            const uint64_t frame = Renderer::GetFrameNumber();
+            for (auto it = evictions.begin(); it != evictions.end(); )
+            {
+                if (frame < it->frame + eviction_delay_frames)
+                {
+                    ++it;
+                    continue;
+                }
+
+                if (material_references[it->material_name] == 0)
+                {
+                    due.emplace_back(move(*it));
+                }
+                it = evictions.erase(it);
+            }
+
+            if (due.empty())
+                return;
+
+            // anything outside of the cells (or staged and about to be attached) might use the same materials
+            unordered_set<Material*> materials_in_use;
+            auto gather_in_use = [&materials_in_use](const shared_ptr<Entity>& entity)
+            {
+                if (shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>())
+                {
+                    materials_in_use.insert(renderable->GetMaterial());
+                }
+            };
+            for (const auto& it : World::GetAllEntities())
+            {
+                gather_in_use(it.second);
+            }
+            for (auto& [key, cell] : cells)
+            {
+                for (const shared_ptr<Entity>& entity : cell->staged)
+                {
+                    gather_in_use(entity);
+                }
+            }
+
+            vector<string> texture_paths;
+            uint32_t evicted_count = 0;
+            for (const eviction& candidate : due)
+            {
+                // only materials that can be loaded back
+                shared_ptr<Material> material = ResourceCache::GetByName<Material>(candidate.material_name);
+                if (!material || candidate.material_path.empty() || !FileSystem::Exists(candidate.material_path))
+                    continue;
+
+                if (materials_in_use.find(material.get()) != materials_in_use.end())
+                    continue;
+
+                for (const string& path : material->GetTexturePaths())
+                {
+                    texture_paths.emplace_back(path);
+                }
+
+                ResourceCache::Remove(material);
+                evicted_count++;
+            }
+
+            // textures that no remaining material uses, and that can be loaded back with their material
+            uint32_t evicted_texture_count = 0;
+            if (!texture_paths.empty())
+            {
+                unordered_set<string> texture_paths_in_use;
+                for (shared_ptr<IResource>& resource : ResourceCache::GetByType(ResourceType::Material))
+                {
+                    for (const string& path : static_pointer_cast<Material>(resource)->GetTexturePaths())
+                    {
+                        texture_paths_in_use.insert(path);
+                    }
+                }
+
+                for (const string& path : texture_paths)
+                {
+                    if (path.empty() || texture_paths_in_use.count(path) != 0 || !FileSystem::Exists(path))
+                        continue;
+
+                    shared_ptr<RHI_Texture> texture = ResourceCache::GetByPath<RHI_Texture>(path);
+                    if (!texture || texture->GetResourceState() != ResourceState::PreparedForGpu)
+                        continue;
+
+                    ResourceCache::Remove(texture);
+                    texture_paths_in_use.insert(path);
+                    evicted_texture_count++;
+                }
+            }
+
+            if (evicted_count != 0)
+            {
+                SP_LOG_INFO("Evicted %u materials and %u textures that no resident cell references", evicted_count, evicted_texture_count);
+            }
+        }
+
+        void partition()
+        {
+            const Stopwatch timer;
+
+            unordered_map<Entity*, subtree_info> infos;
+            for (shared_ptr<Entity>& root : World::GetRootEntities())
+            {
+                gather_subtree_info(root.get(), infos);
+                assign_to_cells(root.get(), infos);
+            }
+
+            if (!cells.empty())
+            {
+                FileSystem::CreateDirectory(get_cell_directory());
+            }
+
+            // every cell starts out resident
+            for (auto& [key, cell] : cells)
+            {
+                vector<shared_ptr<Entity>> units;
+                for (const uint64_t id : cell->unit_ids)
+                {
+                    if (const shared_ptr<Entity>& unit = World::GetEntityById(id))
+                    {
+                        units.emplace_back(unit);
+                    }
+                }
+
+                gather_materials(*cell, units);
+                acquire_materials(*cell);
+            }
+
+            SP_LOG_INFO("World partitioned into %u cells of %.0f m. Duration %.2f ms", static_cast<uint32_t>(cells.size()), cell_size, timer.GetElapsedTimeMs());
+        }
+
+        float get_distance_xz(const BoundingBox& box, const Vector3& position)
+        {
+            const float dx = max(max(box.GetMin().x - position.x, position.x - box.GetMax().x), 0.0f);
+            const float dz = max(max(box.GetMin().z - position.z, position.z - box.GetMax().z), 0.0f);
+
+            return sqrt(dx * dx + dz * dz);
+        }
+
+        // deserializes the entities of a cell outside of the world, see World::BeginStaging()
+        void stage(Cell& cell)
+        {
+            // materials that were evicted from the cache in the meantime are loaded back, if they live on disk
+            for (const auto& [name, path] : cell.materials)
+            {
+                if (!ResourceCache::GetByName<Material>(name) && FileSystem::Exists(path))
+                {
+                    ResourceCache::Load<Material>(path);
+                }
+            }
+
+            FileStream file(cell.file_path, FileStream_Read | FileStream_Mapped);
+            if (!file.IsOpen())
+            {
+                SP_LOG_ERROR("Failed to open \"%s\", the entities of the cell are lost", cell.file_path.c_str());
+                cell.unit_ids.clear();
+                return;
+            }
+
+            World::BeginStaging();
+            {
+                const uint32_t unit_count = file.ReadAs<uint32_t>();
+                for (uint32_t i = 0; i < unit_count; i++)
+                {
+                    const uint64_t id        = file.ReadAs<uint64_t>();
+                    const uint64_t parent_id = file.ReadAs<uint64_t>();
+
+                    // the parent is in the world, the unit only points to it until it's attached
+                    shared_ptr<Entity> unit = World::CreateEntity(id);
+                    unit->Deserialize(&file, World::GetEntityById(parent_id));
+                }
+            }
+            cell.staged = World::EndStaging();
+        }
+
+        // the count only drops under the lock, so a thread in wait_for_jobs() can't miss it, it's not mutex_cells since
+        // a job can end up running inline on a thread that holds that one
+        void job_done()
+        {
+            {
+                lock_guard lock(mutex_jobs);
+                jobs_in_flight--;
+            }
+            condition_jobs.notify_all();
+        }
+
+        // serializes the entities of a cell and removes them from the world, the file is written on a worker
+        void unload(Cell& cell)
+        {
+            // the user might have deleted some of them in the meantime
+            vector<shared_ptr<Entity>> units;
+            for (const uint64_t id : cell.unit_ids)
+            {
+                if (const shared_ptr<Entity>& unit = World::GetEntityById(id))
+                {
+                    units.emplace_back(unit);
+                }
+            }
+
+            // a cell that comes and goes without being touched already has an up to date file
+            bool file_current = cell.file_current && units.size() == cell.unit_ids.size();
+
+            cell.unit_ids.clear();
+            cell.unit_ids_modified.clear();
+            for (shared_ptr<Entity>& unit : units)
+            {
+                cell.unit_ids.emplace_back(unit->GetObjectId());
+                if (unit->IsSubtreeModified())
+                {
+                    cell.unit_ids_modified.emplace_back(unit->GetObjectId());
+                    file_current = false;
+                }
+            }
+
+            // snapshot the units, this is the only part that touches the entities
+            string data;
+            if (!file_current)
+            {
+                FileStream stream("", FileStream_Memory | FileStream_Write);
+                stream.Write(static_cast<uint32_t>(units.size()));
+                for (shared_ptr<Entity>& unit : units)
+                {
+                    shared_ptr<Entity> parent = unit->GetParent();
+                    stream.Write(unit->GetObjectId());
+                    stream.Write(parent ? parent->GetObjectId() : uint64_t(0));
+                    unit->Serialize(&stream);
+                }
+                data = stream.GetMemory();
+            }
+
+            // remember the materials, so they can be brought back before the entities that reference them, the
+            // references that the cell held while it was resident are given up, the units might have changed since
+            release_materials(cell);
+            gather_materials(cell, units);
+
+            for (shared_ptr<Entity>& unit : units)
+            {
+                World::RemoveEntity(unit.get());
+            }
+
+            if (file_current)
+            {
+                cell.state = CellState::Unloaded;
+                return;
+            }
+
+            cell.state        = CellState::Unloading;
+            cell.file_current = false;
+            jobs_in_flight++;
+
+            Cell* cell_ptr = &cell;
+            ThreadPool::AddJob([cell_ptr, data = move(data)]()
+            {
+                FileStream file(cell_ptr->file_path, FileStream_Write);
+                if (file.IsOpen())
+                {
+                    file.WriteBytes(data.data(), data.size());
+                    file.Close();
+                }
+
+                if (file.IsOpen() && file.IsGood())
+                {
+                    cell_ptr->file_size    = data.size();
+                    cell_ptr->file_current = true;
+                    cell_ptr->state        = CellState::Unloaded;
+                }
+                else
+                {
+                    // the entities only exist in the snapshot now, so they are staged from it, to be attached again
+                    SP_LOG_ERROR("Failed to write \"%s\", the cell will stay resident", cell_ptr->file_path.c_str());
+
+                    vector<byte> bytes(data.size());
+                    memcpy(bytes.data(), data.data(), data.size());
+                    AsyncIo::SetPreloaded(cell_ptr->file_path, &bytes);
+                    stage(*cell_ptr);
+                    AsyncIo::SetPreloaded(cell_ptr->file_path, nullptr);
+
+                    cell_ptr->state = CellState::Loaded;
+                }
+
+                job_done();
+            });
+        }
+
+        // reads the cell without occupying a worker, then deserializes it on one, so that the main thread only has to attach the entities
+        void load(Cell& cell)
+        {
+            cell.state = CellState::Loading;
+            jobs_in_flight++;
+            bytes_in_flight += cell.file_size;
+
+            Cell* cell_ptr = &cell;
+            AsyncIo::Read(cell.file_path, [cell_ptr](vector<byte>& data, const bool success)
+            {
+                // on failure, the cell file is opened by path and the error is reported there
+                AsyncIo::SetPreloaded(cell_ptr->file_path, success ? &data : nullptr);
+                stage(*cell_ptr);
+                AsyncIo::SetPreloaded(cell_ptr->file_path, nullptr);
+
+                bytes_in_flight -= cell_ptr->file_size;
+                cell_ptr->state  = CellState::Loaded;
+                job_done();
+            });
+        }
+
+        // adds the deserialized entities of a cell to the world
+        void instantiate(Cell& cell)
+        {
+            World::Attach(cell.staged);
+
+            // deserialized entities start out modified, the units that weren't when they were unloaded are set back, so that the
+            // world save can skip them and the next unload can keep the file
+            for (const shared_ptr<Entity>& entity : cell.staged)
+            {
+                const uint64_t id = entity->GetObjectId();
+                if (find(cell.unit_ids.begin(), cell.unit_ids.end(), id) != cell.unit_ids.end() &&
+                    find(cell.unit_ids_modified.begin(), cell.unit_ids_modified.end(), id) == cell.unit_ids_modified.end())
+                {
+                    entity->ClearSubtreeModified();
+                }
+            }
+            cell.staged.clear();
+            cell.state = CellState::Resident;
+
+            acquire_materials(cell);
+        }
+
+        // mutex_cells is released while waiting, so that jobs (and what they wait on) can take it, and since jobs only start
+        // under it, none are in flight once this returns
+        void wait_for_jobs(unique_lock<mutex>& lock_cells)
+        {
+            while (jobs_in_flight.load() != 0)
+            {
+                lock_cells.unlock();
+                {
+                    unique_lock lock(mutex_jobs);
+                    condition_jobs.wait(lock, []() { return jobs_in_flight.load() == 0; });
+                }
+                lock_cells.lock();
+            }
+        }
+
+        void restore(unique_lock<mutex>& lock)
+        {
+            wait_for_jobs(lock);
+
+            for (auto& [key, cell] : cells)
+            {
+                if (cell->state == CellState::Unloaded)
+                {
+                    stage(*cell);
+                }
+
+                if (cell->state != CellState::Resident)
+                {
+                    instantiate(*cell);
+                }
+            }
+
+            cell_count_resident = static_cast<uint32_t>(cells.size());
+            cell_count_pending  = 0;
+        }
+
+        void reset(unique_lock<mutex>& lock, const bool restore_entities)
+        {
+            if (restore_entities)
+            {
+                restore(lock);
+            }
+            else
+            {
+                wait_for_jobs(lock);
+            }
+
+            cells.clear();
+            material_references.clear();
+            evictions.clear();
+            partitioned         = false;
+            cell_count          = 0;
+            cell_count_resident = 0;
+            cell_count_pending  = 0;
+        }
+    }
+
+    void WorldStreaming::Tick()
+    {
+        SP_PROFILE_CPU();
+
+        lock_guard lock(mutex_cells);
+
+        if (!enabled || ProgressTracker::IsLoading())
+            return;
+
+        shared_ptr<Camera> camera = Renderer::GetCamera();
+        if (!camera)
+            return;
+
+        if (!partitioned)
+        {
+            partition();
+            partitioned = true;
+        }
+
+        // at most one cell is unloaded and one instantiated per tick, since both happen on the main thread
+        const Vector3 position     = camera->GetEntity()->GetPosition();
+        Cell* cell_to_unload       = nullptr;
+        Cell* cell_to_instantiate  = nullptr;
+        float distance_unload      = 0.0f;
+        float distance_instantiate = numeric_limits<float>::max();
+        uint32_t count_resident    = 0;
+        uint32_t count_pending     = 0;
+        for (auto& [key, cell] : cells)
+        {
+            const float distance  = get_distance_xz(cell->bounds, position);
+            const CellState state = cell->state.load();
+
+            if (state == CellState::Resident)
+            {
+                count_resident++;
+
+                // furthest first
+                if (distance > load_radius + unload_margin && distance > distance_unload)
+                {
+                    cell_to_unload  = cell.get();
+                    distance_unload = distance;
+                }
+            }
+            else if (state == CellState::Unloaded)
+            {
+                if (distance < load_radius)
+                {
+                    load(*cell);
+                    count_pending++;
+                }
+            }
+            else if (state == CellState::Loading)
+            {
+                count_pending++;
+            }
+            else if (state == CellState::Loaded)
+            {
+                count_pending++;
+
+                // nearest first
+                if (distance < distance_instantiate)
+                {
+                    cell_to_instantiate  = cell.get();
+                    distance_instantiate = distance;
+                }
+            }
+        }
+
+        if (cell_to_unload)
+        {
+            unload(*cell_to_unload);
+            count_resident--;
+        }
+
+        if (cell_to_instantiate)
+        {
+            instantiate(*cell_to_instantiate);
+            count_resident++;
+            count_pending--;
+        }
+
+        if (jobs_in_flight.load() == 0)
+        {
+            evict_materials();
+        }
+
+        cell_count          = static_cast<uint32_t>(cells.size());
+        cell_count_resident = count_resident;
+        cell_count_pending  = count_pending;
+    }
+
+    void WorldStreaming::Clear()
+    {
+        unique_lock lock(mutex_cells);
+
+        reset(lock, false);
+        enabled = false;
+    }
+
+    void WorldStreaming::Enable(const float cell_size_, const float load_radius_, const float unload_margin_)
+    {
+        unique_lock lock(mutex_cells);
+
+        // the world is partitioned again on the next tick
+        reset(lock, true);
+        enabled       = true;
+        cell_size     = max(cell_size_, 1.0f);
+        load_radius   = max(load_radius_, 0.0f);
+        unload_margin = max(unload_margin_, 0.0f);
+    }
+
+    void WorldStreaming::Disable()
+    {
+        unique_lock lock(mutex_cells);
+
+        reset(lock, true);
+        enabled = false;
+    }
+
+    void WorldStreaming::Restore()
+    {
+        unique_lock lock(mutex_cells);
+
+        restore(lock);
+    }
+
+    bool WorldStreaming::IsEnabled()
+    {
+        return enabled;
+    }
+
+    uint32_t WorldStreaming::GetCellCount()
+    {
+        return cell_count;
+    }
+
+    uint32_t WorldStreaming::GetResidentCellCount()
+    {
+        return cell_count_resident;
+    }
+
+    uint32_t WorldStreaming::GetPendingLoadCount()
+    {
+        return cell_count_pending;
+    }
+
+    uint64_t WorldStreaming::GetBytesInFlight()
+    {
+        return bytes_in_flight;
+    }
+}
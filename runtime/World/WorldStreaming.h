@@ -0,0 +1,47 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+namespace Spartan
+{
+    // partitions the world into square cells on the xz plane, and moves the entities of each cell
+    // out to disk and back, depending on how far the camera is. static geometry is what gets streamed,
+    // cameras, lights, terrain and dynamic physics bodies are always resident
+    class WorldStreaming
+    {
+    public:
+        static void Tick();
+        static void Clear(); // forgets all cells, expects the world to be cleared right after
+
+        // cells load when the camera gets closer than load_radius and unload when it moves further than load_radius + unload_margin
+        static void Enable(const float cell_size = 64.0f, const float load_radius = 128.0f, const float unload_margin = 32.0f);
+        static void Disable(); // brings every cell back
+        static void Restore(); // brings every cell back and keeps streaming, cells that are out of range unload again over the next ticks
+        static bool IsEnabled();
+
+        // stats
+        static uint32_t GetCellCount();
+        static uint32_t GetResidentCellCount();
+        static uint32_t GetPendingLoadCount();
+        static uint64_t GetBytesInFlight();
+    };
+}